@@ -0,0 +1,57 @@
+#include <strong.hpp>
+#include <strong/arrow.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Writes a column to an Arrow IPC file, reads it back, and checks that a file whose row count was
+// tampered with to overflow the size of its buffers is rejected instead of read out of bounds.
+
+struct meters : strong::type<meters, std::uint64_t>, strong::op::equals<meters> {
+  using strong::type<meters, std::uint64_t>::type;
+};
+
+int main()
+{
+  std::vector<meters> values;
+  for(std::uint64_t i = 0; i < 1000; ++i) {
+    values.push_back(meters(i * 3));
+  }
+
+  std::ostringstream output;
+  strong::arrow_writer writer(output);
+  writer.add_column("distance", values);
+  writer.close();
+  auto file = output.str();
+
+  strong::arrow_reader reader(file.data(), file.size());
+  auto const read = reader.column<meters>("distance").read();
+  std::cout << "read " << read.size() << " values back\n";
+  bool correct = read == values;
+
+  // the row count of the batch and the length of its node, raised so that rows * 8 wraps around
+  std::uint64_t const rows = 1000;
+  std::uint64_t const tampered = (std::uint64_t(1) << 61) + 1000;
+  for(auto position = file.find(std::string(reinterpret_cast<char const *>(&rows), sizeof(rows)));
+      position != std::string::npos;
+      position = file.find(std::string(reinterpret_cast<char const *>(&rows), sizeof(rows)), position)) {
+    std::memcpy(&file[position], &tampered, sizeof(tampered));
+  }
+
+  try {
+    strong::arrow_reader corrupt(file.data(), file.size());
+    auto const column = corrupt.column<meters>("distance");
+    column.data(0);
+    std::cout << "accepted " << column.batch_size(0) << " rows over an 8000 byte buffer\n";
+    correct = false;
+  } catch(std::invalid_argument const &error) {
+    std::cout << "rejected: " << error.what() << '\n';
+  }
+
+  return correct ? 0 : 1;
+}
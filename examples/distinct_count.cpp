@@ -0,0 +1,52 @@
+#include <strong.hpp>
+#include <strong/sketch.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Counts the distinct users seen by two servers with HyperLogLog sketches, merges the sketches, and
+// checks that merging a sketch with itself, or again with one already merged, changes nothing.
+
+struct user_id
+  : strong::type<user_id, std::uint64_t>
+  , strong::op::equals<user_id> {
+  using strong::type<user_id, std::uint64_t>::type;
+};
+
+bool close_to(double estimate, double actual)
+{
+  return std::fabs(estimate - actual) <= 0.05 * actual;
+}
+
+int main()
+{
+  bool correct = true;
+
+  // a few IDs keep the sketches sparse, many make them dense; both must survive a self-merge
+  for(std::uint64_t const users : {100u, 100000u}) {
+    strong::hyperloglog<user_id, 12> first;
+    strong::hyperloglog<user_id, 12> second;
+    for(std::uint64_t i = 0; i < users; ++i) {
+      first.insert(user_id(i));
+      second.insert(user_id(i + users / 2));
+    }
+
+    first.merge(second);
+    auto const merged = first.estimate();
+    for(std::uint64_t i = 0; i < 10; ++i) {
+      // IDs counted already, so that the self-merge also sees IDs not yet folded into the sketch
+      first.insert(user_id(i));
+    }
+    first.merge(first);
+    first.merge(second);
+
+    auto const expected = static_cast<double>(users + users / 2);
+    std::cout << users + users / 2 << " distinct users, estimated " << merged << ", after merging again "
+              << first.estimate() << '\n';
+    correct = correct && close_to(merged, expected) && first.estimate() == merged;
+  }
+
+  return correct ? 0 : 1;
+}
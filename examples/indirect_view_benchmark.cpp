@@ -0,0 +1,73 @@
+#include <strong.hpp>
+#include <strong/indirect_view.hpp>
+#include <strong/vector.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Compares gathering values through random strong IDs with and without prefetching.
+// Build with optimizations (e.g. -DCMAKE_BUILD_TYPE=Release) for meaningful numbers.
+
+struct intersection_id : strong::type<intersection_id, std::uint32_t> {
+  using strong::type<intersection_id, std::uint32_t>::type;
+};
+
+template<class Function>
+double time_ms(Function function)
+{
+  auto const start = std::chrono::steady_clock::now();
+  function();
+  auto const stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main()
+{
+  std::size_t const count = 1 << 24;
+
+  strong::vector<intersection_id, double> values(count);
+  std::vector<intersection_id> ids;
+  ids.reserve(count);
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<std::uint32_t> distribution(0, count - 1);
+  for(std::size_t i = 0; i < count; ++i) {
+    values[intersection_id(static_cast<std::uint32_t>(i))] = static_cast<double>(i % 1000);
+    ids.push_back(intersection_id(distribution(generator)));
+  }
+
+  std::vector<double> output(count);
+  double naive_sum = 0;
+  double view_sum = 0;
+
+  auto const naive = time_ms([&] {
+    for(auto const &id : ids) {
+      naive_sum += values[id];
+    }
+  });
+
+  auto const view = time_ms([&] {
+    strong::indirect_view(values, ids).for_each([&](double value) { view_sum += value; });
+  });
+
+  auto const naive_copy = time_ms([&] {
+    for(std::size_t i = 0; i < count; ++i) {
+      output[i] = values[ids[i]];
+    }
+  });
+
+  auto const gather = time_ms([&] { strong::indirect_view(values, ids).gather(output.data()); });
+
+  auto const scatter = time_ms([&] { strong::indirect_view(values, ids).scatter(output.data()); });
+
+  std::cout << "naive sum:       " << naive << " ms\n";
+  std::cout << "prefetched sum:  " << view << " ms (speedup " << naive / view << "x)\n";
+  std::cout << "naive gather:    " << naive_copy << " ms\n";
+  std::cout << "blocked gather:  " << gather << " ms (speedup " << naive_copy / gather << "x)\n";
+  std::cout << "scatter:         " << scatter << " ms\n";
+
+  return naive_sum == view_sum ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include <strong.hpp>
+#include <strong/parallel.hpp>
+#include <strong/vector.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Measures how parallel_for scales from one thread up to every hardware thread, on a loop with
+// uneven work per index. Build with optimizations (e.g. -DCMAKE_BUILD_TYPE=Release) for meaningful
+// numbers.
+
+struct intersection_id : strong::type<intersection_id, std::uint32_t> {
+  using strong::type<intersection_id, std::uint32_t>::type;
+};
+
+template<class Function>
+double time_ms(Function function)
+{
+  auto const start = std::chrono::steady_clock::now();
+  function();
+  auto const stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// more work for some intersections than others, so that static partitioning would be unbalanced
+double congestion(intersection_id const &id)
+{
+  double value = get(id);
+  for(std::uint32_t i = 0; i < 8 + get(id) % 64; ++i) {
+    value = std::sqrt(value + i);
+  }
+  return value;
+}
+
+int main()
+{
+  std::uint32_t const count = 1 << 22;
+  std::size_t const grain = 1024;
+  strong::vector<intersection_id, double> expected(count);
+  strong::vector<intersection_id, double> values(count);
+
+  auto const sequential = time_ms([&] {
+    for(std::uint32_t i = 0; i < count; ++i) {
+      expected[intersection_id(i)] = congestion(intersection_id(i));
+    }
+  });
+  std::cout << "sequential:  " << sequential << " ms\n";
+
+  auto const hardware = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<unsigned> thread_counts;
+  for(unsigned threads = 1; threads < hardware; threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(hardware);
+
+  bool correct = true;
+  for(auto const threads : thread_counts) {
+    strong::task_scheduler scheduler(threads - 1);
+    auto const parallel = time_ms([&] {
+      strong::parallel_for(scheduler, intersection_id(0), intersection_id(count), grain,
+                           [&](intersection_id id) { values[id] = congestion(id); });
+    });
+    for(std::uint32_t i = 0; i < count; ++i) {
+      correct = correct && values[intersection_id(i)] == expected[intersection_id(i)];
+    }
+    std::cout << threads << " threads:  " << parallel << " ms (speedup " << sequential / parallel << "x)\n";
+  }
+
+  return correct ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include <strong.hpp>
+#include <strong/shared_memory.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Compares handing records from a producer process to a consumer process through a shared_vector
+// with sending them over a socket. Build with optimizations (e.g. -DCMAKE_BUILD_TYPE=Release) for
+// meaningful numbers.
+
+struct cycle_count : strong::type<cycle_count, std::uint64_t> {
+  using strong::type<cycle_count, std::uint64_t>::type;
+};
+
+struct instruction_count : strong::type<instruction_count, std::uint64_t> {
+  using strong::type<instruction_count, std::uint64_t>::type;
+};
+
+struct record_id : strong::type<record_id, std::uint64_t> {
+  using strong::type<record_id, std::uint64_t>::type;
+};
+
+struct record {
+  cycle_count cycles;
+  instruction_count instructions;
+};
+
+using record_vector = strong::shared_vector<record_id, record>;
+
+std::size_t const count = 1 << 22;
+std::size_t const batch = 4096;
+
+std::uint64_t expected_sum()
+{
+  std::uint64_t sum = 0;
+  for(std::size_t i = 0; i < count; ++i) {
+    sum += i + 2 * i;
+  }
+  return sum;
+}
+
+// Run a consumer in a child process and time until it has seen every record.
+template<class Produce, class Consume>
+double time_handoff_ms(Produce produce, Consume consume)
+{
+  auto const start = std::chrono::steady_clock::now();
+  auto const child = ::fork();
+  if(child == 0) {
+    ::_exit(consume() == expected_sum() ? 0 : 1);
+  }
+  produce();
+  int status = 0;
+  ::waitpid(child, &status, 0);
+  auto const stop = std::chrono::steady_clock::now();
+  if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    std::cerr << "consumer saw the wrong records\n";
+  }
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main()
+{
+  std::vector<record> records(count);
+  for(std::size_t i = 0; i < count; ++i) {
+    records[i] = record{cycle_count(i), instruction_count(2 * i)};
+  }
+
+  auto segment = strong::shared_memory::create_anonymous(count * sizeof(record) + (1 << 20));
+  auto &shared = segment.construct<record_vector>("records", count);
+
+  auto const handoff = [&] {
+    return time_handoff_ms(
+      [&] {
+        for(std::size_t first = 0; first < count; first += batch) {
+          shared.append(records.data() + first, batch);
+        }
+      },
+      [&] {
+        // map the segment again, at a different address, as an unrelated process would
+        auto const mapping = strong::shared_memory::open(segment.descriptor());
+        auto const &input = mapping.find<record_vector>("records");
+        std::uint64_t sum = 0;
+        for(std::size_t seen = 0; seen < count;) {
+          auto const size = input.size();
+          if(size == seen) {
+            // let the producer run, in case they share a core
+            ::sched_yield();
+            continue;
+          }
+          auto const data = input.data();
+          for(; seen < size; ++seen) {
+            sum += get(data[seen].cycles) + get(data[seen].instructions);
+          }
+        }
+        return sum;
+      });
+  };
+
+  // the first handoff also pays for faulting in the pages of the segment
+  auto const cold_ms = handoff();
+  shared.clear();
+  auto const shared_ms = handoff();
+
+  int sockets[2];
+  if(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+    return 1;
+  }
+  auto const socket_ms = time_handoff_ms(
+    [&] {
+      ::close(sockets[1]);
+      auto const bytes = reinterpret_cast<char const *>(records.data());
+      for(std::size_t sent = 0, total = count * sizeof(record); sent < total;) {
+        auto const result = ::write(sockets[0], bytes + sent, std::min(total - sent, batch * sizeof(record)));
+        if(result <= 0) {
+          break;
+        }
+        sent += static_cast<std::size_t>(result);
+      }
+      ::close(sockets[0]);
+    },
+    [&] {
+      ::close(sockets[0]);
+      std::vector<record> buffer(batch);
+      std::uint64_t sum = 0;
+      std::size_t leftover = 0;
+      for(;;) {
+        auto const bytes = reinterpret_cast<char *>(buffer.data());
+        auto const result = ::read(sockets[1], bytes + leftover, batch * sizeof(record) - leftover);
+        if(result <= 0) {
+          break;
+        }
+        auto const available = leftover + static_cast<std::size_t>(result);
+        for(std::size_t i = 0; i < available / sizeof(record); ++i) {
+          sum += get(buffer[i].cycles) + get(buffer[i].instructions);
+        }
+        leftover = available % sizeof(record);
+        std::copy(bytes + available - leftover, bytes + available, bytes);
+      }
+      return sum;
+    });
+
+  std::cout << "records:        " << count << " of " << sizeof(record) << " bytes\n";
+  std::cout << "shared_vector:  " << shared_ms << " ms (" << cold_ms << " ms with a fresh segment)\n";
+  std::cout << "socket:         " << socket_ms << " ms (shared memory speedup " << socket_ms / shared_ms << "x)\n";
+
+  return 0;
+}
@@ -0,0 +1,36 @@
+#include <strong.hpp>
+#include <strong/window.hpp>
+
+#include <cstdint>
+#include <iostream>
+
+// Aggregates events over a sliding window whose timestamps are unsigned, e.g. cycles since reset.
+
+struct timestamp
+  : strong::type<timestamp, std::uint64_t>
+  , strong::op::equals<timestamp>
+  , strong::op::orders<timestamp> {
+  using strong::type<timestamp, std::uint64_t>::type;
+};
+
+int main()
+{
+  strong::sliding_window<timestamp, int> window(timestamp(100));
+
+  // events earlier than the window length must stay in the window
+  for(std::uint64_t t = 1; t <= 5; ++t) {
+    window.push(timestamp(t), 1);
+  }
+  std::cout << "at t=5:   " << window.size() << " events, sum " << window.result() << '\n';
+  bool correct = window.size() == 5 && window.result() == 5;
+
+  window.push(timestamp(103), 1);
+  std::cout << "at t=103: " << window.size() << " events, sum " << window.result() << '\n';
+  correct = correct && window.size() == 3 && window.result() == 3;
+
+  window.advance(timestamp(1000));
+  std::cout << "at t=1000: " << window.size() << " events, sum " << window.result() << '\n';
+  correct = correct && window.size() == 0 && window.result() == 0;
+
+  return correct ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+#include <strong.hpp>
+
+#include <cstdio>
+#include <type_traits>
+
+// A cycle count that can be a template parameter, so each latency gets its own specialization
+struct cycle_count
+  : strong::structural<cycle_count, int>
+  , strong::op::equals<cycle_count>
+  , strong::op::orders<cycle_count>
+  , strong::op::adds<cycle_count>
+  , strong::op::multiplies<cycle_count>
+{
+  using strong::structural<cycle_count, int>::structural;
+};
+
+// A pipeline stage whose latency is known at compile time
+template<cycle_count Latency>
+struct pipeline_stage {
+  static constexpr cycle_count latency = Latency;
+
+  // the loop bound is a constant, so the compiler can unroll or fold it entirely
+  static constexpr int delay(int value)
+  {
+    for(int i = 0; i < get(Latency); ++i) {
+      value = value * 3 + 1;
+    }
+    return value;
+  }
+};
+
+// The total latency of a pipeline, folded through the operations of cycle_count
+template<cycle_count... Latencies>
+constexpr cycle_count pipeline_latency()
+{
+  return (cycle_count(0) + ... + Latencies);
+}
+
+// Specialize on the strong constant itself
+template<cycle_count Latency>
+constexpr char const * classify()
+{
+  if constexpr(Latency < cycle_count(4)) {
+    return "short";
+  } else {
+    return "long";
+  }
+}
+
+int main()
+{
+  using fetch = pipeline_stage<cycle_count(1)>;
+  using decode = pipeline_stage<cycle_count(2)>;
+  using execute = pipeline_stage<cycle_count(5)>;
+
+  static_assert(fetch::latency + decode::latency == cycle_count(3));
+  static_assert(pipeline_latency<cycle_count(1), cycle_count(2), cycle_count(5)>() == cycle_count(8));
+  static_assert(execute::latency * cycle_count(2) > cycle_count(9));
+  static_assert(decode::delay(1) == 13);
+
+  // the same strong constant names the same specialization
+  static_assert(std::is_same<pipeline_stage<cycle_count(2)>, decode>::value);
+  static_assert(!std::is_same<pipeline_stage<cycle_count(3)>, decode>::value);
+
+  std::printf("fetch: %s\n", classify<fetch::latency>()); // output short
+  std::printf("execute: %s\n", classify<execute::latency>()); // output long
+  std::printf("pipeline: %d cycles\n", get(pipeline_latency<fetch::latency, decode::latency, execute::latency>())); // output 8
+
+  return 0;
+}
@@ -8,6 +8,38 @@
 #include <iosfwd>
 #endif
 
+#ifdef STRONG_PROFILE_VALUES
+
+namespace strong {
+namespace detail {
+
+template<class TypeName, typename Type>
+void profile_value(Type const &value) noexcept;
+
+}
+}
+
+// Record a value of a strong typedef in its value distribution (see strong/value_profile.hpp).
+// Constant evaluation is not recorded, so constexpr construction keeps working.
+#if defined(__cpp_lib_is_constant_evaluated)
+#define STRONG_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) || defined(__clang__)
+#define STRONG_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#error "STRONG_PROFILE_VALUES requires C++20 std::is_constant_evaluated, GCC or Clang"
+#endif
+
+#define STRONG_PROFILE_VALUE(TypeName, value) ::strong::detail::profile_value<TypeName>(value)
+#define STRONG_PROFILED(TypeName, value, expression) \
+  (STRONG_CONSTANT_EVALUATED() ? (expression) : (STRONG_PROFILE_VALUE(TypeName, value), (expression)))
+
+#else
+
+#define STRONG_PROFILE_VALUE(TypeName, value) static_cast<void>(0)
+#define STRONG_PROFILED(TypeName, value, expression) (expression)
+
+#endif
+
 /**
  * Namespace for creating strong typedefs.
  */
@@ -44,7 +76,7 @@ public:
    *
    * @param v The value to copy.
    */
-  explicit constexpr type(Type const &v) : value(v)
+  explicit constexpr type(Type const &v) : value(STRONG_PROFILED(TypeName, v, v))
   {
   }
 
@@ -58,7 +90,7 @@ public:
    * @param v The value to move.
    */
   explicit constexpr type(Type && v) noexcept(std::is_nothrow_move_constructible<Type>::value)
-    : value(static_cast<Type &&>(v))
+    : value(STRONG_PROFILED(TypeName, v, static_cast<Type &&>(v)))
   {
   }
 
@@ -113,6 +145,132 @@ constexpr Type const & get(type<TypeName, Type> const &object) noexcept
   return static_cast<Type const &>(object);
 };
 
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+
+/**
+ * A strong typedef wrapper around some Type that can be used as a non-type template parameter.
+ *
+ * C++20 allows class types as template parameters only if they are structural, i.e. all their
+ * bases and members are public. The value of type is private, so this variant exists for strong
+ * constants that drive compile-time specialization, e.g. template<cycle_count Latency>. Apart from
+ * the public member it behaves exactly like type, works with the same operations, and should be
+ * accessed with get like any other strong typedef.
+ *
+ * The derived strong typedef, and any operations it inherits, must also have only public bases and
+ * members, and Type must itself be structural.
+ *
+ * @tparam TypeName A unique identifier for this type
+ * @tparam Type The underlying type (e.g. int) to use
+ */
+template<class TypeName, typename Type>
+struct structural {
+  /**
+   * The default constructor of structural will attempt to initialize the underlying value with its
+   * own default constructor.
+   */
+  constexpr structural() : value()
+  {
+  }
+
+  /**
+   * Initialize the underlying value via a copy.
+   *
+   * @param v The value to copy.
+   */
+  explicit constexpr structural(Type const &v) : value(v)
+  {
+  }
+
+  /**
+   * Initialize the underlying value via a move.
+   *
+   * @param v The value to move.
+   */
+  explicit constexpr structural(Type && v) noexcept(std::is_nothrow_move_constructible<Type>::value)
+    : value(static_cast<Type &&>(v))
+  {
+  }
+
+  /**
+   * Enables explicit conversion of the type.
+   *
+   * @return The underlying value.
+   */
+  explicit constexpr operator Type &() noexcept
+  {
+    return value;
+  }
+
+  /**
+   * Enables const-correct explicit conversion of the type.
+   *
+   * @return The underlying value.
+   */
+  explicit constexpr operator Type const &() const noexcept
+  {
+    return value;
+  }
+
+  /**
+   * The underlying value, public only because structural types require it.
+   */
+  Type value;
+};
+
+/**
+ * Access the underlying value of a mutable structural strong type.
+ *
+ * @tparam TypeName The name of the strong typedef
+ * @tparam Type The underlying type of the strong typedef
+ * @param object The instance of the strong type
+ * @return A reference to the underlying value
+ */
+template<class TypeName, typename Type>
+constexpr Type & get(structural<TypeName, Type> &object) noexcept
+{
+  return object.value;
+}
+
+/**
+ * Access the underlying value of an immutable structural strong type.
+ *
+ * @tparam TypeName The name of the strong typedef
+ * @tparam Type The underlying type of the strong typedef
+ * @param object The instance of the strong type
+ * @return A reference to the underlying value
+ */
+template<class TypeName, typename Type>
+constexpr Type const & get(structural<TypeName, Type> const &object) noexcept
+{
+  return object.value;
+}
+
+#endif
+
+namespace detail {
+
+template<class TypeName, typename Type>
+Type underlying(type<TypeName, Type> const &object);
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+template<class TypeName, typename Type>
+Type underlying(structural<TypeName, Type> const &object);
+#endif
+
+}
+
+/**
+ * Determine the underlying type of a strong typedef.
+ *
+ * For example, the underlying type of a strong typedef deriving from type<my_type, int> is int.
+ *
+ * @tparam TypeName The strong typedef to inspect.
+ */
+template<class TypeName>
+struct underlying_type {
+  using type = decltype(detail::underlying(std::declval<TypeName const &>()));
+};
+
 /**
  * Operations to enable on strong typedefs.
  */
@@ -240,6 +398,7 @@ public:
   friend TypeName & operator+=(TypeName &lhs, TypeName const &rhs)
   {
     get(lhs) += get(rhs);
+    STRONG_PROFILE_VALUE(TypeName, get(lhs));
     return lhs;
   }
 };
@@ -274,6 +433,7 @@ public:
   friend TypeName & operator-=(TypeName &lhs, TypeName const &rhs)
   {
     get(lhs) -= get(rhs);
+    STRONG_PROFILE_VALUE(TypeName, get(lhs));
     return lhs;
   }
 };
@@ -308,6 +468,7 @@ public:
   friend TypeName & operator*=(TypeName &lhs, TypeName const &rhs)
   {
     get(lhs) *= get(rhs);
+    STRONG_PROFILE_VALUE(TypeName, get(lhs));
     return lhs;
   }
 };
@@ -342,6 +503,7 @@ public:
   friend TypeName & operator/=(TypeName &lhs, TypeName const &rhs)
   {
     get(lhs) /= get(rhs);
+    STRONG_PROFILE_VALUE(TypeName, get(lhs));
     return lhs;
   }
 };
@@ -385,6 +547,7 @@ public:
     // this is of type increment, which should also be of type TypeName (so we cast it)
     auto & object = static_cast<TypeName &>(*this);
     ++get(object);
+    STRONG_PROFILE_VALUE(TypeName, get(object));
     return object;
   }
 
@@ -422,6 +585,7 @@ public:
     // this is of type decrement, which should also be of type TypeName (so we cast it)
     auto & object = static_cast<TypeName &>(*this);
     --get(object);
+    STRONG_PROFILE_VALUE(TypeName, get(object));
     return object;
   }
 
@@ -482,7 +646,9 @@ public:
    */
   friend std::istream & operator>>(std::istream & stream, TypeName &value)
   {
-    return stream >> get(value);
+    stream >> get(value);
+    STRONG_PROFILE_VALUE(TypeName, get(value));
+    return stream;
   }
 };
 
@@ -491,4 +657,8 @@ public:
 
 }
 
+#ifdef STRONG_PROFILE_VALUES
+#include <strong/value_profile.hpp>
+#endif
+
 #endif //STRONG_STRONG_HPP
@@ -0,0 +1,69 @@
+#ifndef STRONG_ALIGNED_ALLOCATOR_HPP
+#define STRONG_ALIGNED_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+namespace strong {
+
+namespace detail {
+
+// std::allocator only honours alignments up to alignof(std::max_align_t) before C++17
+template<typename T, std::size_t Alignment>
+struct aligned_allocator {
+  static_assert((Alignment & (Alignment - 1)) == 0 && Alignment >= alignof(void *),
+                "aligned_allocator requires a power of two alignment of at least that of a pointer");
+
+  using value_type = T;
+
+  template<typename U>
+  struct rebind {
+    using other = aligned_allocator<U, Alignment>;
+  };
+
+  aligned_allocator() = default;
+
+  template<typename U>
+  aligned_allocator(aligned_allocator<U, Alignment> const &) noexcept
+  {
+  }
+
+  T * allocate(std::size_t count)
+  {
+    if(count > (std::numeric_limits<std::size_t>::max() - Alignment - sizeof(void *)) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+
+    // over-allocate, align, and keep the original pointer just before the aligned block
+    auto const raw = static_cast<unsigned char *>(::operator new(count * sizeof(T) + Alignment + sizeof(void *)));
+    auto const start = reinterpret_cast<std::uintptr_t>(raw + sizeof(void *));
+    auto const aligned = reinterpret_cast<unsigned char *>((start + Alignment - 1) & ~(Alignment - 1));
+    reinterpret_cast<void **>(aligned)[-1] = raw;
+    return reinterpret_cast<T *>(aligned);
+  }
+
+  void deallocate(T *pointer, std::size_t) noexcept
+  {
+    ::operator delete(reinterpret_cast<void **>(pointer)[-1]);
+  }
+
+  template<typename U>
+  friend bool operator==(aligned_allocator const &, aligned_allocator<U, Alignment> const &) noexcept
+  {
+    return true;
+  }
+
+  template<typename U>
+  friend bool operator!=(aligned_allocator const &, aligned_allocator<U, Alignment> const &) noexcept
+  {
+    return false;
+  }
+};
+
+}
+
+}
+
+#endif //STRONG_ALIGNED_ALLOCATOR_HPP
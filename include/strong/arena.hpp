@@ -0,0 +1,377 @@
+#ifndef STRONG_ARENA_HPP
+#define STRONG_ARENA_HPP
+
+#include <strong.hpp>
+#include <strong/aligned_allocator.hpp>
+#include <strong/tag.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+/**
+ * A reference to an object in an arena of the same tag, stored as its 32-bit offset.
+ *
+ * The offset is relative to the start of the arena, so references stay valid when the arena grows,
+ * is copied, or is written out and mapped back in, and they take half the space of a pointer. A
+ * reference can only be resolved by an arena with the same Tag and only as a T. The default
+ * reference is null.
+ *
+ * @tparam Tag The tag of the arena.
+ * @tparam T The type of the object.
+ */
+template<class Tag, typename T>
+class arena_ref
+  : public type<arena_ref<Tag, T>, std::uint32_t>
+  , public op::equals<arena_ref<Tag, T>> {
+public:
+  using type<arena_ref<Tag, T>, std::uint32_t>::type;
+
+  /**
+   * @return Whether the reference refers to an object.
+   */
+  explicit constexpr operator bool() const noexcept
+  {
+    return get(*this) != 0;
+  }
+
+  /**
+   * Refer to another element of an array allocated in the arena.
+   *
+   * @param ref A reference to an element.
+   * @param count The number of elements to move forward.
+   * @return A reference to the element count places after the one of ref.
+   */
+  friend constexpr arena_ref operator+(arena_ref const &ref, std::uint32_t count) noexcept
+  {
+    return arena_ref(get(ref) + count * static_cast<std::uint32_t>(sizeof(T)));
+  }
+};
+
+namespace detail {
+
+struct arena_header {
+  std::uint64_t magic;
+  std::uint64_t fingerprint;
+  std::uint64_t size;
+};
+
+constexpr std::uint64_t arena_magic = 0x414e455241525453; // "STRARENA"
+
+// objects start after the header, so that offset 0 is never a valid reference
+constexpr std::size_t arena_start = 64;
+
+template<class Tag>
+std::uint64_t arena_fingerprint()
+{
+  auto const &name = tag_name<Tag>();
+  return fnv1a(name.data(), name.size());
+}
+
+// offsets of mapped or reloaded arenas are untrusted, and a misaligned one would make a misaligned
+// reference
+inline void check_arena_ref(std::uint32_t offset, std::size_t size, std::size_t alignment, std::size_t length,
+                            char const *name)
+{
+  if(offset < arena_start || offset + size > length) {
+    throw std::out_of_range(std::string(name) + ": reference is outside the arena");
+  }
+  if(offset % alignment != 0) {
+    throw std::invalid_argument(std::string(name) + ": reference is misaligned for its type");
+  }
+}
+
+template<typename T>
+struct check_arena_type {
+  static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                "arenas can only hold trivially copyable types, so that they can be copied byte by byte");
+  static_assert(alignof(T) <= arena_start, "arenas can only hold types aligned to at most 64 bytes");
+};
+
+}
+
+/**
+ * A read-only view of an arena in memory that the view does not own, such as a mapped file.
+ *
+ * @tparam Tag The tag of the arena.
+ */
+template<class Tag>
+class arena_view {
+public:
+  /**
+   * View the contents of an arena.
+   *
+   * @param data The contents of the arena, as given by arena::data; must be aligned to 64 bytes.
+   * @param size The size of the contents in bytes.
+   * @throws std::invalid_argument If the data is not an arena of this tag.
+   */
+  arena_view(void const *data, std::size_t size) : base(static_cast<unsigned char const *>(data)), length(size)
+  {
+    detail::arena_header header;
+    if(size < detail::arena_start) {
+      throw std::invalid_argument("strong::arena_view: data is too short to be an arena");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if(header.magic != detail::arena_magic || header.size < detail::arena_start || header.size > size) {
+      throw std::invalid_argument("strong::arena_view: data is not an arena");
+    }
+    if(header.fingerprint != detail::arena_fingerprint<Tag>()) {
+      throw std::invalid_argument("strong::arena_view: arena has a different tag");
+    }
+    if(reinterpret_cast<std::uintptr_t>(data) % detail::arena_start != 0) {
+      throw std::invalid_argument("strong::arena_view: data is not aligned to 64 bytes");
+    }
+    length = static_cast<std::size_t>(header.size);
+  }
+
+  /**
+   * Resolve a reference without checking it.
+   *
+   * @param ref A non-null reference into this arena.
+   * @return The object.
+   */
+  template<typename T>
+  T const & operator[](arena_ref<Tag, T> const &ref) const noexcept
+  {
+    return *reinterpret_cast<T const *>(base + get(ref));
+  }
+
+  /**
+   * Resolve a reference.
+   *
+   * @param ref A reference into this arena.
+   * @return The object.
+   * @throws std::out_of_range If the reference is null or past the end of the arena.
+   * @throws std::invalid_argument If the reference is not aligned for T.
+   */
+  template<typename T>
+  T const & at(arena_ref<Tag, T> const &ref) const
+  {
+    detail::check_arena_ref(get(ref), sizeof(T), alignof(T), length, "strong::arena_view");
+    return (*this)[ref];
+  }
+
+  /**
+   * @return The size of the arena in bytes.
+   */
+  std::size_t size() const noexcept
+  {
+    return length;
+  }
+
+private:
+  unsigned char const *base;
+  std::size_t length;
+};
+
+/**
+ * A bump allocator for structures that are built once and then read many times.
+ *
+ * Objects are placed one after another in a single block of memory and referred to by arena_ref,
+ * a 32-bit offset from the start of the block, so resolving a reference is one addition. The
+ * block holds no pointers, so the arena can be copied with memcpy, written to a file, and read
+ * back or mapped with arena_view. Objects are never destroyed individually, so they must be
+ * trivially copyable and trivially destructible. An arena holds at most 4 GiB.
+ *
+ * @tparam Tag A type that identifies the arena, so that references into one kind of arena cannot
+ *             be resolved by another.
+ */
+template<class Tag>
+class arena {
+public:
+  /**
+   * Construct an empty arena.
+   *
+   * @param capacity The number of bytes to reserve for objects.
+   */
+  explicit arena(std::size_t capacity = 0)
+  {
+    bytes.reserve(detail::arena_start + capacity);
+    bytes.resize(detail::arena_start);
+    write_header();
+  }
+
+  /**
+   * Construct an arena from the contents of another, e.g. read from a file.
+   *
+   * @param data The contents of an arena, as given by data.
+   * @param size The size of the contents in bytes.
+   * @throws std::invalid_argument If the data is not an arena of this tag.
+   */
+  arena(void const *data, std::size_t size)
+  {
+    // copy into aligned memory first, so that the view can check it in place
+    auto const begin = static_cast<unsigned char const *>(data);
+    bytes.assign(begin, begin + size);
+    bytes.resize(arena_view<Tag>(bytes.data(), bytes.size()).size());
+  }
+
+  /**
+   * Construct an object in the arena.
+   *
+   * @param args The arguments forwarded to the constructor of the object.
+   * @return A reference to the object.
+   * @throws std::length_error If the arena would exceed 4 GiB.
+   */
+  template<typename T, typename... Args>
+  arena_ref<Tag, T> make(Args &&... args)
+  {
+    detail::check_arena_type<T>();
+    auto const offset = allocate(sizeof(T), alignof(T));
+    ::new(static_cast<void *>(bytes.data() + offset)) T(std::forward<Args>(args)...);
+    return arena_ref<Tag, T>(offset);
+  }
+
+  /**
+   * Construct an array of copies of a value in the arena.
+   *
+   * @param count The number of elements.
+   * @param value The value to copy into each element.
+   * @return A reference to the first element; the others are reached by adding to it.
+   * @throws std::length_error If the arena would exceed 4 GiB.
+   */
+  template<typename T>
+  arena_ref<Tag, T> make_array(std::size_t count, T const &value = T())
+  {
+    detail::check_arena_type<T>();
+    if(count > (std::numeric_limits<std::uint32_t>::max)() / sizeof(T)) {
+      throw std::length_error("strong::arena: arena would exceed 4 GiB");
+    }
+    auto const offset = allocate(count * sizeof(T), alignof(T));
+    for(std::size_t i = 0; i < count; ++i) {
+      ::new(static_cast<void *>(bytes.data() + offset + i * sizeof(T))) T(value);
+    }
+    return arena_ref<Tag, T>(offset);
+  }
+
+  /**
+   * Resolve a reference without checking it.
+   *
+   * @param ref A non-null reference into this arena.
+   * @return The object.
+   */
+  template<typename T>
+  T & operator[](arena_ref<Tag, T> const &ref) noexcept
+  {
+    return *reinterpret_cast<T *>(bytes.data() + get(ref));
+  }
+
+  /**
+   * Resolve a reference without checking it.
+   *
+   * @param ref A non-null reference into this arena.
+   * @return The object.
+   */
+  template<typename T>
+  T const & operator[](arena_ref<Tag, T> const &ref) const noexcept
+  {
+    return *reinterpret_cast<T const *>(bytes.data() + get(ref));
+  }
+
+  /**
+   * Resolve a reference.
+   *
+   * @param ref A reference into this arena.
+   * @return The object.
+   * @throws std::out_of_range If the reference is null or past the end of the arena.
+   * @throws std::invalid_argument If the reference is not aligned for T.
+   */
+  template<typename T>
+  T & at(arena_ref<Tag, T> const &ref)
+  {
+    detail::check_arena_ref(get(ref), sizeof(T), alignof(T), bytes.size(), "strong::arena");
+    return (*this)[ref];
+  }
+
+  /**
+   * Resolve a reference.
+   *
+   * @param ref A reference into this arena.
+   * @return The object.
+   * @throws std::out_of_range If the reference is null or past the end of the arena.
+   * @throws std::invalid_argument If the reference is not aligned for T.
+   */
+  template<typename T>
+  T const & at(arena_ref<Tag, T> const &ref) const
+  {
+    detail::check_arena_ref(get(ref), sizeof(T), alignof(T), bytes.size(), "strong::arena");
+    return (*this)[ref];
+  }
+
+  /**
+   * Reserve memory for objects.
+   *
+   * @param capacity The number of bytes to reserve for objects, in addition to those in use.
+   */
+  void reserve(std::size_t capacity)
+  {
+    bytes.reserve(bytes.size() + capacity);
+  }
+
+  /**
+   * Remove every object, invalidating all references.
+   */
+  void clear() noexcept
+  {
+    bytes.resize(detail::arena_start);
+    write_header();
+  }
+
+  /**
+   * @return A read-only view of the arena, which is invalidated when objects are added.
+   */
+  arena_view<Tag> view() const
+  {
+    return arena_view<Tag>(bytes.data(), bytes.size());
+  }
+
+  /**
+   * @return The contents of the arena, to be copied or written out and later read back with the
+   *         constructor from data or with arena_view.
+   */
+  void const * data() const noexcept
+  {
+    return bytes.data();
+  }
+
+  /**
+   * @return The size of the contents of the arena in bytes.
+   */
+  std::size_t size() const noexcept
+  {
+    return bytes.size();
+  }
+
+private:
+  std::uint32_t allocate(std::size_t size, std::size_t alignment)
+  {
+    auto const offset = (bytes.size() + alignment - 1) / alignment * alignment;
+    if(offset + size > (std::numeric_limits<std::uint32_t>::max)()) {
+      throw std::length_error("strong::arena: arena would exceed 4 GiB");
+    }
+    bytes.resize(offset + size);
+    write_header();
+    return static_cast<std::uint32_t>(offset);
+  }
+
+  void write_header() noexcept
+  {
+    detail::arena_header const header = {detail::arena_magic, detail::arena_fingerprint<Tag>(), bytes.size()};
+    std::memcpy(bytes.data(), &header, sizeof(header));
+  }
+
+  std::vector<unsigned char, detail::aligned_allocator<unsigned char, detail::arena_start>> bytes;
+};
+
+}
+
+#endif //STRONG_ARENA_HPP
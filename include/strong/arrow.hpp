@@ -0,0 +1,993 @@
+#ifndef STRONG_ARROW_HPP
+#define STRONG_ARROW_HPP
+
+#include <strong.hpp>
+#include <strong/mapped_file.hpp>
+#include <strong/tag.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace strong {
+
+/**
+ * The two Arrow IPC formats.
+ */
+enum class arrow_format {
+  /**
+   * The random access file format (.arrow or .feather), framed by the "ARROW1" magic.
+   */
+  file,
+
+  /**
+   * The streaming format, a plain sequence of messages.
+   */
+  stream
+};
+
+/**
+ * The custom metadata key under which the tag name of a strong typedef is stored on each field.
+ */
+constexpr char const *arrow_tag_key = "strong.tag";
+
+namespace detail {
+
+// A minimal FlatBuffers encoder, enough for the Arrow IPC metadata. The object tree is built in
+// memory and then written front to back: a table is written before the objects it refers to, and
+// its offsets are patched once they have been written, so that every offset points forward as
+// the format requires. Scalars are aligned to their size and written little-endian.
+class flat_node {
+public:
+  using pointer = std::shared_ptr<flat_node>;
+
+  static pointer table()
+  {
+    return pointer(new flat_node(kind::table));
+  }
+
+  static pointer string(std::string const &text)
+  {
+    auto node = pointer(new flat_node(kind::string));
+    node->bytes.assign(text.begin(), text.end());
+    return node;
+  }
+
+  static pointer tables(std::vector<pointer> items)
+  {
+    auto node = pointer(new flat_node(kind::tables));
+    node->items = std::move(items);
+    return node;
+  }
+
+  // structs are passed as their little-endian bytes, and must need at most 8-byte alignment
+  static pointer structs(std::vector<unsigned char> bytes, std::size_t count)
+  {
+    auto node = pointer(new flat_node(kind::structs));
+    node->bytes = std::move(bytes);
+    node->count = count;
+    return node;
+  }
+
+  template<typename T>
+  flat_node & scalar(unsigned id, T value)
+  {
+    fields.push_back(field{id, sizeof(T), static_cast<std::uint64_t>(value), nullptr});
+    return *this;
+  }
+
+  flat_node & child(unsigned id, pointer node)
+  {
+    fields.push_back(field{id, 0, 0, std::move(node)});
+    return *this;
+  }
+
+  std::vector<unsigned char> finish() const
+  {
+    std::vector<unsigned char> buffer(4, 0);
+    patch(buffer, 0, write(buffer));
+    return buffer;
+  }
+
+private:
+  enum class kind {
+    table,
+    string,
+    tables,
+    structs
+  };
+
+  struct field {
+    unsigned id;
+    unsigned size;
+    std::uint64_t value;
+    pointer node;
+  };
+
+  explicit flat_node(kind type) : type(type)
+  {
+  }
+
+  static void put(std::vector<unsigned char> &buffer, std::size_t position, std::uint64_t value, unsigned size)
+  {
+    for(unsigned i = 0; i < size; ++i) {
+      buffer[position + i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+  }
+
+  static std::size_t grow(std::vector<unsigned char> &buffer, std::size_t alignment, std::size_t size)
+  {
+    auto const position = (buffer.size() + alignment - 1) / alignment * alignment;
+    buffer.resize(position + size, 0);
+    return position;
+  }
+
+  static void patch(std::vector<unsigned char> &buffer, std::size_t position, std::size_t target)
+  {
+    put(buffer, position, target - position, 4);
+  }
+
+  std::size_t write(std::vector<unsigned char> &buffer) const
+  {
+    switch(type) {
+    case kind::string: {
+      auto const position = grow(buffer, 4, 4 + bytes.size() + 1);
+      put(buffer, position, bytes.size(), 4);
+      std::copy(bytes.begin(), bytes.end(), buffer.begin() + static_cast<std::ptrdiff_t>(position + 4));
+      return position;
+    }
+    case kind::structs: {
+      // align the elements rather than the length that precedes them
+      auto const position = (buffer.size() + 11) / 8 * 8 - 4;
+      buffer.resize(position + 4 + bytes.size(), 0);
+      put(buffer, position, count, 4);
+      std::copy(bytes.begin(), bytes.end(), buffer.begin() + static_cast<std::ptrdiff_t>(position + 4));
+      return position;
+    }
+    case kind::tables: {
+      auto const position = grow(buffer, 4, 4 + 4 * items.size());
+      put(buffer, position, items.size(), 4);
+      for(std::size_t i = 0; i < items.size(); ++i) {
+        patch(buffer, position + 4 + 4 * i, items[i]->write(buffer));
+      }
+      return position;
+    }
+    default:
+      return write_table(buffer);
+    }
+  }
+
+  std::size_t write_table(std::vector<unsigned char> &buffer) const
+  {
+    // lay out the fields largest first, after the offset to the vtable
+    auto order = fields;
+    std::stable_sort(order.begin(), order.end(), [](field const &lhs, field const &rhs) {
+      return (lhs.node ? 4 : lhs.size) > (rhs.node ? 4 : rhs.size);
+    });
+    unsigned slots = 0;
+    std::vector<std::size_t> offsets;
+    std::size_t end = 4;
+    for(auto const &item : order) {
+      auto const size = item.node ? 4u : item.size;
+      end = (end + size - 1) / size * size;
+      offsets.push_back(end);
+      end += size;
+      slots = std::max(slots, item.id + 1);
+    }
+
+    auto const vtable = grow(buffer, 2, 4 + 2 * slots);
+    put(buffer, vtable, 4 + 2 * slots, 2);
+    put(buffer, vtable + 2, end, 2);
+    for(std::size_t i = 0; i < order.size(); ++i) {
+      put(buffer, vtable + 4 + 2 * order[i].id, offsets[i], 2);
+    }
+
+    // the table starts 8-byte aligned so that its 8-byte fields are aligned in the buffer
+    auto const table = grow(buffer, 8, end);
+    put(buffer, table, table - vtable, 4);
+    for(std::size_t i = 0; i < order.size(); ++i) {
+      if(!order[i].node) {
+        put(buffer, table + offsets[i], order[i].value, order[i].size);
+      }
+    }
+    for(std::size_t i = 0; i < order.size(); ++i) {
+      if(order[i].node) {
+        patch(buffer, table + offsets[i], order[i].node->write(buffer));
+      }
+    }
+    return table;
+  }
+
+  kind type;
+  std::vector<field> fields;
+  std::vector<unsigned char> bytes;
+  std::vector<pointer> items;
+  std::size_t count = 0;
+};
+
+// Bounds-checked access to the tables of a FlatBuffer.
+class flat_table {
+public:
+  flat_table(unsigned char const *data, std::size_t size, std::size_t position)
+    : data(data), size(size), position(position)
+  {
+    auto const offset = static_cast<std::int32_t>(read(position, 4));
+    vtable = position - static_cast<std::size_t>(static_cast<std::ptrdiff_t>(offset));
+    slots = (read(vtable, 2) - 4) / 2;
+  }
+
+  static flat_table root(unsigned char const *data, std::size_t size)
+  {
+    flat_table header(data, size);
+    return flat_table(data, size, header.read(0, 4));
+  }
+
+  bool has(unsigned id) const
+  {
+    return field(id) != 0;
+  }
+
+  template<typename T>
+  T scalar(unsigned id, T fallback) const
+  {
+    auto const offset = field(id);
+    return offset == 0 ? fallback : static_cast<T>(read(position + offset, sizeof(T)));
+  }
+
+  flat_table table(unsigned id) const
+  {
+    return flat_table(data, size, target(id));
+  }
+
+  std::string string(unsigned id) const
+  {
+    if(!has(id)) {
+      return std::string();
+    }
+    auto const start = target(id);
+    auto const length = read(start, 4);
+    check(start + 4, length);
+    return std::string(reinterpret_cast<char const *>(data + start + 4), length);
+  }
+
+  std::size_t length(unsigned id) const
+  {
+    return has(id) ? read(target(id), 4) : 0;
+  }
+
+  flat_table element(unsigned id, std::size_t index) const
+  {
+    auto const start = target(id) + 4 + 4 * index;
+    return flat_table(data, size, start + read(start, 4));
+  }
+
+  // read field_offset (in bytes) of the index-th struct of the given size in a vector of structs
+  std::uint64_t structure(unsigned id, std::size_t index, std::size_t struct_size, std::size_t field_offset,
+                          unsigned field_size) const
+  {
+    return read(target(id) + 4 + struct_size * index + field_offset, field_size);
+  }
+
+private:
+  flat_table(unsigned char const *data, std::size_t size) : data(data), size(size), position(0), vtable(0), slots(0)
+  {
+  }
+
+  void check(std::size_t start, std::size_t count) const
+  {
+    if(start > size || count > size - start) {
+      throw std::invalid_argument("strong::arrow_reader: malformed metadata");
+    }
+  }
+
+  std::uint64_t read(std::size_t start, std::size_t count) const
+  {
+    check(start, count);
+    std::uint64_t value = 0;
+    for(std::size_t i = 0; i < count; ++i) {
+      value |= std::uint64_t(data[start + i]) << (8 * i);
+    }
+    return value;
+  }
+
+  std::size_t field(unsigned id) const
+  {
+    return id < slots ? static_cast<std::size_t>(read(vtable + 4 + 2 * id, 2)) : 0;
+  }
+
+  std::size_t target(unsigned id) const
+  {
+    auto const offset = field(id);
+    if(offset == 0) {
+      throw std::invalid_argument("strong::arrow_reader: malformed metadata");
+    }
+    return position + offset + static_cast<std::size_t>(read(position + offset, 4));
+  }
+
+  unsigned char const *data;
+  std::size_t size;
+  std::size_t position;
+  std::size_t vtable;
+  std::size_t slots;
+};
+
+// identifiers from the Arrow Schema.fbs and Message.fbs definitions
+constexpr std::int16_t arrow_metadata_v5 = 4;
+constexpr std::uint8_t arrow_schema_message = 1;
+constexpr std::uint8_t arrow_record_batch_message = 3;
+constexpr std::uint8_t arrow_int = 2;
+constexpr std::uint8_t arrow_floating_point = 3;
+constexpr std::uint32_t arrow_continuation = 0xffffffff;
+constexpr char arrow_magic[] = "ARROW1";
+
+struct arrow_type {
+  std::uint8_t id;
+  unsigned bit_width;
+  bool is_signed;
+};
+
+template<typename T>
+arrow_type arrow_type_of() noexcept
+{
+  static_assert((std::is_integral<T>::value && !std::is_same<T, bool>::value)
+                  || (std::is_floating_point<T>::value && (sizeof(T) == 4 || sizeof(T) == 8)),
+                "Arrow columns require a strong typedef with an integral, float or double underlying type");
+  return arrow_type{std::is_integral<T>::value ? arrow_int : arrow_floating_point, unsigned(8 * sizeof(T)),
+                    std::is_signed<T>::value};
+}
+
+inline bool little_endian() noexcept
+{
+  std::uint16_t const probe = 1;
+  unsigned char first;
+  std::memcpy(&first, &probe, 1);
+  return first == 1;
+}
+
+// the framing of IPC messages is little-endian whatever the byte order of the data
+inline std::uint32_t read_le32(unsigned char const *data) noexcept
+{
+  return std::uint32_t(data[0]) | std::uint32_t(data[1]) << 8 | std::uint32_t(data[2]) << 16 | std::uint32_t(data[3]) << 24;
+}
+
+inline void write_le32(unsigned char *data, std::uint32_t value) noexcept
+{
+  for(unsigned i = 0; i < 4; ++i) {
+    data[i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+}
+
+inline std::size_t arrow_pad(std::size_t bytes) noexcept
+{
+  return (bytes + 7) & ~std::size_t(7);
+}
+
+// the buffers and field nodes that a field and its children occupy in a record batch, or -1 for
+// layouts this reader does not know
+inline void arrow_layout(flat_table const &field, long &nodes, long &buffers)
+{
+  static constexpr int type_buffers[] = {-1, 0, 2, 2, 3, 3, 2, 2, 2, 2, 2, 2, 2, 1, -1, 2, 1, 2, 2, 3, 3, 2};
+  auto const type = field.scalar<std::uint8_t>(2, 0);
+  auto const count = type < sizeof(type_buffers) / sizeof(type_buffers[0]) ? type_buffers[type] : -1;
+  if(count < 0 || buffers < 0) {
+    buffers = -1;
+    return;
+  }
+  nodes += 1;
+  buffers += count;
+  for(std::size_t i = 0; i < field.length(5); ++i) {
+    arrow_layout(field.element(5, i), nodes, buffers);
+  }
+}
+
+}
+
+/**
+ * Writes strong-typed columns as an Arrow IPC file or stream.
+ *
+ * Each column becomes a non-nullable field of the matching Arrow integer or floating point type,
+ * with the tag name of its strong typedef stored in the field's custom metadata under
+ * arrow_tag_key. All columns are written as one record batch. The column values are written to
+ * the output straight from the caller's arrays, with no intermediate copy, so the arrays must stay
+ * alive and unchanged until close is called.
+ */
+class arrow_writer {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Prepare to write to an output stream.
+   *
+   * @param output Receives the IPC data; should be opened in binary mode.
+   * @param format Whether to write the file or the streaming format.
+   */
+  explicit arrow_writer(std::ostream &output, arrow_format format = arrow_format::file)
+    : output(output), format(format)
+  {
+  }
+
+  arrow_writer(arrow_writer const &) = delete;
+  arrow_writer & operator=(arrow_writer const &) = delete;
+
+  /**
+   * Add a column to the record batch.
+   *
+   * @param name The name of the field.
+   * @param values The values of the column, which must outlive the call to close.
+   * @param count The number of values, which must match the columns already added.
+   * @throws std::invalid_argument If the number of rows differs from earlier columns.
+   */
+  template<class TypeName>
+  void add_column(std::string const &name, TypeName const *values, size_type count)
+  {
+    using T = typename underlying_type<TypeName>::type;
+    static_assert(sizeof(TypeName) == sizeof(T) && std::is_standard_layout<TypeName>::value,
+                  "Arrow columns require a strong typedef with the layout of its underlying type");
+
+    if(!columns.empty() && count != rows) {
+      throw std::invalid_argument("strong::arrow_writer: columns must have the same number of rows");
+    }
+    rows = count;
+    columns.push_back(column{name, tag_name<TypeName>(), detail::arrow_type_of<T>(),
+                             reinterpret_cast<unsigned char const *>(values), count * sizeof(T)});
+  }
+
+  /**
+   * Add a column to the record batch.
+   *
+   * @param name The name of the field.
+   * @param values The values of the column, which must outlive the call to close.
+   * @see add_column
+   */
+  template<class TypeName, class Allocator>
+  void add_column(std::string const &name, std::vector<TypeName, Allocator> const &values)
+  {
+    add_column(name, values.data(), values.size());
+  }
+
+  /**
+   * Write the schema, the record batch and, for files, the footer.
+   *
+   * @throws std::runtime_error If the output fails.
+   */
+  void close()
+  {
+    if(format == arrow_format::file) {
+      char const magic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+      write(magic, sizeof(magic));
+    }
+
+    write_message(message(detail::arrow_schema_message, schema(), 0), nullptr);
+
+    std::vector<unsigned char> nodes;
+    std::vector<unsigned char> buffers;
+    std::uint64_t body = 0;
+    for(auto const &item : columns) {
+      append(nodes, rows);
+      append(nodes, 0);
+      append(buffers, body);
+      append(buffers, 0);
+      append(buffers, body);
+      append(buffers, item.bytes);
+      body += detail::arrow_pad(item.bytes);
+    }
+    auto batch = detail::flat_node::table();
+    batch->scalar<std::int64_t>(0, static_cast<std::int64_t>(rows))
+      .child(1, detail::flat_node::structs(std::move(nodes), columns.size()))
+      .child(2, detail::flat_node::structs(std::move(buffers), 2 * columns.size()));
+
+    auto const block_offset = position;
+    auto const metadata = write_message(message(detail::arrow_record_batch_message, batch, body), &columns);
+
+    unsigned char end[8];
+    detail::write_le32(end, detail::arrow_continuation);
+    detail::write_le32(end + 4, 0);
+    write(end, sizeof(end));
+
+    if(format == arrow_format::file) {
+      std::vector<unsigned char> blocks;
+      append(blocks, block_offset);
+      append(blocks, metadata);
+      append(blocks, body);
+      auto footer = detail::flat_node::table();
+      footer->scalar<std::int16_t>(0, detail::arrow_metadata_v5)
+        .child(1, schema())
+        .child(2, detail::flat_node::structs(std::vector<unsigned char>(), 0))
+        .child(3, detail::flat_node::structs(std::move(blocks), 1));
+      auto const bytes = footer->finish();
+      write(bytes.data(), bytes.size());
+      unsigned char size[4];
+      detail::write_le32(size, static_cast<std::uint32_t>(bytes.size()));
+      write(size, sizeof(size));
+      write(detail::arrow_magic, 6);
+    }
+
+    output.flush();
+    if(!output) {
+      throw std::runtime_error("strong::arrow_writer: cannot write the output");
+    }
+  }
+
+private:
+  struct column {
+    std::string name;
+    std::string tag;
+    detail::arrow_type type;
+    unsigned char const *data;
+    size_type bytes;
+  };
+
+  // structs in the metadata are little-endian, and the record batches here only hold 8-byte fields
+  static void append(std::vector<unsigned char> &buffer, std::uint64_t value)
+  {
+    for(unsigned i = 0; i < 8; ++i) {
+      buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+  }
+
+  detail::flat_node::pointer schema() const
+  {
+    std::vector<detail::flat_node::pointer> fields;
+    for(auto const &item : columns) {
+      auto type = detail::flat_node::table();
+      if(item.type.id == detail::arrow_int) {
+        type->scalar<std::int32_t>(0, static_cast<std::int32_t>(item.type.bit_width)).scalar<std::uint8_t>(1, item.type.is_signed);
+      } else {
+        type->scalar<std::int16_t>(0, item.type.bit_width == 32 ? 1 : 2);
+      }
+
+      auto tag = detail::flat_node::table();
+      tag->child(0, detail::flat_node::string(arrow_tag_key)).child(1, detail::flat_node::string(item.tag));
+
+      auto field = detail::flat_node::table();
+      field->child(0, detail::flat_node::string(item.name))
+        .scalar<std::uint8_t>(1, 0)
+        .scalar<std::uint8_t>(2, item.type.id)
+        .child(3, type)
+        .child(5, detail::flat_node::tables({}))
+        .child(6, detail::flat_node::tables({tag}));
+      fields.push_back(field);
+    }
+
+    auto schema = detail::flat_node::table();
+    schema->scalar<std::int16_t>(0, detail::little_endian() ? 0 : 1).child(1, detail::flat_node::tables(fields));
+    return schema;
+  }
+
+  static detail::flat_node::pointer message(std::uint8_t type, detail::flat_node::pointer header, std::uint64_t body)
+  {
+    auto message = detail::flat_node::table();
+    message->scalar<std::int16_t>(0, detail::arrow_metadata_v5)
+      .scalar<std::uint8_t>(1, type)
+      .child(2, std::move(header))
+      .scalar<std::int64_t>(3, static_cast<std::int64_t>(body));
+    return message;
+  }
+
+  // write an encapsulated message and return the length of its metadata, including the prefix
+  std::uint64_t write_message(detail::flat_node::pointer const &message, std::vector<column> const *body)
+  {
+    auto metadata = message->finish();
+    metadata.resize(detail::arrow_pad(metadata.size()), 0);
+    unsigned char prefix[8];
+    detail::write_le32(prefix, detail::arrow_continuation);
+    detail::write_le32(prefix + 4, static_cast<std::uint32_t>(metadata.size()));
+    write(prefix, sizeof(prefix));
+    write(metadata.data(), metadata.size());
+
+    if(body != nullptr) {
+      char const padding[8] = {};
+      for(auto const &item : *body) {
+        write(item.data, item.bytes);
+        write(padding, detail::arrow_pad(item.bytes) - item.bytes);
+      }
+    }
+    return sizeof(prefix) + metadata.size();
+  }
+
+  void write(void const *data, size_type size)
+  {
+    output.write(static_cast<char const *>(data), static_cast<std::streamsize>(size));
+    if(!output) {
+      throw std::runtime_error("strong::arrow_writer: cannot write the output");
+    }
+    position += size;
+  }
+
+  std::ostream &output;
+  arrow_format format;
+  size_type rows = 0;
+  std::uint64_t position = 0;
+  std::vector<column> columns;
+};
+
+namespace detail {
+
+struct arrow_field {
+  std::string name;
+  std::string tag;
+  arrow_type type;
+  bool supported;
+  long node;
+  long buffer;
+};
+
+struct arrow_batch {
+  std::size_t rows;
+  unsigned char const *body;
+  std::size_t body_size;
+  std::vector<std::uint64_t> lengths;
+  std::vector<std::uint64_t> null_counts;
+  std::vector<std::uint64_t> offsets;
+  std::vector<std::uint64_t> sizes;
+};
+
+struct arrow_state {
+  std::unique_ptr<mapped_file> file;
+  std::vector<arrow_field> fields;
+  std::vector<arrow_batch> batches;
+};
+
+}
+
+/**
+ * A column of an Arrow IPC file or stream, read as a strong typedef.
+ *
+ * Each record batch holds a contiguous slice of the column, which can be accessed in place. The
+ * column keeps a mapped file open for as long as it exists.
+ *
+ * @tparam TypeName The strong typedef of the column.
+ */
+template<class TypeName>
+class arrow_column {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * @return The number of values in the column.
+   */
+  size_type size() const noexcept
+  {
+    size_type total = 0;
+    for(auto const &batch : state->batches) {
+      total += batch.rows;
+    }
+    return total;
+  }
+
+  /**
+   * @return The number of record batches.
+   */
+  size_type batches() const noexcept
+  {
+    return state->batches.size();
+  }
+
+  /**
+   * @param batch The index of a record batch.
+   * @return The number of values of the column in the batch.
+   */
+  size_type batch_size(size_type batch) const
+  {
+    return state->batches.at(batch).rows;
+  }
+
+  /**
+   * Access the values of a record batch in place, without copying.
+   *
+   * @param batch The index of a record batch.
+   * @return The values of the column in the batch, or nullptr if the buffer is not aligned for
+   *         the type (in which case read copies them).
+   */
+  TypeName const * data(size_type batch) const
+  {
+    auto const values = bytes(state->batches.at(batch));
+    if(reinterpret_cast<std::uintptr_t>(values) % alignof(TypeName) != 0) {
+      return nullptr;
+    }
+    return reinterpret_cast<TypeName const *>(values);
+  }
+
+  /**
+   * @return Every value of the column, concatenated across record batches.
+   */
+  std::vector<TypeName> read() const
+  {
+    std::vector<TypeName> values(size());
+    auto output = reinterpret_cast<unsigned char *>(values.data());
+    for(auto const &batch : state->batches) {
+      std::memcpy(output, bytes(batch), batch.rows * sizeof(TypeName));
+      output += batch.rows * sizeof(TypeName);
+    }
+    return values;
+  }
+
+private:
+  using T = typename underlying_type<TypeName>::type;
+
+  friend class arrow_reader;
+
+  arrow_column(std::shared_ptr<detail::arrow_state const> state, std::size_t index)
+    : state(std::move(state)), index(index)
+  {
+  }
+
+  unsigned char const * bytes(detail::arrow_batch const &batch) const
+  {
+    auto const &field = state->fields[index];
+    auto const node = static_cast<std::size_t>(field.node);
+    auto const buffer = static_cast<std::size_t>(field.buffer) + 1;
+    if(node >= batch.lengths.size() || buffer >= batch.offsets.size() || batch.lengths[node] != batch.rows
+       || batch.offsets[buffer] > batch.body_size || batch.sizes[buffer] > batch.body_size - batch.offsets[buffer]
+       || batch.rows > batch.sizes[buffer] / sizeof(T)) {
+      throw std::invalid_argument("strong::arrow_reader: malformed record batch");
+    }
+    if(batch.null_counts[node] != 0) {
+      throw std::invalid_argument("strong::arrow_reader: column " + field.name + " holds nulls");
+    }
+    return batch.body + batch.offsets[buffer];
+  }
+
+  std::shared_ptr<detail::arrow_state const> state;
+  std::size_t index;
+};
+
+/**
+ * Reads strong-typed columns from an Arrow IPC file or stream.
+ *
+ * The file is mapped into memory and only the metadata is parsed up front. Fields of integer and
+ * floating point types can be read as any strong typedef with the same underlying representation;
+ * fields written by arrow_writer, or by any tool that sets the arrow_tag_key metadata, must be
+ * read as the strong typedef they were written from. Columns with nulls, dictionary batches and
+ * compressed bodies are not supported.
+ */
+class arrow_reader {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Open an Arrow IPC file or stream, detecting the format.
+   *
+   * @param path The path of the file.
+   * @throws std::runtime_error If the file cannot be opened or mapped.
+   * @throws std::invalid_argument If the file is not valid Arrow IPC data.
+   */
+  explicit arrow_reader(std::string const &path) : state(std::make_shared<detail::arrow_state>())
+  {
+    state->file.reset(new detail::mapped_file(path, "strong::arrow_reader"));
+    parse(state->file->data(), state->file->size());
+  }
+
+  /**
+   * Read Arrow IPC data from memory, detecting the format.
+   *
+   * @param data The data, which must outlive the reader and the columns read from it.
+   * @param size The size of the data in bytes.
+   * @throws std::invalid_argument If the data is not valid Arrow IPC data.
+   */
+  arrow_reader(void const *data, size_type size) : state(std::make_shared<detail::arrow_state>())
+  {
+    parse(static_cast<unsigned char const *>(data), size);
+  }
+
+  /**
+   * @return The number of rows in all record batches.
+   */
+  size_type rows() const noexcept
+  {
+    size_type total = 0;
+    for(auto const &batch : state->batches) {
+      total += batch.rows;
+    }
+    return total;
+  }
+
+  /**
+   * @return The number of fields in the schema.
+   */
+  size_type columns() const noexcept
+  {
+    return state->fields.size();
+  }
+
+  /**
+   * @param column The index of a field.
+   * @return The name of the field.
+   * @throws std::out_of_range If there is no such field.
+   */
+  std::string const & name(size_type column) const
+  {
+    return state->fields.at(column).name;
+  }
+
+  /**
+   * @param column The index of a field.
+   * @return The tag name recorded for the field, or an empty string if there is none.
+   * @throws std::out_of_range If there is no such field.
+   */
+  std::string const & tag(size_type column) const
+  {
+    return state->fields.at(column).tag;
+  }
+
+  /**
+   * Access a field as a strong typedef.
+   *
+   * @tparam TypeName The strong typedef to read the field as.
+   * @param name The name of the field.
+   * @return The column.
+   * @throws std::out_of_range If there is no such field.
+   * @throws std::invalid_argument If the field's Arrow type or recorded tag does not match.
+   */
+  template<class TypeName>
+  arrow_column<TypeName> column(std::string const &name) const
+  {
+    using T = typename underlying_type<TypeName>::type;
+    static_assert(sizeof(TypeName) == sizeof(T) && std::is_standard_layout<TypeName>::value,
+                  "Arrow columns require a strong typedef with the layout of its underlying type");
+
+    std::size_t index = 0;
+    while(index < columns() && state->fields[index].name != name) {
+      ++index;
+    }
+    if(index == columns()) {
+      throw std::out_of_range("strong::arrow_reader: no field " + name);
+    }
+
+    auto const &field = state->fields[index];
+    auto const expected = detail::arrow_type_of<T>();
+    if(!field.supported || field.type.id != expected.id || field.type.bit_width != expected.bit_width
+       || (expected.id == detail::arrow_int && field.type.is_signed != expected.is_signed)) {
+      throw std::invalid_argument("strong::arrow_reader: field " + name + " does not have the Arrow type of "
+                                  + tag_name<TypeName>());
+    }
+    if(!field.tag.empty() && field.tag != tag_name<TypeName>()) {
+      throw std::invalid_argument("strong::arrow_reader: field " + name + " holds " + field.tag + ", not "
+                                  + tag_name<TypeName>());
+    }
+    return arrow_column<TypeName>(state, index);
+  }
+
+private:
+  void parse(unsigned char const *data, size_type size)
+  {
+    auto const what = "strong::arrow_reader: not valid Arrow IPC data";
+    size_type position = 0;
+    if(size >= 8 && std::memcmp(data, detail::arrow_magic, 6) == 0) {
+      // the messages of a file end where its footer starts
+      if(size < 18 || std::memcmp(data + size - 6, detail::arrow_magic, 6) != 0) {
+        throw std::invalid_argument(what);
+      }
+      auto const footer = detail::read_le32(data + size - 10);
+      if(footer > size - 18) {
+        throw std::invalid_argument(what);
+      }
+      position = 8;
+      size -= 10 + footer;
+    }
+
+    bool has_schema = false;
+    while(position + 4 <= size) {
+      // messages are preceded by a continuation marker, except in streams from before Arrow 0.15
+      auto length = detail::read_le32(data + position);
+      position += 4;
+      if(length == detail::arrow_continuation) {
+        if(position + 4 > size) {
+          throw std::invalid_argument(what);
+        }
+        length = detail::read_le32(data + position);
+        position += 4;
+      }
+      if(length == 0) {
+        break;
+      }
+      if(length > size - position) {
+        throw std::invalid_argument(what);
+      }
+
+      auto const message = detail::flat_table::root(data + position, length);
+      position += length;
+      auto const body = static_cast<size_type>(message.scalar<std::int64_t>(3, 0));
+      if(body > size - position) {
+        throw std::invalid_argument(what);
+      }
+
+      auto const type = message.scalar<std::uint8_t>(1, 0);
+      if(type == detail::arrow_schema_message) {
+        parse_schema(message.table(2));
+        has_schema = true;
+      } else if(type == detail::arrow_record_batch_message) {
+        if(!has_schema) {
+          throw std::invalid_argument(what);
+        }
+        parse_batch(message.table(2), data + position, body);
+      } else {
+        throw std::invalid_argument("strong::arrow_reader: only schemas and record batches are supported");
+      }
+      position += body;
+    }
+
+    if(!has_schema) {
+      throw std::invalid_argument(what);
+    }
+  }
+
+  void parse_schema(detail::flat_table const &schema)
+  {
+    if(schema.scalar<std::int16_t>(0, 0) != (detail::little_endian() ? 0 : 1)) {
+      throw std::invalid_argument("strong::arrow_reader: the data has a different byte order");
+    }
+
+    long node = 0;
+    long buffer = 0;
+    for(std::size_t i = 0; i < schema.length(1); ++i) {
+      auto const field = schema.element(1, i);
+      detail::arrow_field item;
+      item.name = field.string(0);
+      item.type = detail::arrow_type{field.scalar<std::uint8_t>(2, 0), 0, false};
+      item.node = node;
+      item.buffer = buffer;
+      item.supported = buffer >= 0 && !field.has(4) && field.has(3);
+
+      if(item.supported && item.type.id == detail::arrow_int) {
+        auto const type = field.table(3);
+        item.type.bit_width = static_cast<unsigned>(type.scalar<std::int32_t>(0, 0));
+        item.type.is_signed = type.scalar<std::uint8_t>(1, 0) != 0;
+      } else if(item.supported && item.type.id == detail::arrow_floating_point) {
+        auto const precision = field.table(3).scalar<std::int16_t>(0, 0);
+        item.type.bit_width = precision == 1 ? 32 : precision == 2 ? 64 : 16;
+      } else {
+        item.supported = false;
+      }
+
+      for(std::size_t j = 0; j < field.length(6); ++j) {
+        auto const pair = field.element(6, j);
+        if(pair.string(0) == arrow_tag_key) {
+          item.tag = pair.string(1);
+        }
+      }
+
+      detail::arrow_layout(field, node, buffer);
+      state->fields.push_back(item);
+    }
+  }
+
+  void parse_batch(detail::flat_table const &batch, unsigned char const *body, size_type size)
+  {
+    if(batch.has(3)) {
+      throw std::invalid_argument("strong::arrow_reader: compressed record batches are not supported");
+    }
+
+    auto const rows = batch.scalar<std::int64_t>(0, 0);
+    if(rows < 0) {
+      throw std::invalid_argument("strong::arrow_reader: malformed record batch");
+    }
+
+    detail::arrow_batch item;
+    item.rows = static_cast<size_type>(rows);
+    item.body = body;
+    item.body_size = size;
+    for(std::size_t i = 0; i < batch.length(1); ++i) {
+      item.lengths.push_back(batch.structure(1, i, 16, 0, 8));
+      item.null_counts.push_back(batch.structure(1, i, 16, 8, 8));
+    }
+    for(std::size_t i = 0; i < batch.length(2); ++i) {
+      item.offsets.push_back(batch.structure(2, i, 16, 0, 8));
+      item.sizes.push_back(batch.structure(2, i, 16, 8, 8));
+    }
+    state->batches.push_back(std::move(item));
+  }
+
+  std::shared_ptr<detail::arrow_state> state;
+};
+
+}
+
+#endif //STRONG_ARROW_HPP
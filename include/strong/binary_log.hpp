@@ -0,0 +1,846 @@
+#ifndef STRONG_BINARY_LOG_HPP
+#define STRONG_BINARY_LOG_HPP
+
+#include <strong.hpp>
+#include <strong/aligned_allocator.hpp>
+#include <strong/bytes.hpp>
+#include <strong/mapped_file.hpp>
+#include <strong/tag.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace strong {
+
+/**
+ * The description of one argument of a log format.
+ */
+struct log_argument {
+  /**
+   * How the raw bytes of an argument are interpreted.
+   */
+  enum class kind : std::uint8_t {
+    signed_integer,
+    unsigned_integer,
+    floating_point
+  };
+
+  /**
+   * The tag name of the argument's strong typedef.
+   */
+  std::string tag;
+
+  /**
+   * The tag fingerprint of the argument's strong typedef.
+   */
+  std::uint64_t fingerprint;
+
+  /**
+   * The kind of the underlying type.
+   */
+  kind type;
+
+  /**
+   * The size of the underlying type in bytes.
+   */
+  std::uint8_t size;
+};
+
+/**
+ * A registered log format: the static text of a log statement and the types of its arguments.
+ */
+struct log_site {
+  /**
+   * The identifier written into every record of the format.
+   */
+  std::uint32_t id;
+
+  /**
+   * The text of the statement, with a {} placeholder for each argument.
+   */
+  std::string format;
+
+  /**
+   * The source file of the statement.
+   */
+  std::string file;
+
+  /**
+   * The source line of the statement.
+   */
+  std::uint32_t line;
+
+  /**
+   * The arguments of the statement.
+   */
+  std::vector<log_argument> arguments;
+};
+
+namespace detail {
+
+constexpr std::uint64_t log_magic = 0x3130474f4c525453ULL; // "STRLOG01"
+constexpr std::uint8_t log_site_entry = 1;
+constexpr std::uint8_t log_chunk_entry = 2;
+constexpr std::uint32_t log_wrap = 0xffffffff;
+constexpr std::size_t log_header_size = 8;
+
+// Every format ever registered, shared by all loggers. Only registration and flushing lock it.
+class log_registry {
+public:
+  static log_registry & instance()
+  {
+    static log_registry registry;
+    return registry;
+  }
+
+  std::uint32_t add(log_site site)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    site.id = static_cast<std::uint32_t>(sites.size());
+    sites.push_back(std::move(site));
+    return sites.back().id;
+  }
+
+  std::vector<log_site> since(std::size_t first)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return first < sites.size() ? std::vector<log_site>(sites.begin() + static_cast<std::ptrdiff_t>(first), sites.end())
+                                : std::vector<log_site>();
+  }
+
+private:
+  std::mutex mutex;
+  std::vector<log_site> sites;
+};
+
+template<class TypeName>
+log_argument describe_log_argument()
+{
+  using T = typename underlying_type<TypeName>::type;
+  static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && sizeof(T) <= 8,
+                "log arguments require a strong typedef with an integral or floating point underlying type");
+  return log_argument{tag_name<TypeName>(), tag_fingerprint<TypeName>(),
+                      std::is_floating_point<T>::value ? log_argument::kind::floating_point
+                      : std::is_signed<T>::value ? log_argument::kind::signed_integer
+                                                 : log_argument::kind::unsigned_integer,
+                      static_cast<std::uint8_t>(sizeof(T))};
+}
+
+constexpr std::size_t log_payload() noexcept
+{
+  return 0;
+}
+
+template<class First, class... Rest>
+constexpr std::size_t log_payload(First const *, Rest const *... rest) noexcept
+{
+  return sizeof(typename underlying_type<First>::type) + log_payload(rest...);
+}
+
+inline std::size_t count_placeholders(std::string const &format)
+{
+  std::size_t count = 0;
+  for(auto position = format.find("{}"); position != std::string::npos; position = format.find("{}", position + 2)) {
+    ++count;
+  }
+  return count;
+}
+
+template<class TypeName>
+void put_log_argument(unsigned char *&output, TypeName const &value) noexcept
+{
+  auto const &raw = get(value);
+  std::memcpy(output, &raw, sizeof(raw));
+  output += sizeof(raw);
+}
+
+// A single-producer, single-consumer ring of log records. The producer is the thread that owns
+// the ring and the consumer is whichever thread flushes the logger. The positions count bytes
+// since the ring was created and are masked into the buffer; each is written by one side only
+// and sits on its own cache line.
+class log_ring {
+public:
+  log_ring(std::size_t capacity, std::thread::id owner) : buffer(capacity), mask(capacity - 1), owner(owner)
+  {
+  }
+
+  // the positions are aligned to cache lines, which plain new does not honour before C++17
+  static void * operator new(std::size_t size)
+  {
+    return aligned_allocator<unsigned char, alignof(log_ring)>().allocate(size);
+  }
+
+  static void operator delete(void *pointer) noexcept
+  {
+    aligned_allocator<unsigned char, alignof(log_ring)>().deallocate(static_cast<unsigned char *>(pointer), 0);
+  }
+
+  // reserve size bytes (a multiple of 4) or return nullptr if the consumer is too far behind
+  unsigned char * reserve(std::size_t size) noexcept
+  {
+    auto position = head.load(std::memory_order_relaxed);
+    auto const offset = static_cast<std::size_t>(position & mask);
+    auto const contiguous = buffer.size() - offset;
+    auto const needed = contiguous < size ? contiguous + size : size;
+
+    if(position + needed - cached_tail > buffer.size()) {
+      cached_tail = tail.load(std::memory_order_acquire);
+      if(position + needed - cached_tail > buffer.size()) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+      }
+    }
+
+    if(contiguous < size) {
+      // records never straddle the end; mark the rest of the buffer as skipped, to be published
+      // together with the record
+      std::memcpy(&buffer[offset], &log_wrap, 4);
+      reserved = position + contiguous;
+      return &buffer[0];
+    }
+    reserved = position;
+    return &buffer[offset];
+  }
+
+  void commit(std::size_t size) noexcept
+  {
+    head.store(reserved + size, std::memory_order_release);
+  }
+
+  // append the committed records to output, leaving out the wrap markers
+  void drain(std::vector<unsigned char> &output)
+  {
+    auto position = tail.load(std::memory_order_relaxed);
+    auto const end = head.load(std::memory_order_acquire);
+    while(position != end) {
+      auto const offset = static_cast<std::size_t>(position & mask);
+      std::uint32_t header[2];
+      std::memcpy(header, &buffer[offset], 4);
+      if(header[0] == log_wrap) {
+        position += buffer.size() - offset;
+        continue;
+      }
+      std::memcpy(header + 1, &buffer[offset + 4], 4);
+      output.insert(output.end(), buffer.begin() + static_cast<std::ptrdiff_t>(offset),
+                    buffer.begin() + static_cast<std::ptrdiff_t>(offset + header[1]));
+      position += header[1];
+    }
+    tail.store(position, std::memory_order_release);
+  }
+
+  std::vector<unsigned char> buffer;
+  std::uint64_t mask;
+  std::thread::id owner;
+  std::atomic<std::uint64_t> dropped{0};
+
+private:
+  alignas(64) std::atomic<std::uint64_t> head{0};
+  std::uint64_t reserved = 0;
+  std::uint64_t cached_tail = 0;
+  alignas(64) std::atomic<std::uint64_t> tail{0};
+};
+
+}
+
+/**
+ * A registered log statement with arguments of the given strong typedefs.
+ *
+ * Formats are meant to be static objects, registered once when they are constructed. Each
+ * placeholder {} in the text stands for one argument.
+ *
+ * @code
+ * static strong::log_format<cycle_count, frequency> const stalled("stalled for {} cycles at {}", __FILE__, __LINE__);
+ * logger.log(stalled, cycles, hertz);
+ * @endcode
+ *
+ * @tparam Args The strong typedefs of the arguments.
+ */
+template<class... Args>
+class log_format {
+public:
+  /**
+   * The number of bytes a record of this format occupies in a log buffer.
+   */
+  static constexpr std::size_t record_size
+    = (detail::log_header_size + detail::log_payload(static_cast<Args const *>(nullptr)...) + 3) / 4 * 4;
+
+  /**
+   * Register a format.
+   *
+   * @param format The text of the statement, with a {} placeholder for each argument.
+   * @param file The source file of the statement.
+   * @param line The source line of the statement.
+   * @throws std::invalid_argument If the number of placeholders does not match the arguments.
+   */
+  explicit log_format(char const *format, char const *file = "", std::uint32_t line = 0)
+  {
+    log_site site;
+    site.format = format;
+    site.file = file;
+    site.line = line;
+    if(detail::count_placeholders(site.format) != sizeof...(Args)) {
+      throw std::invalid_argument("strong::log_format: the placeholders do not match the arguments");
+    }
+    site.arguments = {detail::describe_log_argument<Args>()...};
+    identifier = detail::log_registry::instance().add(std::move(site));
+  }
+
+  /**
+   * @return The identifier written into every record of the format.
+   */
+  std::uint32_t id() const noexcept
+  {
+    return identifier;
+  }
+
+private:
+  std::uint32_t identifier;
+};
+
+template<class... Args>
+constexpr std::size_t log_format<Args...>::record_size;
+
+/**
+ * A logger that records strong values in binary and leaves formatting to a later reader.
+ *
+ * A log call copies the format identifier and the raw underlying values of its arguments into a
+ * ring buffer owned by the calling thread, with no locks, allocation or formatting. Flushing,
+ * either on demand or from a background thread, moves the buffered records to the log file along
+ * with the descriptions of the formats they use, including the tag name and fingerprint of every
+ * argument type. A log_reader then formats the records offline.
+ *
+ * When a thread's buffer is full the record is dropped and counted rather than blocking the
+ * caller. Records of one thread stay in order; records of different threads are interleaved by
+ * flush, so statements that need a global order should log a timestamp argument.
+ */
+class binary_logger {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Create or truncate a log file.
+   *
+   * @param path The path of the file.
+   * @param buffer_size The size in bytes of each thread's buffer, rounded up to a power of two.
+   * @throws std::runtime_error If the file cannot be opened.
+   */
+  explicit binary_logger(std::string const &path, size_type buffer_size = size_type(1) << 20)
+    : file(path, std::ios::binary | std::ios::trunc), serial(next_serial())
+  {
+    if(!file) {
+      throw std::runtime_error("strong::binary_logger: cannot open " + path);
+    }
+    capacity = 64;
+    while(capacity < buffer_size) {
+      capacity *= 2;
+    }
+    std::vector<unsigned char> header;
+    detail::append_bytes(header, detail::log_magic);
+    file.write(reinterpret_cast<char const *>(header.data()), static_cast<std::streamsize>(header.size()));
+  }
+
+  binary_logger(binary_logger const &) = delete;
+  binary_logger & operator=(binary_logger const &) = delete;
+
+  /**
+   * Stop the background thread and flush the remaining records. Errors are ignored.
+   */
+  ~binary_logger()
+  {
+    stop();
+    try {
+      flush();
+    } catch(...) {
+    }
+  }
+
+  /**
+   * Record a log statement.
+   *
+   * @param format The registered format of the statement.
+   * @param args The arguments of the statement.
+   * @return False if the record was dropped because the thread's buffer was full.
+   */
+  template<class... Args>
+  bool log(log_format<Args...> const &format, Args const &... args) noexcept
+  {
+    auto const ring = local_ring();
+    auto const size = log_format<Args...>::record_size;
+    auto const record = ring == nullptr ? nullptr : ring->reserve(size);
+    if(record == nullptr) {
+      return false;
+    }
+
+    std::uint32_t const header[2] = {format.id(), static_cast<std::uint32_t>(size)};
+    std::memcpy(record, header, sizeof(header));
+    auto output = record + sizeof(header);
+    int const expand[] = {0, (detail::put_log_argument(output, args), 0)...};
+    static_cast<void>(expand);
+    static_cast<void>(output);
+    ring->commit(size);
+    return true;
+  }
+
+  /**
+   * Move every buffered record to the log file.
+   *
+   * @throws std::runtime_error If the file cannot be written.
+   */
+  void flush()
+  {
+    std::lock_guard<std::mutex> flushing(flush_mutex);
+
+    std::vector<detail::log_ring *> current;
+    {
+      std::lock_guard<std::mutex> lock(rings_mutex);
+      for(auto const &ring : rings) {
+        current.push_back(ring.get());
+      }
+    }
+
+    std::vector<unsigned char> chunks;
+    std::vector<unsigned char> records;
+    for(std::size_t i = 0; i < current.size(); ++i) {
+      records.clear();
+      current[i]->drain(records);
+      if(!records.empty()) {
+        detail::append_bytes(chunks, detail::log_chunk_entry);
+        detail::append_bytes(chunks, static_cast<std::uint32_t>(i));
+        detail::append_bytes(chunks, static_cast<std::uint32_t>(records.size()));
+        chunks.insert(chunks.end(), records.begin(), records.end());
+      }
+    }
+
+    // the records drained above only use formats registered before now
+    std::vector<unsigned char> output;
+    for(auto const &site : detail::log_registry::instance().since(sites_written)) {
+      detail::append_bytes(output, detail::log_site_entry);
+      detail::append_bytes(output, site.id);
+      detail::append_bytes(output, site.line);
+      append_string(output, site.format);
+      append_string(output, site.file);
+      detail::append_bytes(output, static_cast<std::uint32_t>(site.arguments.size()));
+      for(auto const &argument : site.arguments) {
+        append_string(output, argument.tag);
+        detail::append_bytes(output, argument.fingerprint);
+        detail::append_bytes(output, static_cast<std::uint8_t>(argument.type));
+        detail::append_bytes(output, argument.size);
+      }
+      sites_written = site.id + 1;
+    }
+    output.insert(output.end(), chunks.begin(), chunks.end());
+
+    file.write(reinterpret_cast<char const *>(output.data()), static_cast<std::streamsize>(output.size()));
+    file.flush();
+    if(!file) {
+      throw std::runtime_error("strong::binary_logger: cannot write the log");
+    }
+  }
+
+  /**
+   * Start a background thread that flushes periodically. Errors on that thread are ignored.
+   *
+   * @param interval The time between flushes.
+   */
+  template<class Rep, class Period>
+  void start(std::chrono::duration<Rep, Period> interval)
+  {
+    stop();
+    running = true;
+    background = std::thread([this, interval] {
+      std::unique_lock<std::mutex> lock(background_mutex);
+      while(running) {
+        wake.wait_for(lock, interval);
+        try {
+          flush();
+        } catch(...) {
+        }
+      }
+    });
+  }
+
+  /**
+   * Stop the background thread, if it is running.
+   */
+  void stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(background_mutex);
+      running = false;
+    }
+    wake.notify_all();
+    if(background.joinable()) {
+      background.join();
+    }
+  }
+
+  /**
+   * @return The number of records dropped because a buffer was full.
+   */
+  std::uint64_t dropped() const
+  {
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    std::uint64_t total = 0;
+    for(auto const &ring : rings) {
+      total += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+private:
+  static std::uint64_t next_serial() noexcept
+  {
+    static std::atomic<std::uint64_t> counter{0};
+    return ++counter;
+  }
+
+  static void append_string(std::vector<unsigned char> &buffer, std::string const &value)
+  {
+    detail::append_bytes(buffer, static_cast<std::uint32_t>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+  }
+
+  detail::log_ring * local_ring() noexcept
+  {
+    // each thread remembers its rings for the last few loggers it used
+    struct entry {
+      std::uint64_t serial;
+      detail::log_ring *ring;
+    };
+    static thread_local entry cache[4] = {};
+    static thread_local unsigned next = 0;
+
+    for(auto const &item : cache) {
+      if(item.serial == serial) {
+        return item.ring;
+      }
+    }
+
+    detail::log_ring *ring = nullptr;
+    try {
+      std::lock_guard<std::mutex> lock(rings_mutex);
+      auto const self = std::this_thread::get_id();
+      for(auto const &existing : rings) {
+        if(existing->owner == self) {
+          ring = existing.get();
+        }
+      }
+      if(ring == nullptr) {
+        rings.emplace_back(new detail::log_ring(capacity, self));
+        ring = rings.back().get();
+      }
+    } catch(...) {
+      return nullptr;
+    }
+
+    cache[next++ % 4] = entry{serial, ring};
+    return ring;
+  }
+
+  std::ofstream file;
+  std::uint64_t serial;
+  size_type capacity;
+  std::uint32_t sites_written = 0;
+  mutable std::mutex rings_mutex;
+  std::vector<std::unique_ptr<detail::log_ring>> rings;
+  std::mutex flush_mutex;
+  std::mutex background_mutex;
+  std::condition_variable wake;
+  bool running = false;
+  std::thread background;
+};
+
+/**
+ * One record read back from a binary log.
+ */
+class log_record {
+public:
+  /**
+   * @return The format of the record.
+   */
+  log_site const & site() const noexcept
+  {
+    return *format;
+  }
+
+  /**
+   * @return The index of the thread buffer the record came from, in order of first use.
+   */
+  std::uint32_t thread() const noexcept
+  {
+    return source;
+  }
+
+  /**
+   * Read an argument as the strong typedef it was logged as.
+   *
+   * @tparam TypeName The strong typedef of the argument.
+   * @param index The index of the argument.
+   * @return The argument.
+   * @throws std::out_of_range If there is no such argument.
+   * @throws std::invalid_argument If the argument was logged as a different type.
+   */
+  template<class TypeName>
+  TypeName value(std::size_t index) const
+  {
+    using T = typename underlying_type<TypeName>::type;
+    if(format->arguments.at(index).fingerprint != tag_fingerprint<TypeName>()) {
+      throw std::invalid_argument("strong::log_record: argument is a " + format->arguments[index].tag + ", not "
+                                  + tag_name<TypeName>());
+    }
+    T raw;
+    std::memcpy(&raw, values + offset(index), sizeof(T));
+    return TypeName(raw);
+  }
+
+  /**
+   * @return The text of the record, with each placeholder replaced by its argument.
+   */
+  std::string text() const
+  {
+    std::ostringstream output;
+    std::size_t start = 0;
+    for(std::size_t i = 0; i < format->arguments.size(); ++i) {
+      auto const placeholder = format->format.find("{}", start);
+      output << format->format.substr(start, placeholder - start);
+      print(output, i);
+      start = placeholder + 2;
+    }
+    output << format->format.substr(start);
+    return output.str();
+  }
+
+private:
+  friend class log_reader;
+
+  log_record(log_site const *format, std::uint32_t source, unsigned char const *values)
+    : format(format), source(source), values(values)
+  {
+  }
+
+  std::size_t offset(std::size_t index) const noexcept
+  {
+    std::size_t position = 0;
+    for(std::size_t i = 0; i < index; ++i) {
+      position += format->arguments[i].size;
+    }
+    return position;
+  }
+
+  template<typename T>
+  T raw(std::size_t index) const noexcept
+  {
+    T value;
+    std::memcpy(&value, values + offset(index), sizeof(T));
+    return value;
+  }
+
+  void print(std::ostream &output, std::size_t index) const
+  {
+    auto const &argument = format->arguments[index];
+    switch(argument.type) {
+    case log_argument::kind::floating_point:
+      if(argument.size == sizeof(float)) {
+        output << raw<float>(index);
+      } else {
+        output << raw<double>(index);
+      }
+      break;
+    case log_argument::kind::signed_integer:
+      switch(argument.size) {
+      case 1:
+        output << static_cast<int>(raw<std::int8_t>(index));
+        break;
+      case 2:
+        output << raw<std::int16_t>(index);
+        break;
+      case 4:
+        output << raw<std::int32_t>(index);
+        break;
+      default:
+        output << raw<std::int64_t>(index);
+      }
+      break;
+    default:
+      switch(argument.size) {
+      case 1:
+        output << static_cast<unsigned>(raw<std::uint8_t>(index));
+        break;
+      case 2:
+        output << raw<std::uint16_t>(index);
+        break;
+      case 4:
+        output << raw<std::uint32_t>(index);
+        break;
+      default:
+        output << raw<std::uint64_t>(index);
+      }
+    }
+  }
+
+  log_site const *format;
+  std::uint32_t source;
+  unsigned char const *values;
+};
+
+/**
+ * Reads a log file written by binary_logger.
+ */
+class log_reader {
+public:
+  /**
+   * Open a log file.
+   *
+   * @param path The path of the file.
+   * @throws std::runtime_error If the file cannot be opened.
+   * @throws std::invalid_argument If the file is not a binary log.
+   */
+  explicit log_reader(std::string const &path) : file(path, "strong::log_reader")
+  {
+    auto const what = "strong::log_reader: not a valid binary log";
+    auto data = file.data();
+    auto const end = data + file.size();
+    if(detail::read_bytes<std::uint64_t>(data, end, what) != detail::log_magic) {
+      throw std::invalid_argument(what);
+    }
+
+    // formats are parsed up front so that the records can refer to them
+    while(data != end) {
+      auto const type = detail::read_bytes<std::uint8_t>(data, end, what);
+      if(type == detail::log_site_entry) {
+        log_site site;
+        site.id = detail::read_bytes<std::uint32_t>(data, end, what);
+        site.line = detail::read_bytes<std::uint32_t>(data, end, what);
+        site.format = read_string(data, end, what);
+        site.file = read_string(data, end, what);
+        auto const count = detail::read_bytes<std::uint32_t>(data, end, what);
+        for(std::uint32_t i = 0; i < count; ++i) {
+          log_argument argument;
+          argument.tag = read_string(data, end, what);
+          argument.fingerprint = detail::read_bytes<std::uint64_t>(data, end, what);
+          argument.type = static_cast<log_argument::kind>(detail::read_bytes<std::uint8_t>(data, end, what));
+          argument.size = detail::read_bytes<std::uint8_t>(data, end, what);
+          if(!valid(argument)) {
+            throw std::invalid_argument(what);
+          }
+          site.arguments.push_back(std::move(argument));
+        }
+        if(detail::count_placeholders(site.format) != site.arguments.size()) {
+          throw std::invalid_argument(what);
+        }
+        if(sites.size() <= site.id) {
+          sites.resize(site.id + 1);
+        }
+        sites[site.id] = std::move(site);
+      } else if(type == detail::log_chunk_entry) {
+        chunk item;
+        item.thread = detail::read_bytes<std::uint32_t>(data, end, what);
+        auto const size = detail::read_bytes<std::uint32_t>(data, end, what);
+        if(static_cast<std::size_t>(end - data) < size) {
+          throw std::invalid_argument(what);
+        }
+        item.first = data;
+        item.last = data + size;
+        chunks.push_back(item);
+        data += size;
+      } else {
+        throw std::invalid_argument(what);
+      }
+    }
+  }
+
+  /**
+   * @return The formats described in the log, indexed by identifier.
+   */
+  std::vector<log_site> const & formats() const noexcept
+  {
+    return sites;
+  }
+
+  /**
+   * Visit every record in the order it was flushed.
+   *
+   * @param function Called with each log_record.
+   * @throws std::invalid_argument If a record is malformed.
+   */
+  template<class Function>
+  void for_each(Function function) const
+  {
+    auto const what = "strong::log_reader: malformed record";
+    for(auto const &item : chunks) {
+      auto data = item.first;
+      while(data != item.last) {
+        auto record = data;
+        auto const id = detail::read_bytes<std::uint32_t>(record, item.last, what);
+        auto const size = detail::read_bytes<std::uint32_t>(record, item.last, what);
+        if(id >= sites.size() || size < detail::log_header_size || size > static_cast<std::size_t>(item.last - data)
+           || size < detail::log_header_size + payload(sites[id])) {
+          throw std::invalid_argument(what);
+        }
+        function(log_record(&sites[id], item.thread, record));
+        data += size;
+      }
+    }
+  }
+
+private:
+  struct chunk {
+    std::uint32_t thread;
+    unsigned char const *first;
+    unsigned char const *last;
+  };
+
+  static std::string read_string(unsigned char const *&data, unsigned char const *end, char const *what)
+  {
+    auto const size = detail::read_bytes<std::uint32_t>(data, end, what);
+    if(static_cast<std::size_t>(end - data) < size) {
+      throw std::invalid_argument(what);
+    }
+    std::string value(reinterpret_cast<char const *>(data), size);
+    data += size;
+    return value;
+  }
+
+  // records are decoded by the kind and size of each argument, so only those a logger writes are read
+  static bool valid(log_argument const &argument) noexcept
+  {
+    switch(argument.type) {
+    case log_argument::kind::floating_point:
+      return argument.size == sizeof(float) || argument.size == sizeof(double);
+    case log_argument::kind::signed_integer:
+    case log_argument::kind::unsigned_integer:
+      return argument.size == 1 || argument.size == 2 || argument.size == 4 || argument.size == 8;
+    }
+    return false;
+  }
+
+  static std::size_t payload(log_site const &site) noexcept
+  {
+    std::size_t size = 0;
+    for(auto const &argument : site.arguments) {
+      size += argument.size;
+    }
+    return size;
+  }
+
+  detail::mapped_file file;
+  std::vector<log_site> sites;
+  std::vector<chunk> chunks;
+};
+
+}
+
+#endif //STRONG_BINARY_LOG_HPP
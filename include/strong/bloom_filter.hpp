@@ -0,0 +1,293 @@
+#ifndef STRONG_BLOOM_FILTER_HPP
+#define STRONG_BLOOM_FILTER_HPP
+
+#include <strong.hpp>
+#include <strong/aligned_allocator.hpp>
+#include <strong/hash.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace strong {
+
+namespace detail {
+
+// The false positive rate of a split-block filter with the given average number of values per
+// block. The number of values in a block is Poisson distributed, and a block holding k values
+// answers a query falsely with probability (1 - (31/32)^k)^8.
+inline double split_block_error(double load) noexcept
+{
+  if(load <= 0) {
+    return 0;
+  }
+
+  // sum over the likely values of k, computing the Poisson terms in log space to avoid underflow
+  auto const spread = 10 * std::sqrt(load) + 20;
+  auto const first = static_cast<unsigned>(std::max(0.0, load - spread));
+  auto const last = static_cast<unsigned>(load + spread);
+
+  double error = 0;
+  for(unsigned k = first; k <= last; ++k) {
+    auto const probability = std::exp(k * std::log(load) - load - std::lgamma(k + 1.0));
+    error += probability * std::pow(1 - std::pow(31.0 / 32, k), 8);
+  }
+  return error;
+}
+
+struct bloom_block {
+  std::uint32_t words[8];
+};
+
+// concurrent insertion sets bits with an atomic or on plain words, which needs a compiler builtin
+// or C++20 std::atomic_ref
+#if defined(__GNUC__) || defined(__clang__) || defined(__cpp_lib_atomic_ref)
+#define STRONG_HAS_ATOMIC_OR 1
+
+inline void atomic_or(std::uint32_t &word, std::uint32_t mask) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __atomic_fetch_or(&word, mask, __ATOMIC_RELAXED);
+#else
+  std::atomic_ref<std::uint32_t>(word).fetch_or(mask, std::memory_order_relaxed);
+#endif
+}
+#endif
+
+}
+
+/**
+ * A split-block Bloom filter for fast negative membership tests of strong values.
+ *
+ * The filter is an array of 256-bit blocks aligned so that no block straddles a cache line. Each
+ * value is hashed to one block and sets one bit in each of the block's eight 32-bit words, so an
+ * insertion or query touches a single cache line. The per-word bit selection is a fixed loop of
+ * eight multiply-and-shift operations that compilers vectorize. False positives are possible;
+ * false negatives are not. Values are hashed with strong::hash.
+ *
+ * @tparam TypeName The strong typedef of the values to test.
+ */
+template<class TypeName>
+class bloom_filter {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Construct a filter sized for an expected number of values and false positive rate.
+   *
+   * @param expected_count The number of values expected to be inserted.
+   * @param false_positive_rate The desired probability that a query for an absent value succeeds.
+   * @throws std::invalid_argument If the false positive rate is not between 0 and 1.
+   */
+  bloom_filter(size_type expected_count, double false_positive_rate)
+  {
+    if(!(false_positive_rate > 0 && false_positive_rate < 1)) {
+      throw std::invalid_argument("strong::bloom_filter: false positive rate must be between 0 and 1");
+    }
+
+    // the fewest blocks whose expected false positive rate meets the target
+    size_type low = 1;
+    size_type high = 1;
+    while(detail::split_block_error(static_cast<double>(expected_count) / high) > false_positive_rate) {
+      low = high + 1;
+      high *= 2;
+    }
+    while(low < high) {
+      auto const middle = low + (high - low) / 2;
+      if(detail::split_block_error(static_cast<double>(expected_count) / middle) > false_positive_rate) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    blocks.resize(high, detail::bloom_block());
+  }
+
+  /**
+   * Add a value to the filter.
+   *
+   * @param value The value to add.
+   */
+  void insert(TypeName const &value) noexcept
+  {
+    insert_hash(detail::hash64(value));
+  }
+
+  /**
+   * Add a range of values to the filter.
+   *
+   * @param first The beginning of the range.
+   * @param last The end of the range.
+   */
+  template<class InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    for_each_batch(first, last, [this](std::uint64_t hash, size_type) { insert_hash(hash); });
+  }
+
+#ifdef STRONG_HAS_ATOMIC_OR
+  /**
+   * Add a value to the filter while other threads may also be inserting.
+   *
+   * Sets bits with atomic or operations. Queries must not run until the inserting threads have
+   * been synchronized with (e.g. joined). Only available with GCC, Clang or C++20 std::atomic_ref.
+   *
+   * @param value The value to add.
+   */
+  void insert_concurrent(TypeName const &value) noexcept
+  {
+    auto const hash = detail::hash64(value);
+    auto &block = blocks[block_of(hash)];
+    std::uint32_t masks[8];
+    make_masks(hash, masks);
+    for(unsigned i = 0; i < 8; ++i) {
+      detail::atomic_or(block.words[i], masks[i]);
+    }
+  }
+#endif
+
+  /**
+   * Test whether a value may have been added.
+   *
+   * @param value The value to test.
+   * @return False if the value was definitely not added, true if it probably was.
+   */
+  bool contains(TypeName const &value) const noexcept
+  {
+    return contains_hash(detail::hash64(value));
+  }
+
+  /**
+   * Test a range of values.
+   *
+   * Values are hashed in batches and the blocks of a whole batch are prefetched before they are
+   * tested, so that the cache misses of a batch overlap.
+   *
+   * @param first The beginning of the range.
+   * @param last The end of the range.
+   * @param results Receives the result of contains for each value.
+   * @return The number of values that may have been added.
+   */
+  template<class InputIt, class OutputIt>
+  size_type contains(InputIt first, InputIt last, OutputIt results) const
+  {
+    size_type found = 0;
+    for_each_batch(first, last, [&](std::uint64_t hash, size_type) {
+      bool const result = contains_hash(hash);
+      *results++ = result;
+      found += result;
+    });
+    return found;
+  }
+
+  /**
+   * Add every value of another filter of the same size to this one.
+   *
+   * @param other The filter to merge.
+   * @throws std::invalid_argument If the filters have different sizes.
+   */
+  void merge(bloom_filter const &other)
+  {
+    if(blocks.size() != other.blocks.size()) {
+      throw std::invalid_argument("strong::bloom_filter: cannot merge filters of different sizes");
+    }
+    for(size_type i = 0; i < blocks.size(); ++i) {
+      for(unsigned j = 0; j < 8; ++j) {
+        blocks[i].words[j] |= other.blocks[i].words[j];
+      }
+    }
+  }
+
+  /**
+   * Remove every value from the filter.
+   */
+  void clear() noexcept
+  {
+    for(auto &block : blocks) {
+      block = detail::bloom_block();
+    }
+  }
+
+  /**
+   * @return The size of the filter in bytes.
+   */
+  size_type size_in_bytes() const noexcept
+  {
+    return blocks.size() * sizeof(detail::bloom_block);
+  }
+
+private:
+  static constexpr size_type batch = 64;
+
+  static void make_masks(std::uint64_t hash, std::uint32_t (&masks)[8]) noexcept
+  {
+    // odd constants from the Parquet split-block Bloom filter specification
+    static constexpr std::uint32_t salt[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                              0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+    auto const key = static_cast<std::uint32_t>(hash);
+    for(unsigned i = 0; i < 8; ++i) {
+      masks[i] = std::uint32_t(1) << ((key * salt[i]) >> 27);
+    }
+  }
+
+  size_type block_of(std::uint64_t hash) const noexcept
+  {
+    // map the upper half of the hash onto the blocks without a division
+    return static_cast<size_type>(((hash >> 32) * blocks.size()) >> 32);
+  }
+
+  void insert_hash(std::uint64_t hash) noexcept
+  {
+    auto &block = blocks[block_of(hash)];
+    std::uint32_t masks[8];
+    make_masks(hash, masks);
+    for(unsigned i = 0; i < 8; ++i) {
+      block.words[i] |= masks[i];
+    }
+  }
+
+  bool contains_hash(std::uint64_t hash) const noexcept
+  {
+    auto const &block = blocks[block_of(hash)];
+    std::uint32_t masks[8];
+    make_masks(hash, masks);
+    std::uint32_t missing = 0;
+    for(unsigned i = 0; i < 8; ++i) {
+      missing |= masks[i] & ~block.words[i];
+    }
+    return missing == 0;
+  }
+
+  template<class InputIt, class Function>
+  void for_each_batch(InputIt first, InputIt last, Function function) const
+  {
+    std::uint64_t hashes[batch];
+    while(first != last) {
+      size_type count = 0;
+      for(; count < batch && first != last; ++count, ++first) {
+        hashes[count] = detail::hash64<TypeName>(*first);
+      }
+#if defined(__GNUC__) || defined(__clang__)
+      for(size_type i = 0; i < count; ++i) {
+        __builtin_prefetch(&blocks[block_of(hashes[i])]);
+      }
+#endif
+      for(size_type i = 0; i < count; ++i) {
+        function(hashes[i], i);
+      }
+    }
+  }
+
+  std::vector<detail::bloom_block, detail::aligned_allocator<detail::bloom_block, 64>> blocks;
+};
+
+template<class TypeName>
+constexpr typename bloom_filter<TypeName>::size_type bloom_filter<TypeName>::batch;
+
+}
+
+#endif //STRONG_BLOOM_FILTER_HPP
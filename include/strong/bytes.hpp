@@ -0,0 +1,38 @@
+#ifndef STRONG_BYTES_HPP
+#define STRONG_BYTES_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace strong {
+
+namespace detail {
+
+// Helpers for the serialized formats, which store values in the byte order of the machine.
+
+template<typename T>
+void append_bytes(std::vector<unsigned char> &buffer, T const &value)
+{
+  auto const bytes = reinterpret_cast<unsigned char const *>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+T read_bytes(unsigned char const *&data, unsigned char const *end, char const *what)
+{
+  if(static_cast<std::size_t>(end - data) < sizeof(T)) {
+    throw std::invalid_argument(what);
+  }
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+  return value;
+}
+
+}
+
+}
+
+#endif //STRONG_BYTES_HPP
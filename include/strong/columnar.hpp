@@ -0,0 +1,1085 @@
+#ifndef STRONG_COLUMNAR_HPP
+#define STRONG_COLUMNAR_HPP
+
+#include <strong.hpp>
+#include <strong/bytes.hpp>
+#include <strong/mapped_file.hpp>
+#include <strong/tag.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace strong {
+
+/**
+ * How the values of a chunk of a column are stored.
+ */
+enum class column_encoding : std::uint8_t {
+  /**
+   * The values as they are in memory. Plain chunks are read without copying.
+   */
+  plain = 0,
+
+  /**
+   * The difference of each value from the smallest value of the chunk, in as few bits as the
+   * largest difference needs. Integral columns only.
+   */
+  bitpack = 1,
+
+  /**
+   * The difference of each value from the previous one, zigzag encoded and bit packed. Suits
+   * sorted or slowly changing values such as timestamps. Integral columns only.
+   */
+  delta = 2,
+
+  /**
+   * A sorted table of the distinct values of the chunk, and the bit packed position of each value
+   * in the table. Suits columns with few distinct values.
+   */
+  dictionary = 3,
+
+  /**
+   * Choose the smallest of the encodings that apply, separately for each chunk.
+   */
+  automatic = 255
+};
+
+namespace detail {
+
+constexpr std::uint64_t columnar_magic = 0x31304c4f43525453ULL; // "STRCOL01"
+constexpr std::uint32_t columnar_byte_order = 0x01020304;
+constexpr std::size_t columnar_header_size = 16;
+constexpr std::size_t columnar_trailer_size = 24;
+
+enum class column_kind : std::uint8_t {
+  signed_integer,
+  unsigned_integer,
+  floating_point
+};
+
+template<typename T>
+constexpr column_kind kind_of() noexcept
+{
+  return std::is_floating_point<T>::value ? column_kind::floating_point
+         : std::is_signed<T>::value ? column_kind::signed_integer : column_kind::unsigned_integer;
+}
+
+template<typename T>
+struct check_column {
+  static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                "columns require a strong typedef with an integral or floating point underlying type");
+};
+
+struct chunk_header {
+  std::uint64_t offset;
+  std::uint64_t bytes;
+  std::uint32_t rows;
+  std::uint32_t dictionary;
+  std::uint8_t encoding;
+  std::uint8_t width;
+  std::uint64_t base;
+  std::uint64_t min;
+  std::uint64_t max;
+};
+
+struct column_header {
+  std::string name;
+  std::string tag;
+  std::uint64_t fingerprint;
+  column_kind kind;
+  std::uint8_t size;
+  std::vector<chunk_header> chunks;
+  std::vector<std::size_t> first_rows;
+};
+
+// values are kept in the chunk headers as their bit patterns
+template<typename T>
+std::uint64_t to_bits(T value) noexcept
+{
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(T));
+  return bits;
+}
+
+template<typename T>
+T from_bits(std::uint64_t bits) noexcept
+{
+  T value;
+  std::memcpy(&value, &bits, sizeof(T));
+  return value;
+}
+
+inline std::size_t pad8(std::size_t bytes) noexcept
+{
+  return (bytes + 7) & ~std::size_t(7);
+}
+
+inline unsigned bit_width(std::uint64_t value) noexcept
+{
+  unsigned width = 0;
+  for(; value != 0; value >>= 1) {
+    ++width;
+  }
+  return width;
+}
+
+inline std::size_t packed_bytes(std::size_t count, unsigned width) noexcept
+{
+  return (count * width + 63) / 64 * 8;
+}
+
+inline void pack_bits(std::uint64_t const *values, std::size_t count, unsigned width, std::vector<unsigned char> &buffer)
+{
+  std::vector<std::uint64_t> words((count * width + 63) / 64, 0);
+  if(width != 0) {
+    for(std::size_t i = 0; i < count; ++i) {
+      auto const bit = i * width;
+      auto const shift = bit % 64;
+      words[bit / 64] |= values[i] << shift;
+      if(shift + width > 64) {
+        words[bit / 64 + 1] |= values[i] >> (64 - shift);
+      }
+    }
+  }
+  auto const bytes = reinterpret_cast<unsigned char const *>(words.data());
+  buffer.insert(buffer.end(), bytes, bytes + words.size() * 8);
+}
+
+inline std::uint64_t unpack_bits(std::uint64_t const *words, std::size_t index, unsigned width) noexcept
+{
+  if(width == 0) {
+    return 0;
+  }
+  auto const bit = index * width;
+  auto const shift = bit % 64;
+  auto value = words[bit / 64] >> shift;
+  if(shift + width > 64) {
+    value |= words[bit / 64 + 1] << (64 - shift);
+  }
+  return width == 64 ? value : value & ((std::uint64_t(1) << width) - 1);
+}
+
+template<typename T>
+using unsigned_of = typename std::make_unsigned<T>::type;
+
+// offsets and deltas wrap around in the unsigned type of the same width, which is exact for any
+// pair of values
+template<typename T>
+std::uint64_t offset_of(T value, T base) noexcept
+{
+  return static_cast<unsigned_of<T>>(static_cast<unsigned_of<T>>(value) - static_cast<unsigned_of<T>>(base));
+}
+
+template<typename T>
+T add_offset(T base, std::uint64_t offset) noexcept
+{
+  return static_cast<T>(static_cast<unsigned_of<T>>(static_cast<unsigned_of<T>>(base) + static_cast<unsigned_of<T>>(offset)));
+}
+
+template<typename T>
+std::uint64_t zigzag(T value, T previous) noexcept
+{
+  using U = unsigned_of<T>;
+  auto const delta = static_cast<U>(offset_of(value, previous));
+  return static_cast<U>(static_cast<U>(delta << 1) ^ static_cast<U>(0 - static_cast<U>(delta >> (sizeof(U) * 8 - 1))));
+}
+
+template<typename T>
+T unzigzag(T previous, std::uint64_t encoded) noexcept
+{
+  using U = unsigned_of<T>;
+  auto const value = static_cast<U>(encoded);
+  return add_offset(previous, static_cast<U>(static_cast<U>(value >> 1) ^ static_cast<U>(0 - static_cast<U>(value & 1))));
+}
+
+template<typename T>
+void append_plain(T const *values, std::size_t count, std::vector<unsigned char> &buffer)
+{
+  auto const bytes = reinterpret_cast<unsigned char const *>(values);
+  buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+  buffer.resize(pad8(buffer.size()), 0);
+}
+
+template<typename T>
+struct chunk_encoder {
+  chunk_encoder(T const *values, std::size_t count) : values(values), count(count)
+  {
+    auto low = std::numeric_limits<T>::max();
+    auto high = std::numeric_limits<T>::lowest();
+    for(std::size_t i = 0; i < count; ++i) {
+      // written so that NaNs are left out of the statistics
+      low = values[i] < low ? values[i] : low;
+      high = values[i] > high ? values[i] : high;
+      unordered |= values[i] != values[i];
+      // 0.0 and -0.0 compare equal, so a dictionary would keep only one of them
+      if(values[i] == T() && !std::is_integral<T>::value) {
+        (std::signbit(static_cast<double>(values[i])) ? negative_zero : positive_zero) = true;
+      }
+    }
+    min = low;
+    max = high;
+
+    if(!applies(column_encoding::dictionary)) {
+      return;
+    }
+    distinct.assign(values, values + count);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+  }
+
+  std::size_t size(column_encoding encoding) const
+  {
+    switch(encoding) {
+    case column_encoding::bitpack:
+      return packed_bytes(count, bitpack_width(std::is_integral<T>()));
+    case column_encoding::delta:
+      return packed_bytes(count, delta_width(std::is_integral<T>()));
+    case column_encoding::dictionary:
+      return pad8(distinct.size() * sizeof(T)) + packed_bytes(count, bit_width(distinct.size() - 1));
+    default:
+      return pad8(count * sizeof(T));
+    }
+  }
+
+  bool applies(column_encoding encoding) const noexcept
+  {
+    // NaNs cannot be sorted into a dictionary, and zeros of both signs would collapse into one
+    return encoding == column_encoding::plain || std::is_integral<T>::value
+           || (encoding == column_encoding::dictionary && !unordered && !(negative_zero && positive_zero));
+  }
+
+  column_encoding choose() const
+  {
+    auto best = column_encoding::plain;
+    for(auto encoding : {column_encoding::bitpack, column_encoding::delta, column_encoding::dictionary}) {
+      if(applies(encoding) && size(encoding) < size(best)) {
+        best = encoding;
+      }
+    }
+    return best;
+  }
+
+  void encode(column_encoding encoding, chunk_header &header, std::vector<unsigned char> &buffer) const
+  {
+    if(!applies(encoding)) {
+      encoding = column_encoding::plain;
+    }
+    header.rows = static_cast<std::uint32_t>(count);
+    header.dictionary = 0;
+    header.encoding = static_cast<std::uint8_t>(encoding);
+    header.width = 0;
+    header.base = 0;
+    header.min = to_bits(min);
+    header.max = to_bits(max);
+
+    std::vector<std::uint64_t> codes(count);
+    switch(encoding) {
+    case column_encoding::bitpack:
+      encode_bitpack(header, codes, std::is_integral<T>());
+      break;
+    case column_encoding::delta:
+      encode_delta(header, codes, std::is_integral<T>());
+      break;
+    case column_encoding::dictionary:
+      append_plain(distinct.data(), distinct.size(), buffer);
+      header.dictionary = static_cast<std::uint32_t>(distinct.size());
+      header.width = static_cast<std::uint8_t>(bit_width(distinct.size() - 1));
+      for(std::size_t i = 0; i < count; ++i) {
+        codes[i] = static_cast<std::uint64_t>(std::lower_bound(distinct.begin(), distinct.end(), values[i]) - distinct.begin());
+      }
+      break;
+    default:
+      append_plain(values, count, buffer);
+      return;
+    }
+    pack_bits(codes.data(), count, header.width, buffer);
+  }
+
+  unsigned bitpack_width(std::true_type) const noexcept
+  {
+    return bit_width(offset_of(max, min));
+  }
+
+  unsigned delta_width(std::true_type) const noexcept
+  {
+    std::uint64_t widest = 0;
+    for(std::size_t i = 1; i < count; ++i) {
+      widest |= zigzag(values[i], values[i - 1]);
+    }
+    return bit_width(widest);
+  }
+
+  void encode_bitpack(chunk_header &header, std::vector<std::uint64_t> &codes, std::true_type) const noexcept
+  {
+    header.base = to_bits(min);
+    header.width = static_cast<std::uint8_t>(bitpack_width(std::true_type()));
+    for(std::size_t i = 0; i < count; ++i) {
+      codes[i] = offset_of(values[i], min);
+    }
+  }
+
+  void encode_delta(chunk_header &header, std::vector<std::uint64_t> &codes, std::true_type) const noexcept
+  {
+    header.base = to_bits(values[0]);
+    header.width = static_cast<std::uint8_t>(delta_width(std::true_type()));
+    codes[0] = 0;
+    for(std::size_t i = 1; i < count; ++i) {
+      codes[i] = zigzag(values[i], values[i - 1]);
+    }
+  }
+
+  // never chosen for floating point columns, see applies
+  unsigned bitpack_width(std::false_type) const noexcept
+  {
+    return 64;
+  }
+
+  unsigned delta_width(std::false_type) const noexcept
+  {
+    return 64;
+  }
+
+  void encode_bitpack(chunk_header &, std::vector<std::uint64_t> &, std::false_type) const noexcept
+  {
+  }
+
+  void encode_delta(chunk_header &, std::vector<std::uint64_t> &, std::false_type) const noexcept
+  {
+  }
+
+  T const *values;
+  std::size_t count;
+  T min;
+  T max;
+  bool unordered = false;
+  bool negative_zero = false;
+  bool positive_zero = false;
+  std::vector<T> distinct;
+};
+
+template<typename T>
+T decode_bitpack(chunk_header const &header, std::uint64_t const *words, std::size_t index, std::true_type) noexcept
+{
+  return add_offset(from_bits<T>(header.base), unpack_bits(words, index, header.width));
+}
+
+template<typename T>
+std::uint64_t encode_bitpack(T value, T min, std::true_type) noexcept
+{
+  return offset_of(value, min);
+}
+
+template<typename T>
+void decode_delta(chunk_header const &header, std::uint64_t const *words, T *output, std::true_type) noexcept
+{
+  auto value = from_bits<T>(header.base);
+  for(std::size_t i = 0; i < header.rows; ++i) {
+    value = unzigzag(value, unpack_bits(words, i, header.width));
+    output[i] = value;
+  }
+}
+
+template<typename T>
+T decode_bitpack(chunk_header const &, std::uint64_t const *, std::size_t, std::false_type) noexcept
+{
+  return T();
+}
+
+template<typename T>
+std::uint64_t encode_bitpack(T, T, std::false_type) noexcept
+{
+  return 0;
+}
+
+template<typename T>
+void decode_delta(chunk_header const &, std::uint64_t const *, T *, std::false_type) noexcept
+{
+}
+
+struct table_state {
+  explicit table_state(std::string const &path) : file(path, "strong::table_reader")
+  {
+  }
+
+  mapped_file file;
+  std::size_t rows = 0;
+  std::vector<column_header> columns;
+};
+
+}
+
+/**
+ * Writes a table of strong-typed columns to a file.
+ *
+ * Every column holds one strong typedef and is identified in the file by a name and by the tag
+ * fingerprint of its type, so that it can only be read back as the same type. Columns are split
+ * into chunks of a fixed number of rows. Each chunk is encoded on its own, and its smallest and
+ * largest values are recorded so that readers can skip chunks that cannot match a predicate.
+ * Chunks start at 8-byte boundaries so that plain chunks can be used in place once mapped.
+ *
+ * Values are stored in the byte order of the writing machine, and readers reject files written
+ * with a different byte order.
+ */
+class table_writer {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Create or truncate a table file.
+   *
+   * @param path The path of the file.
+   * @param chunk_rows The number of rows in each chunk.
+   * @throws std::invalid_argument If chunk_rows is zero or does not fit in 32 bits.
+   * @throws std::runtime_error If the file cannot be opened.
+   */
+  explicit table_writer(std::string const &path, size_type chunk_rows = 65536)
+    : file(path, std::ios::binary | std::ios::trunc), chunk_rows(chunk_rows)
+  {
+    if(chunk_rows == 0 || chunk_rows > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::invalid_argument("strong::table_writer: chunk_rows must be between 1 and 2^32 - 1");
+    }
+    if(!file) {
+      throw std::runtime_error("strong::table_writer: cannot open " + path);
+    }
+
+    std::vector<unsigned char> header;
+    detail::append_bytes(header, detail::columnar_magic);
+    detail::append_bytes(header, detail::columnar_byte_order);
+    detail::append_bytes(header, std::uint32_t(0));
+    write(header);
+  }
+
+  table_writer(table_writer const &) = delete;
+  table_writer & operator=(table_writer const &) = delete;
+
+  /**
+   * Finish the file if close has not been called. Errors are ignored; call close to observe them.
+   */
+  ~table_writer()
+  {
+    if(file.is_open()) {
+      try {
+        close();
+      } catch(...) {
+      }
+    }
+  }
+
+  /**
+   * Encode and write a column.
+   *
+   * @param name The name of the column.
+   * @param values The values of the column.
+   * @param count The number of values, which must match the columns already written.
+   * @param encoding The encoding of the chunks. Floating point chunks holding NaNs, or both 0.0 and
+   *                 -0.0, are stored plain.
+   * @throws std::invalid_argument If the name is taken, the number of rows differs from earlier
+   *                               columns, or the encoding does not apply to the column's type.
+   * @throws std::runtime_error If the file cannot be written.
+   */
+  template<class TypeName>
+  void add_column(std::string const &name, TypeName const *values, size_type count,
+                  column_encoding encoding = column_encoding::automatic)
+  {
+    using T = typename underlying_type<TypeName>::type;
+    detail::check_column<T>();
+
+    for(auto const &column : columns) {
+      if(column.name == name) {
+        throw std::invalid_argument("strong::table_writer: duplicate column " + name);
+      }
+    }
+    if(!columns.empty() && count != rows) {
+      throw std::invalid_argument("strong::table_writer: columns must have the same number of rows");
+    }
+    if(!std::is_integral<T>::value && (encoding == column_encoding::bitpack || encoding == column_encoding::delta)) {
+      throw std::invalid_argument("strong::table_writer: bitpack and delta encodings require an integral column");
+    }
+
+    detail::column_header column;
+    column.name = name;
+    column.tag = tag_name<TypeName>();
+    column.fingerprint = tag_fingerprint<TypeName>();
+    column.kind = detail::kind_of<T>();
+    column.size = sizeof(T);
+
+    std::vector<T> raw;
+    std::vector<unsigned char> buffer;
+    for(size_type first = 0; first < count; first += chunk_rows) {
+      auto const size = std::min(chunk_rows, count - first);
+      raw.resize(size);
+      for(size_type i = 0; i < size; ++i) {
+        raw[i] = get(values[first + i]);
+      }
+
+      detail::chunk_encoder<T> const encoder(raw.data(), size);
+      detail::chunk_header chunk;
+      buffer.clear();
+      encoder.encode(encoding == column_encoding::automatic ? encoder.choose() : encoding, chunk, buffer);
+      chunk.offset = position;
+      chunk.bytes = buffer.size();
+      write(buffer);
+      column.chunks.push_back(chunk);
+    }
+
+    rows = count;
+    columns.push_back(std::move(column));
+  }
+
+  /**
+   * Encode and write a column.
+   *
+   * @param name The name of the column.
+   * @param values The values of the column.
+   * @param encoding The encoding of the chunks.
+   * @see add_column
+   */
+  template<class TypeName, class Allocator>
+  void add_column(std::string const &name, std::vector<TypeName, Allocator> const &values,
+                  column_encoding encoding = column_encoding::automatic)
+  {
+    add_column(name, values.data(), values.size(), encoding);
+  }
+
+  /**
+   * Write the directory of columns and close the file.
+   *
+   * @throws std::runtime_error If the file cannot be written.
+   */
+  void close()
+  {
+    std::vector<unsigned char> footer;
+    detail::append_bytes(footer, static_cast<std::uint64_t>(rows));
+    detail::append_bytes(footer, static_cast<std::uint32_t>(columns.size()));
+    for(auto const &column : columns) {
+      append_string(footer, column.name);
+      append_string(footer, column.tag);
+      detail::append_bytes(footer, column.fingerprint);
+      detail::append_bytes(footer, static_cast<std::uint8_t>(column.kind));
+      detail::append_bytes(footer, column.size);
+      detail::append_bytes(footer, static_cast<std::uint32_t>(column.chunks.size()));
+      for(auto const &chunk : column.chunks) {
+        detail::append_bytes(footer, chunk.offset);
+        detail::append_bytes(footer, chunk.bytes);
+        detail::append_bytes(footer, chunk.rows);
+        detail::append_bytes(footer, chunk.dictionary);
+        detail::append_bytes(footer, chunk.encoding);
+        detail::append_bytes(footer, chunk.width);
+        detail::append_bytes(footer, chunk.base);
+        detail::append_bytes(footer, chunk.min);
+        detail::append_bytes(footer, chunk.max);
+      }
+    }
+
+    auto const footer_offset = position;
+    detail::append_bytes(footer, footer_offset);
+    detail::append_bytes(footer, static_cast<std::uint64_t>(footer.size() - sizeof(footer_offset)));
+    detail::append_bytes(footer, detail::columnar_magic);
+    write(footer);
+
+    file.close();
+    if(!file) {
+      throw std::runtime_error("strong::table_writer: cannot write the table");
+    }
+  }
+
+private:
+  static void append_string(std::vector<unsigned char> &buffer, std::string const &value)
+  {
+    detail::append_bytes(buffer, static_cast<std::uint32_t>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+  }
+
+  void write(std::vector<unsigned char> const &buffer)
+  {
+    file.write(reinterpret_cast<char const *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    if(!file) {
+      throw std::runtime_error("strong::table_writer: cannot write the table");
+    }
+    position += buffer.size();
+  }
+
+  std::ofstream file;
+  size_type chunk_rows;
+  size_type rows = 0;
+  std::uint64_t position = 0;
+  std::vector<detail::column_header> columns;
+};
+
+/**
+ * A column of a table file, read as a strong typedef.
+ *
+ * Plain chunks are accessed in place in the mapped file; other chunks are decoded on demand. The
+ * column keeps the file mapped for as long as it exists.
+ *
+ * @tparam TypeName The strong typedef of the column.
+ */
+template<class TypeName>
+class column_reader {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * @return The number of rows in the column.
+   */
+  size_type size() const noexcept
+  {
+    return table->rows;
+  }
+
+  /**
+   * @return The number of chunks in the column.
+   */
+  size_type chunks() const noexcept
+  {
+    return column().chunks.size();
+  }
+
+  /**
+   * @param chunk The index of a chunk.
+   * @return The index of the first row of the chunk.
+   */
+  size_type chunk_first_row(size_type chunk) const
+  {
+    return column().first_rows.at(chunk);
+  }
+
+  /**
+   * @param chunk The index of a chunk.
+   * @return The number of rows in the chunk.
+   */
+  size_type chunk_rows(size_type chunk) const
+  {
+    return column().chunks.at(chunk).rows;
+  }
+
+  /**
+   * @param chunk The index of a chunk.
+   * @return The smallest value in the chunk, ignoring NaNs.
+   */
+  TypeName chunk_min(size_type chunk) const
+  {
+    return TypeName(detail::from_bits<T>(column().chunks.at(chunk).min));
+  }
+
+  /**
+   * @param chunk The index of a chunk.
+   * @return The largest value in the chunk, ignoring NaNs.
+   */
+  TypeName chunk_max(size_type chunk) const
+  {
+    return TypeName(detail::from_bits<T>(column().chunks.at(chunk).max));
+  }
+
+  /**
+   * @param chunk The index of a chunk.
+   * @return The encoding of the chunk.
+   */
+  column_encoding chunk_encoding(size_type chunk) const
+  {
+    return static_cast<column_encoding>(column().chunks.at(chunk).encoding);
+  }
+
+  /**
+   * Access the values of a plain chunk in place, without copying.
+   *
+   * @param chunk The index of a chunk.
+   * @return The values of the chunk, or nullptr if the chunk is not plain.
+   */
+  TypeName const * data(size_type chunk) const
+  {
+    static_assert(sizeof(TypeName) == sizeof(T) && std::is_standard_layout<TypeName>::value,
+                  "in-place access requires a strong typedef with the layout of its underlying type");
+    auto const &header = column().chunks.at(chunk);
+    if(header.encoding != static_cast<std::uint8_t>(column_encoding::plain)) {
+      return nullptr;
+    }
+    return reinterpret_cast<TypeName const *>(bytes(header));
+  }
+
+  /**
+   * Decode the values of a chunk.
+   *
+   * @param chunk The index of a chunk.
+   * @param output Receives chunk_rows(chunk) values.
+   * @throws std::invalid_argument If the chunk holds a dictionary code past its dictionary.
+   */
+  void decode(size_type chunk, TypeName *output) const
+  {
+    auto const &header = column().chunks.at(chunk);
+    std::vector<T> values(header.rows);
+    decode(header, values.data());
+    for(size_type i = 0; i < values.size(); ++i) {
+      output[i] = TypeName(values[i]);
+    }
+  }
+
+  /**
+   * @return Every value of the column.
+   * @throws std::invalid_argument If a chunk holds a dictionary code past its dictionary.
+   */
+  std::vector<TypeName> read() const
+  {
+    std::vector<TypeName> values(size());
+    for(size_type chunk = 0; chunk < chunks(); ++chunk) {
+      decode(chunk, values.data() + chunk_first_row(chunk));
+    }
+    return values;
+  }
+
+  /**
+   * Visit the rows whose value lies in a closed range.
+   *
+   * Chunks whose statistics do not overlap the range are skipped without being read. Within bit
+   * packed and dictionary chunks the range is translated into the encoded domain, so that values
+   * are compared without being decoded. Values are compared through their underlying type.
+   *
+   * @param low The smallest value to visit.
+   * @param high The largest value to visit.
+   * @param function Called with the row index and value of every match, in row order.
+   * @return The number of matches.
+   */
+  template<class Function>
+  size_type scan(TypeName const &low, TypeName const &high, Function function) const
+  {
+    auto const lower = get(low);
+    auto const upper = get(high);
+    size_type matches = 0;
+    std::vector<T> values;
+
+    for(size_type chunk = 0; chunk < chunks(); ++chunk) {
+      auto const &header = column().chunks[chunk];
+      auto const min = detail::from_bits<T>(header.min);
+      auto const max = detail::from_bits<T>(header.max);
+      if(max < lower || upper < min || upper < lower) {
+        continue;
+      }
+
+      auto const first = column().first_rows[chunk];
+      auto const encoding = static_cast<column_encoding>(header.encoding);
+      auto const data = bytes(header);
+      if(encoding == column_encoding::plain) {
+        auto const plain = reinterpret_cast<T const *>(data);
+        for(size_type i = 0; i < header.rows; ++i) {
+          if(lower <= plain[i] && plain[i] <= upper) {
+            function(first + i, TypeName(plain[i]));
+            ++matches;
+          }
+        }
+      } else if(encoding == column_encoding::dictionary) {
+        // the dictionary is sorted, so the matching values form a range of positions
+        auto const dictionary = reinterpret_cast<T const *>(data);
+        auto const words = reinterpret_cast<std::uint64_t const *>(data + detail::pad8(header.dictionary * sizeof(T)));
+        auto const begin = static_cast<std::uint64_t>(std::lower_bound(dictionary, dictionary + header.dictionary, lower) - dictionary);
+        auto const end = static_cast<std::uint64_t>(std::upper_bound(dictionary, dictionary + header.dictionary, upper) - dictionary);
+        for(size_type i = 0; i < header.rows; ++i) {
+          auto const code = detail::unpack_bits(words, i, header.width);
+          if(code >= begin && code < end) {
+            function(first + i, TypeName(dictionary[code]));
+            ++matches;
+          }
+        }
+      } else if(encoding == column_encoding::bitpack) {
+        // the chunk overlaps the range, so the clamped bounds are offsets from the chunk minimum
+        auto const words = reinterpret_cast<std::uint64_t const *>(data);
+        auto const begin = detail::encode_bitpack(lower < min ? min : lower, min, std::is_integral<T>());
+        auto const end = detail::encode_bitpack(max < upper ? max : upper, min, std::is_integral<T>());
+        for(size_type i = 0; i < header.rows; ++i) {
+          auto const code = detail::unpack_bits(words, i, header.width);
+          if(code >= begin && code <= end) {
+            function(first + i, TypeName(detail::decode_bitpack<T>(header, words, i, std::is_integral<T>())));
+            ++matches;
+          }
+        }
+      } else {
+        values.resize(header.rows);
+        decode(header, values.data());
+        for(size_type i = 0; i < header.rows; ++i) {
+          if(lower <= values[i] && values[i] <= upper) {
+            function(first + i, TypeName(values[i]));
+            ++matches;
+          }
+        }
+      }
+    }
+    return matches;
+  }
+
+  /**
+   * Find the rows whose value lies in a closed range.
+   *
+   * @param low The smallest value to find.
+   * @param high The largest value to find.
+   * @return The indices of the matching rows, in increasing order.
+   * @see scan
+   */
+  std::vector<size_type> rows_between(TypeName const &low, TypeName const &high) const
+  {
+    std::vector<size_type> rows;
+    scan(low, high, [&rows](size_type row, TypeName const &) { rows.push_back(row); });
+    return rows;
+  }
+
+private:
+  using T = typename underlying_type<TypeName>::type;
+
+  friend class table_reader;
+
+  column_reader(std::shared_ptr<detail::table_state const> table, std::size_t index)
+    : table(std::move(table)), index(index)
+  {
+  }
+
+  detail::column_header const & column() const noexcept
+  {
+    return table->columns[index];
+  }
+
+  unsigned char const * bytes(detail::chunk_header const &header) const noexcept
+  {
+    return table->file.data() + header.offset;
+  }
+
+  void decode(detail::chunk_header const &header, T *output) const
+  {
+    auto const data = bytes(header);
+    switch(static_cast<column_encoding>(header.encoding)) {
+    case column_encoding::plain:
+      std::memcpy(output, data, header.rows * sizeof(T));
+      break;
+    case column_encoding::bitpack:
+      for(size_type i = 0; i < header.rows; ++i) {
+        output[i] = detail::decode_bitpack<T>(header, reinterpret_cast<std::uint64_t const *>(data), i,
+                                              std::is_integral<T>());
+      }
+      break;
+    case column_encoding::delta:
+      detail::decode_delta(header, reinterpret_cast<std::uint64_t const *>(data), output, std::is_integral<T>());
+      break;
+    default: {
+      auto const dictionary = reinterpret_cast<T const *>(data);
+      auto const words = reinterpret_cast<std::uint64_t const *>(data + detail::pad8(header.dictionary * sizeof(T)));
+      for(size_type i = 0; i < header.rows; ++i) {
+        auto const code = detail::unpack_bits(words, i, header.width);
+        if(code >= header.dictionary) {
+          throw std::invalid_argument("strong::table_reader: dictionary code out of range");
+        }
+        output[i] = dictionary[code];
+      }
+      break;
+    }
+    }
+  }
+
+  std::shared_ptr<detail::table_state const> table;
+  std::size_t index;
+};
+
+/**
+ * Reads a table file written by table_writer.
+ *
+ * The file is mapped into memory (or read whole on platforms without mmap) and only its directory
+ * is parsed up front; column data is touched when it is accessed.
+ */
+class table_reader {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Open a table file.
+   *
+   * @param path The path of the file.
+   * @throws std::runtime_error If the file cannot be opened or mapped.
+   * @throws std::invalid_argument If the file is not a table written on a machine with the same
+   *                               byte order.
+   */
+  explicit table_reader(std::string const &path) : table(std::make_shared<detail::table_state>(path))
+  {
+    auto const what = "strong::table_reader: not a valid table file";
+    auto const file = table->file.data();
+    auto const size = table->file.size();
+    if(size < detail::columnar_header_size + detail::columnar_trailer_size) {
+      throw std::invalid_argument(what);
+    }
+
+    auto header = file;
+    if(detail::read_bytes<std::uint64_t>(header, file + size, what) != detail::columnar_magic
+       || detail::read_bytes<std::uint32_t>(header, file + size, what) != detail::columnar_byte_order) {
+      throw std::invalid_argument(what);
+    }
+
+    auto trailer = file + size - detail::columnar_trailer_size;
+    auto const footer_offset = detail::read_bytes<std::uint64_t>(trailer, file + size, what);
+    auto const footer_size = detail::read_bytes<std::uint64_t>(trailer, file + size, what);
+    if(detail::read_bytes<std::uint64_t>(trailer, file + size, what) != detail::columnar_magic
+       || footer_offset > size - detail::columnar_trailer_size
+       || footer_size != size - detail::columnar_trailer_size - footer_offset) {
+      throw std::invalid_argument(what);
+    }
+
+    auto footer = file + footer_offset;
+    auto const end = footer + footer_size;
+    table->rows = static_cast<size_type>(detail::read_bytes<std::uint64_t>(footer, end, what));
+    auto const count = detail::read_bytes<std::uint32_t>(footer, end, what);
+    for(std::uint32_t i = 0; i < count; ++i) {
+      detail::column_header column;
+      column.name = read_string(footer, end, what);
+      column.tag = read_string(footer, end, what);
+      column.fingerprint = detail::read_bytes<std::uint64_t>(footer, end, what);
+      column.kind = static_cast<detail::column_kind>(detail::read_bytes<std::uint8_t>(footer, end, what));
+      column.size = detail::read_bytes<std::uint8_t>(footer, end, what);
+
+      size_type rows = 0;
+      auto const chunks = detail::read_bytes<std::uint32_t>(footer, end, what);
+      for(std::uint32_t j = 0; j < chunks; ++j) {
+        detail::chunk_header chunk;
+        chunk.offset = detail::read_bytes<std::uint64_t>(footer, end, what);
+        chunk.bytes = detail::read_bytes<std::uint64_t>(footer, end, what);
+        chunk.rows = detail::read_bytes<std::uint32_t>(footer, end, what);
+        chunk.dictionary = detail::read_bytes<std::uint32_t>(footer, end, what);
+        chunk.encoding = detail::read_bytes<std::uint8_t>(footer, end, what);
+        chunk.width = detail::read_bytes<std::uint8_t>(footer, end, what);
+        chunk.base = detail::read_bytes<std::uint64_t>(footer, end, what);
+        chunk.min = detail::read_bytes<std::uint64_t>(footer, end, what);
+        chunk.max = detail::read_bytes<std::uint64_t>(footer, end, what);
+        if(chunk.offset % 8 != 0 || chunk.offset > footer_offset || chunk.bytes > footer_offset - chunk.offset
+           || chunk.bytes < expected_bytes(chunk, column.size) || chunk.width > 64) {
+          throw std::invalid_argument(what);
+        }
+        column.first_rows.push_back(rows);
+        column.chunks.push_back(chunk);
+        rows += chunk.rows;
+      }
+      if(rows != table->rows) {
+        throw std::invalid_argument(what);
+      }
+      table->columns.push_back(std::move(column));
+    }
+  }
+
+  /**
+   * @return The number of rows in the table.
+   */
+  size_type rows() const noexcept
+  {
+    return table->rows;
+  }
+
+  /**
+   * @return The number of columns in the table.
+   */
+  size_type columns() const noexcept
+  {
+    return table->columns.size();
+  }
+
+  /**
+   * @param column The index of a column.
+   * @return The name of the column.
+   * @throws std::out_of_range If there is no such column.
+   */
+  std::string const & name(size_type column) const
+  {
+    return table->columns.at(column).name;
+  }
+
+  /**
+   * @param column The index of a column.
+   * @return The tag name of the strong typedef stored in the column.
+   * @throws std::out_of_range If there is no such column.
+   */
+  std::string const & tag(size_type column) const
+  {
+    return table->columns.at(column).tag;
+  }
+
+  /**
+   * @param name The name of a column.
+   * @return Whether the table has a column with that name.
+   */
+  bool contains(std::string const &name) const noexcept
+  {
+    return find(name) != columns();
+  }
+
+  /**
+   * Access a column as a strong typedef.
+   *
+   * @tparam TypeName The strong typedef the column was written as.
+   * @param name The name of the column.
+   * @return The column.
+   * @throws std::out_of_range If there is no such column.
+   * @throws std::invalid_argument If the column was written as a different type.
+   */
+  template<class TypeName>
+  column_reader<TypeName> column(std::string const &name) const
+  {
+    using T = typename underlying_type<TypeName>::type;
+    detail::check_column<T>();
+
+    auto const index = find(name);
+    if(index == columns()) {
+      throw std::out_of_range("strong::table_reader: no column " + name);
+    }
+    auto const &column = table->columns[index];
+    if(column.fingerprint != tag_fingerprint<TypeName>() || column.kind != detail::kind_of<T>()
+       || column.size != sizeof(T)) {
+      throw std::invalid_argument("strong::table_reader: column " + name + " holds " + column.tag + ", not "
+                                  + tag_name<TypeName>());
+    }
+    return column_reader<TypeName>(table, index);
+  }
+
+private:
+  static std::string read_string(unsigned char const *&data, unsigned char const *end, char const *what)
+  {
+    auto const size = detail::read_bytes<std::uint32_t>(data, end, what);
+    if(static_cast<std::size_t>(end - data) < size) {
+      throw std::invalid_argument(what);
+    }
+    std::string value(reinterpret_cast<char const *>(data), size);
+    data += size;
+    return value;
+  }
+
+  static std::uint64_t expected_bytes(detail::chunk_header const &chunk, std::size_t size) noexcept
+  {
+    switch(static_cast<column_encoding>(chunk.encoding)) {
+    case column_encoding::plain:
+      return detail::pad8(chunk.rows * size);
+    case column_encoding::bitpack:
+    case column_encoding::delta:
+      return detail::packed_bytes(chunk.rows, chunk.width);
+    case column_encoding::dictionary:
+      return detail::pad8(chunk.dictionary * size) + detail::packed_bytes(chunk.rows, chunk.width);
+    default:
+      return std::numeric_limits<std::uint64_t>::max();
+    }
+  }
+
+  size_type find(std::string const &name) const noexcept
+  {
+    size_type index = 0;
+    while(index < columns() && table->columns[index].name != name) {
+      ++index;
+    }
+    return index;
+  }
+
+  std::shared_ptr<detail::table_state> table;
+};
+
+}
+
+#endif //STRONG_COLUMNAR_HPP
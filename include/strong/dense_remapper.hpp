@@ -0,0 +1,465 @@
+#ifndef STRONG_DENSE_REMAPPER_HPP
+#define STRONG_DENSE_REMAPPER_HPP
+
+#include <strong.hpp>
+#include <strong/hash.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace strong {
+
+namespace detail {
+
+struct remapper_header {
+  std::uint64_t magic;
+  std::uint64_t count;
+  std::uint64_t capacity;
+  std::uint32_t external_size;
+  std::uint32_t dense_size;
+};
+
+constexpr std::uint64_t remapper_magic = 0x3170616d65726473ULL; // "sdremap1"
+
+inline std::size_t align_up(std::size_t offset) noexcept
+{
+  return (offset + 7) & ~static_cast<std::size_t>(7);
+}
+
+template<class TypeName>
+struct less_underlying {
+  bool operator()(TypeName const &lhs, TypeName const &rhs) const noexcept
+  {
+    return get(lhs) < get(rhs);
+  }
+};
+
+template<class TypeName>
+bool equal_underlying(TypeName const &lhs, TypeName const &rhs) noexcept
+{
+  return get(lhs) == get(rhs);
+}
+
+template<typename T, class Allocator, class Compare>
+void parallel_sort(std::vector<T, Allocator> &values, unsigned threads, Compare compare)
+{
+  auto const count = values.size();
+  if(threads <= 1 || count < 65536) {
+    std::sort(values.begin(), values.end(), compare);
+    return;
+  }
+
+  // sort equal-sized chunks concurrently, then merge neighbouring pairs of chunks until one remains
+  std::vector<std::size_t> bounds;
+  for(unsigned i = 0; i <= threads; ++i) {
+    bounds.push_back(count * i / threads);
+  }
+
+  auto const begin = values.begin();
+  auto const at = [&](std::size_t position) { return begin + static_cast<std::ptrdiff_t>(position); };
+
+  std::vector<std::thread> workers;
+  for(unsigned i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i] { std::sort(at(bounds[i]), at(bounds[i + 1]), compare); });
+  }
+  for(auto &worker : workers) {
+    worker.join();
+  }
+
+  while(bounds.size() > 2) {
+    std::vector<std::size_t> merged;
+    workers.clear();
+    for(std::size_t i = 0; i + 2 < bounds.size(); i += 2) {
+      workers.emplace_back([&, i] {
+        std::inplace_merge(at(bounds[i]), at(bounds[i + 1]), at(bounds[i + 2]), compare);
+      });
+      merged.push_back(bounds[i]);
+    }
+    if(bounds.size() % 2 == 0) {
+      merged.push_back(bounds[bounds.size() - 2]);
+    }
+    merged.push_back(bounds.back());
+
+    for(auto &worker : workers) {
+      worker.join();
+    }
+    bounds.swap(merged);
+  }
+}
+
+template<class ExternalId, class DenseId>
+class remapper_lookup {
+public:
+  static constexpr typename underlying_type<DenseId>::type empty =
+    std::numeric_limits<typename underlying_type<DenseId>::type>::max();
+
+  static DenseId find(ExternalId const &id, ExternalId const *externals, DenseId const *slots,
+                      std::size_t capacity) noexcept
+  {
+    if(capacity == 0) {
+      return DenseId(empty);
+    }
+
+    auto const mask = capacity - 1;
+    for(auto slot = hash<ExternalId>()(id) & mask;; slot = (slot + 1) & mask) {
+      auto const dense = get(slots[slot]);
+      if(dense == empty || equal_underlying(externals[static_cast<std::size_t>(dense)], id)) {
+        return slots[slot];
+      }
+    }
+  }
+};
+
+template<class ExternalId, class DenseId>
+constexpr typename underlying_type<DenseId>::type remapper_lookup<ExternalId, DenseId>::empty;
+
+}
+
+/**
+ * A bidirectional mapping between sparse external IDs and dense, compact IDs.
+ *
+ * Upstream data often identifies elements with large, sparse IDs (e.g. 64-bit identifiers from
+ * another system), while arrays are best indexed by dense IDs numbered from zero. The remapper
+ * assigns each distinct external ID a dense ID in increasing order of the external ID, so the
+ * mapping is deterministic regardless of the input order or the number of threads.
+ *
+ * The reverse direction (dense to external) is an array lookup. The forward direction (external
+ * to dense) uses an open-addressing hash table that stores only dense IDs, so with a 32-bit
+ * DenseId the table costs at most 8 bytes per ID. Both arrays are plain data and can be written
+ * out with serialize and reloaded without rebuilding through dense_remapper_view.
+ *
+ * @tparam ExternalId A strong typedef with an integral underlying type for the external IDs.
+ * @tparam DenseId A strong typedef with an unsigned underlying type for the dense IDs.
+ * @tparam Allocator The allocator of the external IDs, rebound for the hash table.
+ */
+template<class ExternalId, class DenseId, class Allocator = std::allocator<ExternalId>>
+class dense_remapper {
+public:
+  using size_type = std::size_t;
+  using allocator_type = Allocator;
+
+  static_assert(std::is_integral<typename underlying_type<ExternalId>::type>::value,
+                "dense_remapper requires an external ID with an integral underlying type");
+  static_assert(std::is_unsigned<typename underlying_type<DenseId>::type>::value,
+                "dense_remapper requires a dense ID with an unsigned underlying type");
+  static_assert(std::is_trivially_copyable<ExternalId>::value && std::is_trivially_copyable<DenseId>::value,
+                "dense_remapper requires trivially copyable IDs");
+
+  /**
+   * Construct an empty mapping.
+   */
+  dense_remapper() = default;
+
+  /**
+   * Construct an empty mapping that uses the given allocator.
+   *
+   * @param allocator The allocator to use.
+   */
+  explicit dense_remapper(Allocator const &allocator) : externals(allocator), slots(slot_allocator(allocator))
+  {
+  }
+
+  /**
+   * Build the mapping from a range of external IDs, which may contain duplicates.
+   *
+   * The IDs are sorted in parallel and then deduplicated before the hash table is filled.
+   *
+   * @param first The beginning of the range of external IDs.
+   * @param last The end of the range of external IDs.
+   * @param threads The number of threads to sort with, or 0 to use every hardware thread.
+   * @param allocator The allocator to use.
+   * @throws std::length_error If there are more distinct IDs than DenseId can represent.
+   */
+  template<class InputIt>
+  dense_remapper(InputIt first, InputIt last, unsigned threads = 0, Allocator const &allocator = Allocator())
+    : externals(first, last, allocator), slots(slot_allocator(allocator))
+  {
+    if(threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    detail::parallel_sort(externals, threads, detail::less_underlying<ExternalId>());
+    externals.erase(std::unique(externals.begin(), externals.end(), detail::equal_underlying<ExternalId>),
+                    externals.end());
+    externals.shrink_to_fit();
+
+    if(externals.size() >= static_cast<size_type>(lookup::empty)) {
+      throw std::length_error("strong::dense_remapper: too many IDs for the dense ID type");
+    }
+
+    // keep the load factor at or below one half so that probe sequences stay short
+    size_type capacity = 1;
+    while(capacity < 2 * externals.size()) {
+      capacity *= 2;
+    }
+    slots.assign(externals.size() == 0 ? 0 : capacity, DenseId(lookup::empty));
+
+    auto const mask = capacity - 1;
+    for(size_type i = 0; i < externals.size(); ++i) {
+      auto slot = hash<ExternalId>()(externals[i]) & mask;
+      while(get(slots[slot]) != lookup::empty) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot] = DenseId(static_cast<typename underlying_type<DenseId>::type>(i));
+    }
+  }
+
+  /**
+   * Look up the dense ID of an external ID.
+   *
+   * @param id The external ID.
+   * @return The dense ID, or the largest DenseId value if the external ID is not mapped.
+   */
+  DenseId find(ExternalId const &id) const noexcept
+  {
+    return lookup::find(id, externals.data(), slots.data(), slots.size());
+  }
+
+  /**
+   * Look up the dense ID of an external ID.
+   *
+   * @param id The external ID.
+   * @return The dense ID.
+   * @throws std::out_of_range If the external ID is not mapped.
+   */
+  DenseId at(ExternalId const &id) const
+  {
+    auto const dense = find(id);
+    if(get(dense) == lookup::empty) {
+      throw std::out_of_range("strong::dense_remapper::at");
+    }
+    return dense;
+  }
+
+  /**
+   * Test whether an external ID is mapped.
+   *
+   * @param id The external ID.
+   * @return True if the external ID has a dense ID.
+   */
+  bool contains(ExternalId const &id) const noexcept
+  {
+    return get(find(id)) != lookup::empty;
+  }
+
+  /**
+   * Look up the external ID of a dense ID.
+   *
+   * @param id A dense ID less than size().
+   * @return The external ID.
+   */
+  ExternalId operator[](DenseId const &id) const noexcept
+  {
+    return externals[static_cast<size_type>(get(id))];
+  }
+
+  /**
+   * @return The external IDs indexed by their dense ID, in increasing order.
+   */
+  std::vector<ExternalId, Allocator> const & reverse() const noexcept
+  {
+    return externals;
+  }
+
+  /**
+   * @return The number of distinct IDs.
+   */
+  size_type size() const noexcept
+  {
+    return externals.size();
+  }
+
+  /**
+   * @return The number of bytes that serialize writes.
+   */
+  size_type serialized_size() const noexcept
+  {
+    return detail::align_up(sizeof(detail::remapper_header) + externals.size() * sizeof(ExternalId))
+      + slots.size() * sizeof(DenseId);
+  }
+
+  /**
+   * Write the mapping to a buffer in the layout read by dense_remapper_view.
+   *
+   * The buffer can be written to a file and later memory-mapped; the layout uses the native byte
+   * order and is only meant to be read back on the same platform.
+   *
+   * @param buffer A buffer of at least serialized_size() bytes, aligned to 8 bytes.
+   */
+  void serialize(void *buffer) const noexcept
+  {
+    detail::remapper_header header;
+    header.magic = detail::remapper_magic;
+    header.count = externals.size();
+    header.capacity = slots.size();
+    header.external_size = sizeof(ExternalId);
+    header.dense_size = sizeof(DenseId);
+
+    auto const bytes = static_cast<unsigned char *>(buffer);
+    auto const slots_offset = detail::align_up(sizeof(header) + externals.size() * sizeof(ExternalId));
+    std::memset(bytes, 0, slots_offset);
+    std::memcpy(bytes, &header, sizeof(header));
+    if(!externals.empty()) {
+      std::memcpy(bytes + sizeof(header), externals.data(), externals.size() * sizeof(ExternalId));
+      std::memcpy(bytes + slots_offset, slots.data(), slots.size() * sizeof(DenseId));
+    }
+  }
+
+  /**
+   * @return The allocator of the mapping.
+   */
+  allocator_type get_allocator() const
+  {
+    return externals.get_allocator();
+  }
+
+private:
+  using lookup = detail::remapper_lookup<ExternalId, DenseId>;
+  using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<DenseId>;
+
+  std::vector<ExternalId, Allocator> externals;
+  std::vector<DenseId, slot_allocator> slots;
+};
+
+/**
+ * A read-only dense_remapper that uses a serialized buffer in place.
+ *
+ * Intended for buffers that are memory-mapped from a file written with dense_remapper::serialize,
+ * so reloading a mapping does not rebuild anything. The hash table is checked once when the view
+ * is constructed, so that a corrupt buffer cannot make lookups loop or read out of bounds. The
+ * buffer must outlive the view.
+ *
+ * @tparam ExternalId A strong typedef with an integral underlying type for the external IDs.
+ * @tparam DenseId A strong typedef with an unsigned underlying type for the dense IDs.
+ */
+template<class ExternalId, class DenseId>
+class dense_remapper_view {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Use a serialized mapping.
+   *
+   * @param buffer The serialized mapping, aligned to 8 bytes.
+   * @param size The size of the buffer in bytes.
+   * @throws std::invalid_argument If the buffer does not hold a valid mapping with these ID types.
+   */
+  dense_remapper_view(void const *buffer, size_type size)
+  {
+    detail::remapper_header header;
+    if(size < sizeof(header)) {
+      throw std::invalid_argument("strong::dense_remapper_view: buffer is too small");
+    }
+
+    std::memcpy(&header, buffer, sizeof(header));
+    if(header.magic != detail::remapper_magic || header.external_size != sizeof(ExternalId)
+       || header.dense_size != sizeof(DenseId)) {
+      throw std::invalid_argument("strong::dense_remapper_view: buffer does not hold a matching mapping");
+    }
+
+    // the sizes are checked by division first, so that a corrupt header cannot overflow them
+    auto const bytes = static_cast<unsigned char const *>(buffer);
+    if(header.count > (size - sizeof(header)) / sizeof(ExternalId)) {
+      throw std::invalid_argument("strong::dense_remapper_view: buffer is truncated");
+    }
+    auto const slots_offset = detail::align_up(sizeof(header) + static_cast<size_type>(header.count) * sizeof(ExternalId));
+    if(slots_offset > size || header.capacity > (size - slots_offset) / sizeof(DenseId)) {
+      throw std::invalid_argument("strong::dense_remapper_view: buffer is truncated");
+    }
+
+    // lookups probe until they find an empty slot, so the table must be a power of two with room
+    // to spare, and every dense ID in it must index the external IDs
+    if(header.capacity == 0 ? header.count != 0
+                            : (header.capacity & (header.capacity - 1)) != 0 || header.capacity <= header.count) {
+      throw std::invalid_argument("strong::dense_remapper_view: hash table has an invalid capacity");
+    }
+    externals = reinterpret_cast<ExternalId const *>(bytes + sizeof(header));
+    slots = reinterpret_cast<DenseId const *>(bytes + slots_offset);
+    count = static_cast<size_type>(header.count);
+    capacity = static_cast<size_type>(header.capacity);
+
+    size_type used = 0;
+    for(size_type slot = 0; slot < capacity; ++slot) {
+      auto const dense = get(slots[slot]);
+      if(dense != lookup::empty) {
+        if(static_cast<size_type>(dense) >= count) {
+          throw std::invalid_argument("strong::dense_remapper_view: hash table holds an unknown dense ID");
+        }
+        ++used;
+      }
+    }
+    if(used >= capacity && capacity != 0) {
+      throw std::invalid_argument("strong::dense_remapper_view: hash table is full");
+    }
+  }
+
+  /**
+   * Look up the dense ID of an external ID.
+   *
+   * @param id The external ID.
+   * @return The dense ID, or the largest DenseId value if the external ID is not mapped.
+   */
+  DenseId find(ExternalId const &id) const noexcept
+  {
+    return lookup::find(id, externals, slots, capacity);
+  }
+
+  /**
+   * Test whether an external ID is mapped.
+   *
+   * @param id The external ID.
+   * @return True if the external ID has a dense ID.
+   */
+  bool contains(ExternalId const &id) const noexcept
+  {
+    return get(find(id)) != lookup::empty;
+  }
+
+  /**
+   * Look up the external ID of a dense ID.
+   *
+   * @param id A dense ID less than size().
+   * @return The external ID.
+   */
+  ExternalId operator[](DenseId const &id) const noexcept
+  {
+    return externals[static_cast<size_type>(get(id))];
+  }
+
+  /**
+   * @return A pointer to the external IDs indexed by their dense ID.
+   */
+  ExternalId const * reverse() const noexcept
+  {
+    return externals;
+  }
+
+  /**
+   * @return The number of distinct IDs.
+   */
+  size_type size() const noexcept
+  {
+    return count;
+  }
+
+private:
+  using lookup = detail::remapper_lookup<ExternalId, DenseId>;
+
+  ExternalId const *externals;
+  DenseId const *slots;
+  size_type count;
+  size_type capacity;
+};
+
+}
+
+#endif //STRONG_DENSE_REMAPPER_HPP
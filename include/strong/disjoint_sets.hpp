@@ -0,0 +1,361 @@
+#ifndef STRONG_DISJOINT_SETS_HPP
+#define STRONG_DISJOINT_SETS_HPP
+
+#include <strong.hpp>
+#include <strong/vector.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+namespace detail {
+
+template<class NodeId>
+NodeId node_at(std::size_t position) noexcept
+{
+  return NodeId(static_cast<typename underlying_type<NodeId>::type>(position));
+}
+
+template<class NodeId>
+std::size_t position_of(NodeId const &id) noexcept
+{
+  return static_cast<std::size_t>(get(id));
+}
+
+template<class NodeId, class ComponentId, class Find>
+vector<NodeId, ComponentId> label_components(std::size_t count, Find find)
+{
+  using label_type = typename underlying_type<ComponentId>::type;
+  auto const unlabeled = std::numeric_limits<std::size_t>::max();
+
+  // roots are labeled in increasing order of node ID, so the labels do not depend on union order
+  std::vector<std::size_t> root_label(count, unlabeled);
+  vector<NodeId, ComponentId> labels;
+  labels.reserve(count);
+
+  std::size_t next = 0;
+  for(std::size_t i = 0; i < count; ++i) {
+    auto &label = root_label[position_of(find(node_at<NodeId>(i)))];
+    if(label == unlabeled) {
+      label = next++;
+    }
+    labels.push_back(ComponentId(static_cast<label_type>(label)));
+  }
+  return labels;
+}
+
+}
+
+/**
+ * A partition of strong node IDs into disjoint sets (union-find).
+ *
+ * Uses union by size and path halving, so any sequence of operations runs in nearly constant
+ * amortized time per operation. Nodes are numbered from zero to size() - 1.
+ *
+ * @tparam NodeId A strong typedef whose underlying type is an unsigned integer.
+ * @tparam Allocator The allocator of the parent array, rebound for the set sizes.
+ */
+template<class NodeId, class Allocator = std::allocator<NodeId>>
+class disjoint_sets {
+public:
+  using size_type = std::size_t;
+  using allocator_type = Allocator;
+
+  static_assert(std::is_unsigned<typename underlying_type<NodeId>::type>::value,
+                "disjoint_sets requires a strong typedef with an unsigned underlying type");
+
+  /**
+   * Construct a partition where every node is in a set of its own.
+   *
+   * @param count The number of nodes.
+   * @param allocator The allocator to use.
+   */
+  explicit disjoint_sets(size_type count = 0, Allocator const &allocator = Allocator())
+    : parent(allocator), sizes(count, 1, size_allocator(allocator)), sets(count)
+  {
+    parent.reserve(count);
+    for(size_type i = 0; i < count; ++i) {
+      parent.push_back(detail::node_at<NodeId>(i));
+    }
+  }
+
+  /**
+   * Add a node in a set of its own.
+   *
+   * @return The ID of the new node.
+   */
+  NodeId add()
+  {
+    auto const id = parent.next_index();
+    parent.push_back(id);
+    sizes.push_back(1);
+    ++sets;
+    return id;
+  }
+
+  /**
+   * Find the representative of the set that contains a node.
+   *
+   * @param id The node.
+   * @return The representative, which is the same for every node in the set.
+   */
+  NodeId find(NodeId id) noexcept
+  {
+    while(get(parent[id]) != get(id)) {
+      // path halving: point every other node on the path at its grandparent
+      parent[id] = parent[parent[id]];
+      id = parent[id];
+    }
+    return id;
+  }
+
+  /**
+   * Merge the sets that contain two nodes.
+   *
+   * @param lhs A node in the first set.
+   * @param rhs A node in the second set.
+   * @return True if the sets were merged, false if the nodes were already in the same set.
+   */
+  bool unite(NodeId const &lhs, NodeId const &rhs) noexcept
+  {
+    auto a = find(lhs);
+    auto b = find(rhs);
+    if(get(a) == get(b)) {
+      return false;
+    }
+
+    if(sizes[detail::position_of(a)] < sizes[detail::position_of(b)]) {
+      std::swap(a, b);
+    }
+    parent[b] = a;
+    sizes[detail::position_of(a)] += sizes[detail::position_of(b)];
+    --sets;
+    return true;
+  }
+
+  /**
+   * Test whether two nodes are in the same set.
+   *
+   * @param lhs The first node.
+   * @param rhs The second node.
+   * @return True if the nodes are in the same set.
+   */
+  bool same(NodeId const &lhs, NodeId const &rhs) noexcept
+  {
+    return get(find(lhs)) == get(find(rhs));
+  }
+
+  /**
+   * Count the nodes in the set that contains a node.
+   *
+   * @param id The node.
+   * @return The number of nodes in its set.
+   */
+  size_type size_of(NodeId const &id) noexcept
+  {
+    return sizes[detail::position_of(find(id))];
+  }
+
+  /**
+   * Number each set densely.
+   *
+   * Sets are numbered from zero in increasing order of their smallest node ID.
+   *
+   * @tparam ComponentId The strong typedef for set labels.
+   * @return The label of the set of each node.
+   */
+  template<class ComponentId>
+  vector<NodeId, ComponentId> labels()
+  {
+    return detail::label_components<NodeId, ComponentId>(size(), [this](NodeId const &id) { return find(id); });
+  }
+
+  /**
+   * @return The number of nodes.
+   */
+  size_type size() const noexcept
+  {
+    return parent.size();
+  }
+
+  /**
+   * @return The number of disjoint sets.
+   */
+  size_type count() const noexcept
+  {
+    return sets;
+  }
+
+  /**
+   * @return The allocator of the partition.
+   */
+  allocator_type get_allocator() const
+  {
+    return parent.get_allocator();
+  }
+
+private:
+  using size_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<size_type>;
+
+  vector<NodeId, NodeId, Allocator> parent;
+  std::vector<size_type, size_allocator> sizes;
+  size_type sets;
+};
+
+/**
+ * A partition of strong node IDs into disjoint sets that can be updated by many threads at once.
+ *
+ * All operations are lock-free. Links are installed with compare-and-swap, and path halving is
+ * done with compare-and-swap so that concurrent finds never undo each other's progress. When two
+ * sets are merged, the root with the larger ID is linked below the root with the smaller ID;
+ * ordering links by ID rules out cycles without needing a separate rank that would have to be
+ * updated atomically with the link. Nodes are numbered from zero to size() - 1 and the number of
+ * nodes is fixed at construction.
+ *
+ * @tparam NodeId A strong typedef whose underlying type is an unsigned integer.
+ */
+template<class NodeId>
+class concurrent_disjoint_sets {
+public:
+  using size_type = std::size_t;
+
+  static_assert(std::is_unsigned<typename underlying_type<NodeId>::type>::value,
+                "concurrent_disjoint_sets requires a strong typedef with an unsigned underlying type");
+
+  /**
+   * Construct a partition where every node is in a set of its own.
+   *
+   * @param count The number of nodes.
+   */
+  explicit concurrent_disjoint_sets(size_type count)
+    : parent(new std::atomic<value_type>[count]), nodes(count)
+  {
+    for(size_type i = 0; i < count; ++i) {
+      parent[i].store(static_cast<value_type>(i), std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Find the representative of the set that contains a node.
+   *
+   * The representative may change if another thread merges the set concurrently.
+   *
+   * @param id The node.
+   * @return The representative at the time of the call.
+   */
+  NodeId find(NodeId const &id) noexcept
+  {
+    return NodeId(find(get(id)));
+  }
+
+  /**
+   * Merge the sets that contain two nodes.
+   *
+   * @param lhs A node in the first set.
+   * @param rhs A node in the second set.
+   * @return True if this call merged the sets, false if the nodes were already in the same set.
+   */
+  bool unite(NodeId const &lhs, NodeId const &rhs) noexcept
+  {
+    auto a = get(lhs);
+    auto b = get(rhs);
+    for(;;) {
+      a = find(a);
+      b = find(b);
+      if(a == b) {
+        return false;
+      }
+
+      if(a < b) {
+        std::swap(a, b);
+      }
+
+      // a is the larger root; it only stops being a root if another thread links it first
+      auto expected = a;
+      if(parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel)) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * Test whether two nodes are in the same set.
+   *
+   * @param lhs The first node.
+   * @param rhs The second node.
+   * @return True if the nodes are in the same set.
+   */
+  bool same(NodeId const &lhs, NodeId const &rhs) noexcept
+  {
+    auto a = get(lhs);
+    auto b = get(rhs);
+    for(;;) {
+      a = find(a);
+      b = find(b);
+      if(a == b) {
+        return true;
+      }
+
+      // the answer is only final if a is still a root after b was found
+      if(parent[a].load(std::memory_order_acquire) == a) {
+        return false;
+      }
+    }
+  }
+
+  /**
+   * Number each set densely.
+   *
+   * Must not be called concurrently with unite. Sets are numbered from zero in increasing order of
+   * their smallest node ID.
+   *
+   * @tparam ComponentId The strong typedef for set labels.
+   * @return The label of the set of each node.
+   */
+  template<class ComponentId>
+  vector<NodeId, ComponentId> labels()
+  {
+    return detail::label_components<NodeId, ComponentId>(size(), [this](NodeId const &id) { return find(id); });
+  }
+
+  /**
+   * @return The number of nodes.
+   */
+  size_type size() const noexcept
+  {
+    return nodes;
+  }
+
+private:
+  using value_type = typename underlying_type<NodeId>::type;
+
+  value_type find(value_type id) noexcept
+  {
+    for(;;) {
+      auto p = parent[id].load(std::memory_order_acquire);
+      if(p == id) {
+        return id;
+      }
+
+      auto const grandparent = parent[p].load(std::memory_order_acquire);
+      if(grandparent != p) {
+        // failure only means another thread already shortened the path
+        parent[id].compare_exchange_weak(p, grandparent, std::memory_order_acq_rel);
+      }
+      id = grandparent;
+    }
+  }
+
+  std::unique_ptr<std::atomic<value_type>[]> parent;
+  size_type nodes;
+};
+
+}
+
+#endif //STRONG_DISJOINT_SETS_HPP
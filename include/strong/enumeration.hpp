@@ -0,0 +1,381 @@
+#ifndef STRONG_ENUMERATION_HPP
+#define STRONG_ENUMERATION_HPP
+
+#include <strong.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace strong {
+
+namespace detail {
+
+template<typename Underlying, bool = std::is_enum<Underlying>::value>
+struct enumeration_integer {
+  using type = typename std::underlying_type<Underlying>::type;
+};
+
+template<typename Underlying>
+struct enumeration_integer<Underlying, false> {
+  using type = Underlying;
+};
+
+}
+
+/**
+ * A strong typedef for a closed set of Count values, numbered densely from 0 to Count - 1.
+ *
+ * The underlying type is either an integer or an enum whose enumerators are 0 to Count - 1, e.g.
+ *
+ *     enum class stage_kind : std::uint8_t { fetch, decode, execute, memory, writeback };
+ *
+ *     struct stage : strong::enumeration<stage, stage_kind, 5> {
+ *       using strong::enumeration<stage, stage_kind, 5>::enumeration;
+ *     };
+ *
+ * A value takes no more space than its underlying type. Switching on get(value) with the
+ * enumerators as cases compiles to a jump table as usual, and enum_map looks values up by direct
+ * indexing, so neither needs a cast. Values compare for equality and order, and every value can be
+ * visited with enumerators.
+ *
+ * @tparam TypeName The strong typedef deriving from enumeration.
+ * @tparam Underlying The integral or enum type that stores the value.
+ * @tparam Count The number of values.
+ */
+template<class TypeName, typename Underlying, std::size_t Count>
+class enumeration
+  : public type<TypeName, Underlying>
+  , public op::equals<TypeName>
+  , public op::orders<TypeName> {
+public:
+  static_assert(std::is_integral<Underlying>::value || std::is_enum<Underlying>::value,
+                "enumerations require an integral or enum underlying type");
+  static_assert(Count == 0
+                || Count - 1 <= static_cast<typename std::make_unsigned<typename detail::enumeration_integer<Underlying>::type>::type>(
+                     std::numeric_limits<typename detail::enumeration_integer<Underlying>::type>::max()),
+                "the underlying type cannot represent every value of the enumeration");
+
+  /**
+   * The number of values.
+   */
+  static constexpr std::size_t count = Count;
+
+  /**
+   * Construct the first value.
+   */
+  constexpr enumeration() : type<TypeName, Underlying>()
+  {
+  }
+
+  /**
+   * Construct a value from its underlying value.
+   *
+   * @param value The underlying value, which must be less than Count.
+   */
+  explicit constexpr enumeration(Underlying value) : type<TypeName, Underlying>(value)
+  {
+  }
+
+  /**
+   * @return The position of the value, from 0 to Count - 1.
+   */
+  constexpr std::size_t index() const noexcept
+  {
+    return static_cast<std::size_t>(get(*this));
+  }
+
+  /**
+   * Construct the value at a position.
+   *
+   * @param index The position of the value, which must be less than Count.
+   * @return The value.
+   */
+  static constexpr TypeName from_index(std::size_t index) noexcept
+  {
+    return TypeName(static_cast<Underlying>(index));
+  }
+};
+
+template<class TypeName, typename Underlying, std::size_t Count>
+constexpr std::size_t enumeration<TypeName, Underlying, Count>::count;
+
+/**
+ * The values of an enumeration, in increasing order.
+ *
+ * @tparam Enum The enumeration.
+ */
+template<class Enum>
+class enumerator_range {
+public:
+  /**
+   * An iterator over the values of an enumeration.
+   */
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Enum;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Enum const *;
+    using reference = Enum;
+
+    constexpr iterator() : position(0)
+    {
+    }
+
+    explicit constexpr iterator(std::size_t position) : position(position)
+    {
+    }
+
+    constexpr Enum operator*() const noexcept
+    {
+      return Enum::from_index(position);
+    }
+
+    iterator & operator++() noexcept
+    {
+      ++position;
+      return *this;
+    }
+
+    iterator operator++(int) noexcept
+    {
+      auto const previous = *this;
+      ++position;
+      return previous;
+    }
+
+    friend constexpr bool operator==(iterator const &lhs, iterator const &rhs) noexcept
+    {
+      return lhs.position == rhs.position;
+    }
+
+    friend constexpr bool operator!=(iterator const &lhs, iterator const &rhs) noexcept
+    {
+      return lhs.position != rhs.position;
+    }
+
+  private:
+    std::size_t position;
+  };
+
+  /**
+   * @return An iterator to the first value.
+   */
+  constexpr iterator begin() const noexcept
+  {
+    return iterator(0);
+  }
+
+  /**
+   * @return An iterator past the last value.
+   */
+  constexpr iterator end() const noexcept
+  {
+    return iterator(Enum::count);
+  }
+
+  /**
+   * @return The number of values.
+   */
+  static constexpr std::size_t size() noexcept
+  {
+    return Enum::count;
+  }
+};
+
+/**
+ * Visit every value of an enumeration, e.g. for(auto s : strong::enumerators<stage>()).
+ *
+ * @tparam Enum The enumeration.
+ * @return The values of the enumeration, in increasing order.
+ */
+template<class Enum>
+constexpr enumerator_range<Enum> enumerators() noexcept
+{
+  return enumerator_range<Enum>();
+}
+
+/**
+ * A fixed-size array with one element for each value of an enumeration, indexed only by it.
+ *
+ * The elements are stored inline in the order of the values, so a lookup is a single indexed
+ * load, e.g. a table of latencies by pipeline stage.
+ *
+ * @tparam Enum The enumeration, deriving from strong::enumeration.
+ * @tparam T The type of the elements.
+ */
+template<class Enum, typename T>
+class enum_map {
+public:
+  using key_type = Enum;
+  using value_type = T;
+  using size_type = std::size_t;
+  using reference = T &;
+  using const_reference = T const &;
+  using iterator = typename std::array<T, Enum::count>::iterator;
+  using const_iterator = typename std::array<T, Enum::count>::const_iterator;
+
+  /**
+   * Construct a map of value-initialized elements.
+   */
+  enum_map() : elements()
+  {
+  }
+
+  /**
+   * Construct a map of copies of a value.
+   *
+   * @param value The value to copy into each element.
+   */
+  explicit enum_map(T const &value)
+  {
+    elements.fill(value);
+  }
+
+  /**
+   * Construct a map from its elements in the order of the values of the enumeration.
+   *
+   * Elements past the end of the list are value-initialized.
+   *
+   * @param values The elements.
+   * @throws std::invalid_argument If there are more elements than values of the enumeration.
+   */
+  enum_map(std::initializer_list<T> values) : elements()
+  {
+    if(values.size() > Enum::count) {
+      throw std::invalid_argument("strong::enum_map: more elements than enumerators");
+    }
+    std::copy(values.begin(), values.end(), elements.begin());
+  }
+
+  /**
+   * Access an element without bounds checking.
+   *
+   * @param key The value of the enumeration.
+   * @return A reference to the element.
+   */
+  reference operator[](Enum const &key) noexcept
+  {
+    return elements[key.index()];
+  }
+
+  /**
+   * Access an element without bounds checking.
+   *
+   * @param key The value of the enumeration.
+   * @return A reference to the element.
+   */
+  const_reference operator[](Enum const &key) const noexcept
+  {
+    return elements[key.index()];
+  }
+
+  /**
+   * Access an element.
+   *
+   * @param key The value of the enumeration.
+   * @return A reference to the element.
+   * @throws std::out_of_range If the key is not one of the values of the enumeration.
+   */
+  reference at(Enum const &key)
+  {
+    if(key.index() >= Enum::count) {
+      throw std::out_of_range("strong::enum_map: key is not an enumerator");
+    }
+    return elements[key.index()];
+  }
+
+  /**
+   * Access an element.
+   *
+   * @param key The value of the enumeration.
+   * @return A reference to the element.
+   * @throws std::out_of_range If the key is not one of the values of the enumeration.
+   */
+  const_reference at(Enum const &key) const
+  {
+    if(key.index() >= Enum::count) {
+      throw std::out_of_range("strong::enum_map: key is not an enumerator");
+    }
+    return elements[key.index()];
+  }
+
+  /**
+   * Copy a value into every element.
+   *
+   * @param value The value to copy.
+   */
+  void fill(T const &value)
+  {
+    elements.fill(value);
+  }
+
+  /**
+   * @return The number of elements, which is the number of values of the enumeration.
+   */
+  static constexpr size_type size() noexcept
+  {
+    return Enum::count;
+  }
+
+  /**
+   * @return A pointer to the first element.
+   */
+  T * data() noexcept
+  {
+    return elements.data();
+  }
+
+  /**
+   * @return A pointer to the first element.
+   */
+  T const * data() const noexcept
+  {
+    return elements.data();
+  }
+
+  /**
+   * @return An iterator to the first element.
+   */
+  iterator begin() noexcept
+  {
+    return elements.begin();
+  }
+
+  /**
+   * @return An iterator past the last element.
+   */
+  iterator end() noexcept
+  {
+    return elements.end();
+  }
+
+  /**
+   * @return An iterator to the first element.
+   */
+  const_iterator begin() const noexcept
+  {
+    return elements.begin();
+  }
+
+  /**
+   * @return An iterator past the last element.
+   */
+  const_iterator end() const noexcept
+  {
+    return elements.end();
+  }
+
+private:
+  std::array<T, Enum::count> elements;
+};
+
+}
+
+#endif //STRONG_ENUMERATION_HPP
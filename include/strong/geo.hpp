@@ -0,0 +1,457 @@
+#ifndef STRONG_GEO_HPP
+#define STRONG_GEO_HPP
+
+#include <strong.hpp>
+#include <strong/vector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+/**
+ * The number of fixed-point units in one degree of latitude or longitude.
+ *
+ * One unit is 1e-7 degrees, about 1.1 cm at the equator, which is the same resolution used by
+ * OpenStreetMap. Every valid coordinate fits in a signed 32-bit integer.
+ */
+constexpr double coordinate_scale = 1e7;
+
+/**
+ * The mean radius of the Earth in meters, used by the distance functions.
+ */
+constexpr double earth_radius = 6371008.8;
+
+/**
+ * A distance in meters.
+ */
+struct meters
+  : type<meters, double>
+  , op::equals<meters>
+  , op::orders<meters>
+  , op::adds<meters>
+  , op::subtracts<meters>
+{
+  using type<meters, double>::type;
+};
+
+/**
+ * A latitude stored as a 32-bit fixed-point number of 1e-7 degrees.
+ *
+ * Being a distinct type from longitude, a latitude cannot be passed where a longitude is
+ * expected, and a coordinate pair takes 8 bytes instead of the 16 bytes of two doubles.
+ */
+struct latitude
+  : type<latitude, std::int32_t>
+  , op::equals<latitude>
+  , op::orders<latitude>
+{
+  using type<latitude, std::int32_t>::type;
+
+  /**
+   * Convert a latitude in degrees to fixed point, rounding to the nearest unit.
+   *
+   * @param degrees The latitude in degrees, between -90 and 90.
+   * @return The fixed-point latitude.
+   */
+  static latitude from_degrees(double degrees) noexcept
+  {
+    return latitude(static_cast<std::int32_t>(std::lround(degrees * coordinate_scale)));
+  }
+};
+
+/**
+ * A longitude stored as a 32-bit fixed-point number of 1e-7 degrees.
+ */
+struct longitude
+  : type<longitude, std::int32_t>
+  , op::equals<longitude>
+  , op::orders<longitude>
+{
+  using type<longitude, std::int32_t>::type;
+
+  /**
+   * Convert a longitude in degrees to fixed point, rounding to the nearest unit.
+   *
+   * @param degrees The longitude in degrees, between -180 and 180.
+   * @return The fixed-point longitude.
+   */
+  static longitude from_degrees(double degrees) noexcept
+  {
+    return longitude(static_cast<std::int32_t>(std::lround(degrees * coordinate_scale)));
+  }
+};
+
+/**
+ * @param value A fixed-point latitude.
+ * @return The latitude in degrees.
+ */
+inline double degrees(latitude const &value) noexcept
+{
+  return get(value) / coordinate_scale;
+}
+
+/**
+ * @param value A fixed-point longitude.
+ * @return The longitude in degrees.
+ */
+inline double degrees(longitude const &value) noexcept
+{
+  return get(value) / coordinate_scale;
+}
+
+/**
+ * A position on the Earth's surface.
+ */
+struct geo_point {
+  strong::latitude latitude;
+  strong::longitude longitude;
+};
+
+/**
+ * An axis-aligned box of latitudes and longitudes, including its edges.
+ *
+ * Boxes that cross the antimeridian are not supported.
+ */
+struct geo_box {
+  geo_point low;
+  geo_point high;
+};
+
+namespace detail {
+
+constexpr double radians_per_unit = 3.14159265358979323846 / 180.0 / coordinate_scale;
+
+inline double equirectangular(std::int32_t lat1, std::int32_t lon1, std::int32_t lat2, std::int32_t lon2) noexcept
+{
+  double const mean = (static_cast<double>(lat1) + lat2) * (0.5 * radians_per_unit);
+  double const x = (static_cast<double>(lon2) - lon1) * radians_per_unit * std::cos(mean);
+  double const y = (static_cast<double>(lat2) - lat1) * radians_per_unit;
+  return earth_radius * std::sqrt(x * x + y * y);
+}
+
+inline double haversine(std::int32_t lat1, std::int32_t lon1, std::int32_t lat2, std::int32_t lon2) noexcept
+{
+  double const phi1 = lat1 * radians_per_unit;
+  double const phi2 = lat2 * radians_per_unit;
+  double const half_dphi = (static_cast<double>(lat2) - lat1) * (0.5 * radians_per_unit);
+  double const half_dlambda = (static_cast<double>(lon2) - lon1) * (0.5 * radians_per_unit);
+  double const a = std::sin(half_dphi) * std::sin(half_dphi)
+                   + std::cos(phi1) * std::cos(phi2) * std::sin(half_dlambda) * std::sin(half_dlambda);
+  return 2 * earth_radius * std::asin(std::sqrt(std::min(1.0, a)));
+}
+
+}
+
+/**
+ * Approximate the distance between two points with the equirectangular projection.
+ *
+ * Much cheaper than haversine_distance and accurate to well under 0.1% for points a few
+ * kilometers apart, which makes it the right choice for ranking nearby candidates.
+ *
+ * @param from The first point.
+ * @param to The second point.
+ * @return The approximate distance.
+ */
+inline meters equirectangular_distance(geo_point const &from, geo_point const &to) noexcept
+{
+  return meters(detail::equirectangular(get(from.latitude), get(from.longitude), get(to.latitude),
+                                        get(to.longitude)));
+}
+
+/**
+ * Compute the great-circle distance between two points with the haversine formula.
+ *
+ * @param from The first point.
+ * @param to The second point.
+ * @return The distance along the surface of a spherical Earth.
+ */
+inline meters haversine_distance(geo_point const &from, geo_point const &to) noexcept
+{
+  return meters(detail::haversine(get(from.latitude), get(from.longitude), get(to.latitude),
+                                  get(to.longitude)));
+}
+
+/**
+ * Compute the equirectangular distance from one point to many points.
+ *
+ * The loop has no branches or calls other than to cos and sqrt, so it vectorizes when the compiler
+ * is allowed to use a vector math library (e.g. GCC with -O3 -ffast-math on glibc).
+ *
+ * @param origin The point to measure from.
+ * @param points The points to measure to.
+ * @param count The number of points.
+ * @param distances Receives the distance to each point.
+ */
+inline void equirectangular_distances(geo_point const &origin, geo_point const *points, std::size_t count,
+                                      meters *distances) noexcept
+{
+  auto const lat = get(origin.latitude);
+  auto const lon = get(origin.longitude);
+  for(std::size_t i = 0; i < count; ++i) {
+    get(distances[i]) = detail::equirectangular(lat, lon, get(points[i].latitude), get(points[i].longitude));
+  }
+}
+
+/**
+ * Compute the haversine distance from one point to many points.
+ *
+ * @param origin The point to measure from.
+ * @param points The points to measure to.
+ * @param count The number of points.
+ * @param distances Receives the distance to each point.
+ */
+inline void haversine_distances(geo_point const &origin, geo_point const *points, std::size_t count,
+                                meters *distances) noexcept
+{
+  auto const lat = get(origin.latitude);
+  auto const lon = get(origin.longitude);
+  for(std::size_t i = 0; i < count; ++i) {
+    get(distances[i]) = detail::haversine(lat, lon, get(points[i].latitude), get(points[i].longitude));
+  }
+}
+
+/**
+ * A uniform grid over a set of points for nearest-neighbour and bounding-box queries.
+ *
+ * The IDs of the points are bucketed by grid cell and stored contiguously, together with a copy
+ * of their coordinates, so a query only reads the cells it overlaps. The grid is sized so that a
+ * cell holds a few points on average. Distances are ranked with equirectangular_distance.
+ *
+ * @tparam PointId A strong typedef whose underlying type is an unsigned integer (e.g. an
+ *                 intersection ID).
+ */
+template<class PointId>
+class spatial_index {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Build an index over a set of points.
+   *
+   * @param points The position of each point, indexed by its ID.
+   */
+  template<class Allocator>
+  explicit spatial_index(vector<PointId, geo_point, Allocator> const &points)
+  {
+    auto const count = points.size();
+    if(count == 0) {
+      return;
+    }
+
+    bounds.low = bounds.high = *points.begin();
+    for(auto const &point : points) {
+      bounds.low.latitude = std::min(bounds.low.latitude, point.latitude);
+      bounds.low.longitude = std::min(bounds.low.longitude, point.longitude);
+      bounds.high.latitude = std::max(bounds.high.latitude, point.latitude);
+      bounds.high.longitude = std::max(bounds.high.longitude, point.longitude);
+    }
+
+    // aim for about four points per cell
+    auto const side = std::max<size_type>(1, static_cast<size_type>(std::sqrt(count / 4.0)));
+    rows = columns = side;
+    cell_height = std::max<std::int64_t>(1, (span(bounds.low.latitude, bounds.high.latitude) + side) / side);
+    cell_width = std::max<std::int64_t>(1, (span(bounds.low.longitude, bounds.high.longitude) + side) / side);
+
+    // counting sort of the points by cell
+    starts.assign(rows * columns + 1, 0);
+    for(auto const &point : points) {
+      ++starts[cell_of(point) + 1];
+    }
+    for(size_type i = 1; i < starts.size(); ++i) {
+      starts[i] += starts[i - 1];
+    }
+
+    ids.resize(count);
+    positions.resize(count);
+    auto next = starts;
+    for(size_type i = 0; i < count; ++i) {
+      auto const id = PointId(static_cast<typename underlying_type<PointId>::type>(i));
+      auto const slot = next[cell_of(points[id])]++;
+      ids[slot] = id;
+      positions[slot] = points[id];
+    }
+  }
+
+  /**
+   * Visit every point inside a box.
+   *
+   * @param box The box to search, including its edges.
+   * @param function Called as function(id) for each point inside the box.
+   */
+  template<class Function>
+  void for_each_within(geo_box const &box, Function function) const
+  {
+    if(ids.empty()) {
+      return;
+    }
+
+    auto const row_range = std::make_pair(row_of(box.low.latitude), row_of(box.high.latitude));
+    auto const column_range = std::make_pair(column_of(box.low.longitude), column_of(box.high.longitude));
+
+    for(auto row = row_range.first; row <= row_range.second; ++row) {
+      for(auto column = column_range.first; column <= column_range.second; ++column) {
+        auto const cell = row * columns + column;
+        for(auto i = starts[cell]; i < starts[cell + 1]; ++i) {
+          auto const &point = positions[i];
+          if(!(point.latitude < box.low.latitude) && !(box.high.latitude < point.latitude)
+             && !(point.longitude < box.low.longitude) && !(box.high.longitude < point.longitude)) {
+            function(ids[i]);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Find every point inside a box.
+   *
+   * @param box The box to search, including its edges.
+   * @return The IDs of the points inside the box, in no particular order.
+   */
+  std::vector<PointId> within(geo_box const &box) const
+  {
+    std::vector<PointId> result;
+    for_each_within(box, [&result](PointId const &id) { result.push_back(id); });
+    return result;
+  }
+
+  /**
+   * Find the points closest to a position.
+   *
+   * Searches rings of cells of increasing radius around the position and stops once no unvisited
+   * cell can hold a point closer than the k-th best found so far.
+   *
+   * @param origin The position to search around.
+   * @param k The number of points to find.
+   * @return Up to k IDs, ordered from closest to farthest.
+   */
+  std::vector<PointId> nearest(geo_point const &origin, size_type k) const
+  {
+    std::vector<std::pair<double, PointId>> best;
+    if(ids.empty() || k == 0) {
+      return {};
+    }
+
+    auto const by_distance = [](std::pair<double, PointId> const &lhs, std::pair<double, PointId> const &rhs) {
+      return lhs.first < rhs.first;
+    };
+
+    auto const row = static_cast<std::int64_t>(row_of(origin.latitude));
+    auto const column = static_cast<std::int64_t>(column_of(origin.longitude));
+    auto const max_radius = static_cast<std::int64_t>(std::max(rows, columns));
+    auto const spacing = min_cell_size(origin);
+
+    for(std::int64_t radius = 0; radius <= max_radius; ++radius) {
+      for(auto r = row - radius; r <= row + radius; ++r) {
+        if(r < 0 || r >= static_cast<std::int64_t>(rows)) {
+          continue;
+        }
+        for(auto c = column - radius; c <= column + radius; ++c) {
+          if(c < 0 || c >= static_cast<std::int64_t>(columns)) {
+            continue;
+          }
+          // only visit the outline of the square; the inside was visited with a smaller radius
+          if(r != row - radius && r != row + radius && c != column - radius && c != column + radius) {
+            continue;
+          }
+
+          auto const cell = static_cast<size_type>(r) * columns + static_cast<size_type>(c);
+          for(auto i = starts[cell]; i < starts[cell + 1]; ++i) {
+            best.emplace_back(get(equirectangular_distance(origin, positions[i])), ids[i]);
+            std::push_heap(best.begin(), best.end(), by_distance);
+            if(best.size() > k) {
+              std::pop_heap(best.begin(), best.end(), by_distance);
+              best.pop_back();
+            }
+          }
+        }
+      }
+
+      // every unvisited point is at least radius whole cells away from the origin's cell
+      if(best.size() == k && best.front().first <= radius * spacing) {
+        break;
+      }
+    }
+
+    std::sort_heap(best.begin(), best.end(), by_distance);
+    std::vector<PointId> result;
+    result.reserve(best.size());
+    for(auto const &candidate : best) {
+      result.push_back(candidate.second);
+    }
+    return result;
+  }
+
+  /**
+   * @return The smallest box that contains every indexed point.
+   */
+  geo_box const & extent() const noexcept
+  {
+    return bounds;
+  }
+
+  /**
+   * @return The number of indexed points.
+   */
+  size_type size() const noexcept
+  {
+    return ids.size();
+  }
+
+private:
+  template<class Coordinate>
+  static std::int64_t span(Coordinate const &low, Coordinate const &high) noexcept
+  {
+    return static_cast<std::int64_t>(get(high)) - get(low);
+  }
+
+  static size_type clamp(std::int64_t value, size_type count) noexcept
+  {
+    return static_cast<size_type>(std::min<std::int64_t>(std::max<std::int64_t>(value, 0),
+                                                         static_cast<std::int64_t>(count) - 1));
+  }
+
+  size_type row_of(latitude const &value) const noexcept
+  {
+    return clamp(span(bounds.low.latitude, value) / cell_height, rows);
+  }
+
+  size_type column_of(longitude const &value) const noexcept
+  {
+    return clamp(span(bounds.low.longitude, value) / cell_width, columns);
+  }
+
+  size_type cell_of(geo_point const &point) const noexcept
+  {
+    return row_of(point.latitude) * columns + column_of(point.longitude);
+  }
+
+  double min_cell_size(geo_point const &origin) const noexcept
+  {
+    // the narrowest cell is at the latitude furthest from the equator
+    auto const extreme = std::max({std::abs(static_cast<double>(get(bounds.low.latitude))),
+                                   std::abs(static_cast<double>(get(bounds.high.latitude))),
+                                   std::abs(static_cast<double>(get(origin.latitude)))});
+    auto const height = cell_height * detail::radians_per_unit * earth_radius;
+    auto const width = cell_width * detail::radians_per_unit * earth_radius * std::cos(extreme * detail::radians_per_unit);
+    return std::min(height, width);
+  }
+
+  geo_box bounds = {};
+  size_type rows = 0;
+  size_type columns = 0;
+  std::int64_t cell_height = 1;
+  std::int64_t cell_width = 1;
+  std::vector<size_type> starts;
+  std::vector<PointId> ids;
+  std::vector<geo_point> positions;
+};
+
+}
+
+#endif //STRONG_GEO_HPP
@@ -0,0 +1,97 @@
+#ifndef STRONG_HASH_HPP
+#define STRONG_HASH_HPP
+
+#include <strong.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+namespace strong {
+
+namespace detail {
+
+constexpr std::uint64_t mix_step(std::uint64_t value, unsigned shift) noexcept
+{
+  return value ^ (value >> shift);
+}
+
+}
+
+/**
+ * Scramble the bits of a 64-bit integer.
+ *
+ * Uses the splitmix64 finalizer, which maps consecutive or clustered integers (such as IDs) to
+ * values spread over the whole 64-bit range. Every output bit depends on every input bit, so the
+ * low bits of the result can be used directly as a table index.
+ *
+ * @param value The integer to scramble.
+ * @return The scrambled integer.
+ */
+constexpr std::uint64_t mix(std::uint64_t value) noexcept
+{
+  return detail::mix_step(detail::mix_step(detail::mix_step(value + 0x9e3779b97f4a7c15ULL, 30)
+                                             * 0xbf58476d1ce4e5b9ULL, 27)
+                          * 0x94d049bb133111ebULL, 31);
+}
+
+namespace detail {
+
+template<typename Type, bool Integral = std::is_integral<Type>::value || std::is_enum<Type>::value>
+struct hash_underlying {
+  std::size_t operator()(Type const &value) const
+  {
+    return static_cast<std::size_t>(mix(std::hash<Type>()(value)));
+  }
+};
+
+template<typename Type>
+struct hash_underlying<Type, true> {
+  std::size_t operator()(Type const &value) const noexcept
+  {
+    return static_cast<std::size_t>(mix(static_cast<std::uint64_t>(value)));
+  }
+};
+
+}
+
+/**
+ * A hash function object for strong typedefs.
+ *
+ * Integral underlying values are hashed with mix, so tables keyed by dense or clustered IDs do not
+ * degenerate; other underlying types are hashed with std::hash and then mixed. Can be used as the
+ * Hash parameter of the standard unordered containers.
+ *
+ * @tparam TypeName The strong typedef to hash.
+ */
+template<class TypeName>
+struct hash {
+  /**
+   * Hash a strong value.
+   *
+   * @param value The value to hash.
+   * @return The hash of the underlying value.
+   */
+  std::size_t operator()(TypeName const &value) const
+  {
+    return detail::hash_underlying<typename underlying_type<TypeName>::type>()(get(value));
+  }
+};
+
+namespace detail {
+
+// structures that split a hash into several fields need all 64 bits, so mix again where
+// std::size_t is narrower
+template<class TypeName>
+std::uint64_t hash64(TypeName const &value)
+{
+  auto const result = static_cast<std::uint64_t>(hash<TypeName>()(value));
+  return sizeof(std::size_t) >= sizeof(std::uint64_t) ? result : mix(result);
+}
+
+}
+
+}
+
+#endif //STRONG_HASH_HPP
@@ -0,0 +1,289 @@
+#ifndef STRONG_INDIRECT_VIEW_HPP
+#define STRONG_INDIRECT_VIEW_HPP
+
+#include <strong.hpp>
+#include <strong/vector.hpp>
+
+#include <cstddef>
+#include <iterator>
+
+namespace strong {
+
+/**
+ * The number of elements ahead of the current one that indirect_range prefetches by default.
+ *
+ * Around 16 to 32 elements is enough to cover a main memory access on current hardware without
+ * evicting lines before they are used; tune per workload with the Distance parameter.
+ */
+constexpr std::size_t default_prefetch_distance = 16;
+
+namespace detail {
+
+template<typename T>
+inline void prefetch(T const *address) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address, 0, 3);
+#else
+  (void)address;
+#endif
+}
+
+template<typename T>
+inline void prefetch_for_write(T const *address) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(address, 1, 3);
+#else
+  (void)address;
+#endif
+}
+
+}
+
+/**
+ * A view of the values selected by a sequence of strong IDs, i.e. values[ids[i]].
+ *
+ * Random accesses through IDs are limited by memory latency rather than bandwidth. Iterating over
+ * the view issues a software prefetch for the value Distance positions ahead, so that many cache
+ * misses are in flight at once instead of one at a time. The view does not own the values or the
+ * IDs.
+ *
+ * @tparam Id A strong typedef whose underlying type is a non-negative integer.
+ * @tparam T The type of the values.
+ * @tparam Distance How many IDs ahead of the current one to prefetch; 0 disables prefetching.
+ */
+template<class Id, typename T, std::size_t Distance = default_prefetch_distance>
+class indirect_range {
+public:
+  using size_type = std::size_t;
+  using value_type = T;
+
+  /**
+   * An iterator that prefetches ahead as it advances.
+   */
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    iterator() = default;
+
+    iterator(T *values, Id const *id, Id const *last) noexcept : values(values), id(id), last(last)
+    {
+    }
+
+    reference operator*() const noexcept
+    {
+      return values[static_cast<size_type>(get(*id))];
+    }
+
+    pointer operator->() const noexcept
+    {
+      return &**this;
+    }
+
+    iterator & operator++() noexcept
+    {
+      if(Distance > 0 && static_cast<size_type>(last - id) > Distance) {
+        detail::prefetch(values + static_cast<size_type>(get(id[Distance])));
+      }
+      ++id;
+      return *this;
+    }
+
+    iterator operator++(int) noexcept
+    {
+      auto copy = *this;
+      ++(*this);
+      return copy;
+    }
+
+    /**
+     * @return The ID that the iterator refers to.
+     */
+    Id const & index() const noexcept
+    {
+      return *id;
+    }
+
+    friend bool operator==(iterator const &lhs, iterator const &rhs) noexcept
+    {
+      return lhs.id == rhs.id;
+    }
+
+    friend bool operator!=(iterator const &lhs, iterator const &rhs) noexcept
+    {
+      return lhs.id != rhs.id;
+    }
+
+  private:
+    T *values = nullptr;
+    Id const *id = nullptr;
+    Id const *last = nullptr;
+  };
+
+  /**
+   * Construct a view from raw arrays.
+   *
+   * @param values The values, indexed by the underlying value of an ID.
+   * @param ids The IDs that select values.
+   * @param count The number of IDs.
+   */
+  indirect_range(T *values, Id const *ids, size_type count) noexcept : values(values), ids(ids), count(count)
+  {
+  }
+
+  /**
+   * @return The number of selected values.
+   */
+  size_type size() const noexcept
+  {
+    return count;
+  }
+
+  /**
+   * @param position A position less than size().
+   * @return The value selected by the ID at the position.
+   */
+  T & operator[](size_type position) const noexcept
+  {
+    return values[static_cast<size_type>(get(ids[position]))];
+  }
+
+  /**
+   * @return An iterator to the first selected value, with the first values already prefetched.
+   */
+  iterator begin() const noexcept
+  {
+    if(Distance > 0) {
+      for(size_type i = 0; i < Distance && i < count; ++i) {
+        detail::prefetch(values + static_cast<size_type>(get(ids[i])));
+      }
+    }
+    return iterator(values, ids, ids + count);
+  }
+
+  /**
+   * @return An iterator past the last selected value.
+   */
+  iterator end() const noexcept
+  {
+    return iterator(values, ids + count, ids + count);
+  }
+
+  /**
+   * Copy the selected values into a contiguous output (values[ids[i]] to output[i]).
+   *
+   * Works in blocks: the prefetches for a later block are issued first, followed by a fixed-size
+   * copy loop with no calls in it, which the compiler can vectorize with gather instructions on
+   * targets that have them (e.g. -mavx2 or -mavx512f).
+   *
+   * @param output Receives size() values.
+   */
+  template<typename Output>
+  void gather(Output *output) const noexcept
+  {
+    size_type i = 0;
+    if(Distance > 0) {
+      for(; i + Distance + block <= count; i += block) {
+        for(size_type j = 0; j < block; ++j) {
+          detail::prefetch(values + static_cast<size_type>(get(ids[i + Distance + j])));
+        }
+        for(size_type j = 0; j < block; ++j) {
+          output[i + j] = values[static_cast<size_type>(get(ids[i + j]))];
+        }
+      }
+    }
+    for(; i < count; ++i) {
+      output[i] = values[static_cast<size_type>(get(ids[i]))];
+    }
+  }
+
+  /**
+   * Write contiguous inputs to the selected values (input[i] to values[ids[i]]).
+   *
+   * If an ID appears more than once, the last input written to it wins.
+   *
+   * @param input Provides size() values.
+   */
+  template<typename Input>
+  void scatter(Input const *input) const noexcept
+  {
+    size_type i = 0;
+    if(Distance > 0 && count > Distance) {
+      for(; i < count - Distance; ++i) {
+        detail::prefetch_for_write(values + static_cast<size_type>(get(ids[i + Distance])));
+        values[static_cast<size_type>(get(ids[i]))] = input[i];
+      }
+    }
+    for(; i < count; ++i) {
+      values[static_cast<size_type>(get(ids[i]))] = input[i];
+    }
+  }
+
+  /**
+   * Apply a function to each selected value in turn.
+   *
+   * @param function Called as function(value) for each selected value.
+   */
+  template<class Function>
+  void for_each(Function function) const
+  {
+    size_type i = 0;
+    if(Distance > 0 && count > Distance) {
+      for(; i < count - Distance; ++i) {
+        detail::prefetch(values + static_cast<size_type>(get(ids[i + Distance])));
+        function(values[static_cast<size_type>(get(ids[i]))]);
+      }
+    }
+    for(; i < count; ++i) {
+      function(values[static_cast<size_type>(get(ids[i]))]);
+    }
+  }
+
+private:
+  static constexpr size_type block = 8;
+
+  T *values;
+  Id const *ids;
+  size_type count;
+};
+
+template<class Id, typename T, std::size_t Distance>
+constexpr typename indirect_range<Id, T, Distance>::size_type indirect_range<Id, T, Distance>::block;
+
+/**
+ * Create a view of the values selected by a sequence of strong IDs.
+ *
+ * @tparam Distance How many IDs ahead of the current one to prefetch.
+ * @param values The array of values, indexed by Id.
+ * @param ids A contiguous container of IDs (e.g. std::vector<Id>).
+ * @return A range over values[ids[i]].
+ */
+template<std::size_t Distance = default_prefetch_distance, class Id, typename T, class Allocator, class Ids>
+indirect_range<Id, T, Distance> indirect_view(vector<Id, T, Allocator> &values, Ids const &ids) noexcept
+{
+  return indirect_range<Id, T, Distance>(values.data(), ids.data(), ids.size());
+}
+
+/**
+ * Create a read-only view of the values selected by a sequence of strong IDs.
+ *
+ * @tparam Distance How many IDs ahead of the current one to prefetch.
+ * @param values The array of values, indexed by Id.
+ * @param ids A contiguous container of IDs (e.g. std::vector<Id>).
+ * @return A range over values[ids[i]].
+ */
+template<std::size_t Distance = default_prefetch_distance, class Id, typename T, class Allocator, class Ids>
+indirect_range<Id, T const, Distance> indirect_view(vector<Id, T, Allocator> const &values, Ids const &ids) noexcept
+{
+  return indirect_range<Id, T const, Distance>(values.data(), ids.data(), ids.size());
+}
+
+}
+
+#endif //STRONG_INDIRECT_VIEW_HPP
@@ -0,0 +1,549 @@
+#ifndef STRONG_INTRUSIVE_HPP
+#define STRONG_INTRUSIVE_HPP
+
+#include <strong.hpp>
+#include <strong/hash.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace strong {
+
+/**
+ * The index that marks the absence of a link (e.g. the end of a list or an empty subtree).
+ *
+ * @tparam NodeId A strong typedef whose underlying type is an unsigned integer.
+ * @return The largest representable NodeId, which is reserved and cannot refer to a node.
+ */
+template<class NodeId>
+constexpr NodeId null_link() noexcept
+{
+  return NodeId(std::numeric_limits<typename underlying_type<NodeId>::type>::max());
+}
+
+/**
+ * Test whether a link refers to a node.
+ *
+ * @tparam NodeId A strong typedef whose underlying type is an unsigned integer.
+ * @param id The link to test.
+ * @return True if the link is not the null link.
+ */
+template<class NodeId>
+constexpr bool is_linked(NodeId const &id) noexcept
+{
+  return get(id) != get(null_link<NodeId>());
+}
+
+namespace detail {
+
+template<class NodeId>
+constexpr bool same_link(NodeId const &lhs, NodeId const &rhs) noexcept
+{
+  return get(lhs) == get(rhs);
+}
+
+template<class NodeId>
+struct check_link {
+  static_assert(std::is_unsigned<typename underlying_type<NodeId>::type>::value,
+                "links require a strong typedef with an unsigned underlying type (e.g. std::uint32_t)");
+};
+
+}
+
+/**
+ * The links embedded in a node so that it can be a member of an intrusive_list.
+ *
+ * Links are indices into the array that stores the nodes rather than pointers. With a 32-bit
+ * underlying type, a hook is half the size of a pair of pointers, and because indices do not
+ * depend on where the array lives, nodes can be copied with memcpy or written to disk as-is.
+ *
+ * @tparam NodeId The strong index type of the nodes that are linked.
+ */
+template<class NodeId>
+struct list_hook {
+  NodeId prev = null_link<NodeId>();
+  NodeId next = null_link<NodeId>();
+};
+
+/**
+ * A doubly-linked list threaded through nodes stored in an indexable container.
+ *
+ * The list only stores the indices of its first and last nodes; the links live in a list_hook
+ * member of each node. Every operation takes the container of nodes (for example, a
+ * strong::vector<NodeId, Node>), which must be indexable by NodeId. A node can be a member of
+ * several lists at once by giving it one hook per list. Suitable for free lists and LRU chains.
+ *
+ * @tparam NodeId A strong typedef whose underlying type is an unsigned integer.
+ * @tparam Node The type of the nodes.
+ * @tparam Hook The member of Node that holds the links for this list.
+ */
+template<class NodeId, class Node, list_hook<NodeId> Node::*Hook>
+class intrusive_list : detail::check_link<NodeId> {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Link a node at the beginning of the list.
+   *
+   * @param nodes The container of nodes.
+   * @param id The node to link, which must not already be in the list.
+   */
+  template<class Nodes>
+  void push_front(Nodes &nodes, NodeId const &id)
+  {
+    insert(nodes, head, id);
+  }
+
+  /**
+   * Link a node at the end of the list.
+   *
+   * @param nodes The container of nodes.
+   * @param id The node to link, which must not already be in the list.
+   */
+  template<class Nodes>
+  void push_back(Nodes &nodes, NodeId const &id)
+  {
+    insert(nodes, null_link<NodeId>(), id);
+  }
+
+  /**
+   * Link a node before another node.
+   *
+   * @param nodes The container of nodes.
+   * @param position The node to insert before, or the null link to insert at the end.
+   * @param id The node to link, which must not already be in the list.
+   */
+  template<class Nodes>
+  void insert(Nodes &nodes, NodeId const &position, NodeId const &id)
+  {
+    auto &hook = nodes[id].*Hook;
+    hook.next = position;
+
+    if(is_linked(position)) {
+      auto &next = nodes[position].*Hook;
+      hook.prev = next.prev;
+      next.prev = id;
+    } else {
+      hook.prev = tail;
+      tail = id;
+    }
+
+    if(is_linked(hook.prev)) {
+      (nodes[hook.prev].*Hook).next = id;
+    } else {
+      head = id;
+    }
+
+    ++count;
+  }
+
+  /**
+   * Unlink a node from the list.
+   *
+   * @param nodes The container of nodes.
+   * @param id The node to unlink, which must be in the list.
+   */
+  template<class Nodes>
+  void erase(Nodes &nodes, NodeId const &id)
+  {
+    auto &hook = nodes[id].*Hook;
+
+    if(is_linked(hook.prev)) {
+      (nodes[hook.prev].*Hook).next = hook.next;
+    } else {
+      head = hook.next;
+    }
+
+    if(is_linked(hook.next)) {
+      (nodes[hook.next].*Hook).prev = hook.prev;
+    } else {
+      tail = hook.prev;
+    }
+
+    hook.prev = null_link<NodeId>();
+    hook.next = null_link<NodeId>();
+    --count;
+  }
+
+  /**
+   * Unlink the first node of the list.
+   *
+   * @param nodes The container of nodes.
+   * @return The unlinked node, or the null link if the list was empty.
+   */
+  template<class Nodes>
+  NodeId pop_front(Nodes &nodes)
+  {
+    auto const id = head;
+    if(is_linked(id)) {
+      erase(nodes, id);
+    }
+    return id;
+  }
+
+  /**
+   * Unlink the last node of the list.
+   *
+   * @param nodes The container of nodes.
+   * @return The unlinked node, or the null link if the list was empty.
+   */
+  template<class Nodes>
+  NodeId pop_back(Nodes &nodes)
+  {
+    auto const id = tail;
+    if(is_linked(id)) {
+      erase(nodes, id);
+    }
+    return id;
+  }
+
+  /**
+   * Move a node that is already in the list to the beginning of the list.
+   *
+   * @param nodes The container of nodes.
+   * @param id The node to move.
+   */
+  template<class Nodes>
+  void move_to_front(Nodes &nodes, NodeId const &id)
+  {
+    if(!detail::same_link(head, id)) {
+      erase(nodes, id);
+      push_front(nodes, id);
+    }
+  }
+
+  /**
+   * Visit each node from the beginning to the end of the list.
+   *
+   * The function may unlink the node it is visiting, but no other node.
+   *
+   * @param nodes The container of nodes.
+   * @param function Called as function(id) for each node.
+   */
+  template<class Nodes, class Function>
+  void for_each(Nodes &nodes, Function function) const
+  {
+    for(auto id = head; is_linked(id);) {
+      auto const next = (nodes[id].*Hook).next;
+      function(id);
+      id = next;
+    }
+  }
+
+  /**
+   * @param nodes The container of nodes.
+   * @param id A node in the list.
+   * @return The node after id, or the null link if id is the last node.
+   */
+  template<class Nodes>
+  static NodeId next(Nodes const &nodes, NodeId const &id)
+  {
+    return (nodes[id].*Hook).next;
+  }
+
+  /**
+   * @param nodes The container of nodes.
+   * @param id A node in the list.
+   * @return The node before id, or the null link if id is the first node.
+   */
+  template<class Nodes>
+  static NodeId prev(Nodes const &nodes, NodeId const &id)
+  {
+    return (nodes[id].*Hook).prev;
+  }
+
+  /**
+   * @return The first node, or the null link if the list is empty.
+   */
+  NodeId front() const noexcept
+  {
+    return head;
+  }
+
+  /**
+   * @return The last node, or the null link if the list is empty.
+   */
+  NodeId back() const noexcept
+  {
+    return tail;
+  }
+
+  /**
+   * @return The number of nodes in the list.
+   */
+  size_type size() const noexcept
+  {
+    return count;
+  }
+
+  /**
+   * @return True if the list has no nodes.
+   */
+  bool empty() const noexcept
+  {
+    return count == 0;
+  }
+
+private:
+  NodeId head = null_link<NodeId>();
+  NodeId tail = null_link<NodeId>();
+  size_type count = 0;
+};
+
+/**
+ * The links embedded in a node so that it can be a member of an intrusive_tree.
+ *
+ * @tparam NodeId The strong index type of the nodes that are linked.
+ */
+template<class NodeId>
+struct tree_hook {
+  NodeId left = null_link<NodeId>();
+  NodeId right = null_link<NodeId>();
+};
+
+/**
+ * A balanced binary search tree threaded through nodes stored in an indexable container.
+ *
+ * The tree is a treap whose priorities are a hash of each node's index, so a hook only needs the
+ * two child links. Keys are unique and extracted from a node with KeyOf; they are compared with
+ * operator<. As with intrusive_list, every operation takes the container of nodes.
+ *
+ * @tparam NodeId A strong typedef whose underlying type is an unsigned integer.
+ * @tparam Node The type of the nodes.
+ * @tparam Hook The member of Node that holds the links for this tree.
+ * @tparam KeyOf A function object that returns the key of a node.
+ */
+template<class NodeId, class Node, tree_hook<NodeId> Node::*Hook, class KeyOf>
+class intrusive_tree : detail::check_link<NodeId> {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Link a node into the tree.
+   *
+   * @param nodes The container of nodes.
+   * @param id The node to link, which must not already be in the tree.
+   * @return True if the node was linked, false if a node with an equal key is already present.
+   */
+  template<class Nodes>
+  bool insert(Nodes &nodes, NodeId const &id)
+  {
+    auto &hook = nodes[id].*Hook;
+    hook.left = null_link<NodeId>();
+    hook.right = null_link<NodeId>();
+
+    if(!insert(nodes, root, id)) {
+      return false;
+    }
+
+    ++count;
+    return true;
+  }
+
+  /**
+   * Unlink a node from the tree.
+   *
+   * @param nodes The container of nodes.
+   * @param id The node to unlink.
+   * @return True if the node was unlinked, false if it was not in the tree.
+   */
+  template<class Nodes>
+  bool erase(Nodes &nodes, NodeId const &id)
+  {
+    auto const &key = KeyOf()(nodes[id]);
+
+    auto *link = &root;
+    while(is_linked(*link) && !detail::same_link(*link, id)) {
+      auto &hook = nodes[*link].*Hook;
+      link = key < KeyOf()(nodes[*link]) ? &hook.left : &hook.right;
+    }
+
+    if(!is_linked(*link)) {
+      return false;
+    }
+
+    // rotate the node down until it has at most one child, then splice it out
+    for(;;) {
+      auto &hook = nodes[id].*Hook;
+      if(!is_linked(hook.left)) {
+        *link = hook.right;
+        break;
+      }
+      if(!is_linked(hook.right)) {
+        *link = hook.left;
+        break;
+      }
+
+      if(priority(hook.left) > priority(hook.right)) {
+        rotate_right(nodes, *link);
+        link = &(nodes[*link].*Hook).right;
+      } else {
+        rotate_left(nodes, *link);
+        link = &(nodes[*link].*Hook).left;
+      }
+    }
+
+    auto &hook = nodes[id].*Hook;
+    hook.left = null_link<NodeId>();
+    hook.right = null_link<NodeId>();
+    --count;
+    return true;
+  }
+
+  /**
+   * Find the node with a key.
+   *
+   * @param nodes The container of nodes.
+   * @param key The key to look for.
+   * @return The node with an equal key, or the null link if there is none.
+   */
+  template<class Nodes, typename Key>
+  NodeId find(Nodes const &nodes, Key const &key) const
+  {
+    auto id = lower_bound(nodes, key);
+    if(is_linked(id) && key < KeyOf()(nodes[id])) {
+      return null_link<NodeId>();
+    }
+    return id;
+  }
+
+  /**
+   * Find the node with the smallest key that is not less than a key.
+   *
+   * @param nodes The container of nodes.
+   * @param key The key to look for.
+   * @return The node, or the null link if every key is less than the given key.
+   */
+  template<class Nodes, typename Key>
+  NodeId lower_bound(Nodes const &nodes, Key const &key) const
+  {
+    auto result = null_link<NodeId>();
+    for(auto id = root; is_linked(id);) {
+      auto const &hook = nodes[id].*Hook;
+      if(KeyOf()(nodes[id]) < key) {
+        id = hook.right;
+      } else {
+        result = id;
+        id = hook.left;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Visit each node in ascending order of key.
+   *
+   * The function must not link or unlink nodes.
+   *
+   * @param nodes The container of nodes.
+   * @param function Called as function(id) for each node.
+   */
+  template<class Nodes, class Function>
+  void for_each(Nodes &nodes, Function function) const
+  {
+    for_each(nodes, root, function);
+  }
+
+  /**
+   * @return The root node, or the null link if the tree is empty.
+   */
+  NodeId top() const noexcept
+  {
+    return root;
+  }
+
+  /**
+   * @return The number of nodes in the tree.
+   */
+  size_type size() const noexcept
+  {
+    return count;
+  }
+
+  /**
+   * @return True if the tree has no nodes.
+   */
+  bool empty() const noexcept
+  {
+    return count == 0;
+  }
+
+private:
+  static std::uint64_t priority(NodeId const &id) noexcept
+  {
+    return mix(static_cast<std::uint64_t>(get(id)));
+  }
+
+  template<class Nodes>
+  static void rotate_right(Nodes &nodes, NodeId &link)
+  {
+    auto const id = link;
+    auto const child = (nodes[id].*Hook).left;
+    (nodes[id].*Hook).left = (nodes[child].*Hook).right;
+    (nodes[child].*Hook).right = id;
+    link = child;
+  }
+
+  template<class Nodes>
+  static void rotate_left(Nodes &nodes, NodeId &link)
+  {
+    auto const id = link;
+    auto const child = (nodes[id].*Hook).right;
+    (nodes[id].*Hook).right = (nodes[child].*Hook).left;
+    (nodes[child].*Hook).left = id;
+    link = child;
+  }
+
+  template<class Nodes>
+  static bool insert(Nodes &nodes, NodeId &link, NodeId const &id)
+  {
+    if(!is_linked(link)) {
+      link = id;
+      return true;
+    }
+
+    auto const &key = KeyOf()(nodes[id]);
+    auto const &current = KeyOf()(nodes[link]);
+    auto &hook = nodes[link].*Hook;
+
+    if(key < current) {
+      if(!insert(nodes, hook.left, id)) {
+        return false;
+      }
+      if(priority(hook.left) > priority(link)) {
+        rotate_right(nodes, link);
+      }
+    } else if(current < key) {
+      if(!insert(nodes, hook.right, id)) {
+        return false;
+      }
+      if(priority(hook.right) > priority(link)) {
+        rotate_left(nodes, link);
+      }
+    } else {
+      return false;
+    }
+
+    return true;
+  }
+
+  template<class Nodes, class Function>
+  static void for_each(Nodes &nodes, NodeId const &id, Function &function)
+  {
+    if(is_linked(id)) {
+      auto const &hook = nodes[id].*Hook;
+      for_each(nodes, hook.left, function);
+      function(id);
+      for_each(nodes, hook.right, function);
+    }
+  }
+
+  NodeId root = null_link<NodeId>();
+  size_type count = 0;
+};
+
+}
+
+#endif //STRONG_INTRUSIVE_HPP
@@ -0,0 +1,99 @@
+#ifndef STRONG_MAPPED_FILE_HPP
+#define STRONG_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace strong {
+
+namespace detail {
+
+// A read-only view of a whole file: mapped into memory where the platform supports it, and read
+// into a buffer otherwise.
+class mapped_file {
+public:
+  mapped_file(std::string const &path, char const *who)
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    auto const descriptor = ::open(path.c_str(), O_RDONLY);
+    if(descriptor < 0) {
+      throw std::runtime_error(std::string(who) + ": cannot open " + path);
+    }
+    struct stat status;
+    if(::fstat(descriptor, &status) != 0) {
+      ::close(descriptor);
+      throw std::runtime_error(std::string(who) + ": cannot read " + path);
+    }
+    length = static_cast<std::size_t>(status.st_size);
+    if(length != 0) {
+      address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    }
+    ::close(descriptor);
+    if(address == MAP_FAILED) {
+      address = nullptr;
+      throw std::runtime_error(std::string(who) + ": cannot map " + path);
+    }
+#else
+    std::ifstream file(path, std::ios::binary);
+    if(!file) {
+      throw std::runtime_error(std::string(who) + ": cannot open " + path);
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+#endif
+  }
+
+  mapped_file(mapped_file const &) = delete;
+  mapped_file & operator=(mapped_file const &) = delete;
+
+  ~mapped_file()
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    if(address != nullptr) {
+      ::munmap(address, length);
+    }
+#endif
+  }
+
+  unsigned char const * data() const noexcept
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    return static_cast<unsigned char const *>(address);
+#else
+    return contents.data();
+#endif
+  }
+
+  std::size_t size() const noexcept
+  {
+#if defined(__unix__) || defined(__APPLE__)
+    return length;
+#else
+    return contents.size();
+#endif
+  }
+
+private:
+#if defined(__unix__) || defined(__APPLE__)
+  void *address = nullptr;
+  std::size_t length = 0;
+#else
+  std::vector<unsigned char> contents;
+#endif
+};
+
+}
+
+}
+
+#endif //STRONG_MAPPED_FILE_HPP
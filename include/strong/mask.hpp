@@ -0,0 +1,582 @@
+#ifndef STRONG_MASK_HPP
+#define STRONG_MASK_HPP
+
+#include <strong.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace strong {
+
+namespace detail {
+
+inline unsigned count_bits(std::uint64_t word) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_popcountll(word));
+#else
+  unsigned count = 0;
+  for(; word != 0; word &= word - 1) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+inline unsigned lowest_bit(std::uint64_t word) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+  unsigned position = 0;
+  for(; (word & 1) == 0; word >>= 1) {
+    ++position;
+  }
+  return position;
+#endif
+}
+
+struct equal_to {
+  template<class TypeName>
+  bool operator()(TypeName const &lhs, TypeName const &rhs) const
+  {
+    return static_cast<bool>(lhs == rhs);
+  }
+};
+
+struct not_equal_to {
+  template<class TypeName>
+  bool operator()(TypeName const &lhs, TypeName const &rhs) const
+  {
+    return static_cast<bool>(lhs != rhs);
+  }
+};
+
+struct less {
+  template<class TypeName>
+  bool operator()(TypeName const &lhs, TypeName const &rhs) const
+  {
+    return static_cast<bool>(lhs < rhs);
+  }
+};
+
+struct less_equal {
+  template<class TypeName>
+  bool operator()(TypeName const &lhs, TypeName const &rhs) const
+  {
+    return static_cast<bool>(lhs <= rhs);
+  }
+};
+
+struct greater {
+  template<class TypeName>
+  bool operator()(TypeName const &lhs, TypeName const &rhs) const
+  {
+    return static_cast<bool>(lhs > rhs);
+  }
+};
+
+struct greater_equal {
+  template<class TypeName>
+  bool operator()(TypeName const &lhs, TypeName const &rhs) const
+  {
+    return static_cast<bool>(lhs >= rhs);
+  }
+};
+
+// Compare up to 64 pairs into the bits of a word. There is no branch on the outcome, so the
+// compiler can vectorize the comparisons and pack the results.
+template<class TypeName, class Compare>
+std::uint64_t compare_word(TypeName const *lhs, TypeName const *rhs, std::size_t count, Compare compare)
+{
+  std::uint64_t word = 0;
+  for(std::size_t i = 0; i < count; ++i) {
+    word |= static_cast<std::uint64_t>(compare(lhs[i], rhs[i])) << i;
+  }
+  return word;
+}
+
+template<class TypeName, class Compare>
+std::uint64_t compare_word(TypeName const *lhs, TypeName const &rhs, std::size_t count, Compare compare)
+{
+  std::uint64_t word = 0;
+  for(std::size_t i = 0; i < count; ++i) {
+    word |= static_cast<std::uint64_t>(compare(lhs[i], rhs)) << i;
+  }
+  return word;
+}
+
+// The right-hand side of a batch comparison is either an array or a single value to compare with
+// every element. The template argument is given explicitly so that raw arrays pick the first.
+template<class TypeName>
+TypeName const * offset(TypeName const *values, std::size_t first) noexcept
+{
+  return values + first;
+}
+
+template<class TypeName>
+TypeName const & offset(TypeName const &value, std::size_t) noexcept
+{
+  return value;
+}
+
+template<class TypeName, class Rhs, class Compare>
+std::size_t compare_span(TypeName const *lhs, Rhs const &rhs, std::size_t count, std::uint64_t *bits, Compare compare)
+{
+  std::size_t selected = 0;
+  for(std::size_t first = 0; first < count; first += 64) {
+    auto const size = count - first < 64 ? count - first : 64;
+    auto const word = compare_word(lhs + first, offset<TypeName>(rhs, first), size, compare);
+    bits[first / 64] = word;
+    selected += count_bits(word);
+  }
+  return selected;
+}
+
+}
+
+/**
+ * A fixed-size set of bits packed into 64-bit words, holding the outcome of N comparisons.
+ *
+ * Bit i of the mask is stored in bit i % 64 of word i / 64, and the bits past N in the last word
+ * are always zero. The batch comparisons fill masks without branching on each outcome, and the
+ * set bits can then be visited in order to filter the compared values.
+ *
+ * @tparam N The number of bits.
+ */
+template<std::size_t N>
+class mask {
+public:
+  static_assert(N > 0, "a mask needs at least one bit");
+
+  /**
+   * The number of 64-bit words that hold the bits.
+   */
+  static constexpr std::size_t word_count = (N + 63) / 64;
+
+  /**
+   * Construct a mask with no bits set.
+   */
+  mask() noexcept : words()
+  {
+  }
+
+  /**
+   * @return The number of bits, N.
+   */
+  static constexpr std::size_t size() noexcept
+  {
+    return N;
+  }
+
+  /**
+   * @param position The position of the bit, which must be less than N.
+   * @return Whether the bit is set.
+   */
+  bool test(std::size_t position) const noexcept
+  {
+    return (words[position / 64] >> (position % 64)) & 1;
+  }
+
+  /**
+   * Set or clear a bit.
+   *
+   * @param position The position of the bit, which must be less than N.
+   * @param value Whether to set the bit.
+   */
+  void set(std::size_t position, bool value = true) noexcept
+  {
+    auto const bit = std::uint64_t(1) << (position % 64);
+    words[position / 64] = (words[position / 64] & ~bit) | (static_cast<std::uint64_t>(value) << (position % 64));
+  }
+
+  /**
+   * @return The number of bits set.
+   */
+  std::size_t count() const noexcept
+  {
+    std::size_t total = 0;
+    for(auto const word : words) {
+      total += detail::count_bits(word);
+    }
+    return total;
+  }
+
+  /**
+   * @return Whether any bit is set.
+   */
+  bool any() const noexcept
+  {
+    std::uint64_t combined = 0;
+    for(auto const word : words) {
+      combined |= word;
+    }
+    return combined != 0;
+  }
+
+  /**
+   * @return Whether no bit is set.
+   */
+  bool none() const noexcept
+  {
+    return !any();
+  }
+
+  /**
+   * @return Whether every bit is set.
+   */
+  bool all() const noexcept
+  {
+    return count() == N;
+  }
+
+  /**
+   * Call a function with the position of each set bit, in increasing order.
+   *
+   * @param function Called as function(position) for each set bit.
+   */
+  template<class Function>
+  void for_each(Function function) const
+  {
+    for(std::size_t i = 0; i < word_count; ++i) {
+      for(auto word = words[i]; word != 0; word &= word - 1) {
+        function(i * 64 + detail::lowest_bit(word));
+      }
+    }
+  }
+
+  /**
+   * Write the positions of the set bits, in increasing order.
+   *
+   * @param output Receives the positions; must have room for count() of them.
+   * @return The end of the output.
+   */
+  template<class OutputIt>
+  OutputIt select(OutputIt output) const
+  {
+    for_each([&output](std::size_t position) {
+      *output = position;
+      ++output;
+    });
+    return output;
+  }
+
+  /**
+   * @return The words that hold the bits.
+   */
+  std::uint64_t const * data() const noexcept
+  {
+    return words;
+  }
+
+  /**
+   * @return The words that hold the bits. The bits past N must be left clear.
+   */
+  std::uint64_t * data() noexcept
+  {
+    return words;
+  }
+
+  friend mask operator&(mask const &lhs, mask const &rhs) noexcept
+  {
+    mask result;
+    for(std::size_t i = 0; i < word_count; ++i) {
+      result.words[i] = lhs.words[i] & rhs.words[i];
+    }
+    return result;
+  }
+
+  friend mask operator|(mask const &lhs, mask const &rhs) noexcept
+  {
+    mask result;
+    for(std::size_t i = 0; i < word_count; ++i) {
+      result.words[i] = lhs.words[i] | rhs.words[i];
+    }
+    return result;
+  }
+
+  friend mask operator^(mask const &lhs, mask const &rhs) noexcept
+  {
+    mask result;
+    for(std::size_t i = 0; i < word_count; ++i) {
+      result.words[i] = lhs.words[i] ^ rhs.words[i];
+    }
+    return result;
+  }
+
+  friend mask operator~(mask const &value) noexcept
+  {
+    mask result;
+    for(std::size_t i = 0; i < word_count; ++i) {
+      result.words[i] = ~value.words[i];
+    }
+    result.words[word_count - 1] &= last_word;
+    return result;
+  }
+
+  mask & operator&=(mask const &rhs) noexcept
+  {
+    return *this = *this & rhs;
+  }
+
+  mask & operator|=(mask const &rhs) noexcept
+  {
+    return *this = *this | rhs;
+  }
+
+  mask & operator^=(mask const &rhs) noexcept
+  {
+    return *this = *this ^ rhs;
+  }
+
+  friend bool operator==(mask const &lhs, mask const &rhs) noexcept
+  {
+    std::uint64_t difference = 0;
+    for(std::size_t i = 0; i < word_count; ++i) {
+      difference |= lhs.words[i] ^ rhs.words[i];
+    }
+    return difference == 0;
+  }
+
+  friend bool operator!=(mask const &lhs, mask const &rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+private:
+  static constexpr std::uint64_t last_word = N % 64 == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << (N % 64)) - 1;
+
+  std::uint64_t words[word_count];
+};
+
+template<std::size_t N>
+constexpr std::size_t mask<N>::word_count;
+
+template<std::size_t N>
+constexpr std::uint64_t mask<N>::last_word;
+
+/**
+ * Comparisons of many strong values at once, giving a bit per comparison.
+ *
+ * Each function compares lhs[i] with rhs[i], or with the single value rhs, through the operators
+ * of the strong typedef, so they are only available for types that enable the comparison (e.g.
+ * with op::orders), whatever Result those operators return. The outcomes are packed into bits
+ * without a branch per element: either a mask<N> for a fixed batch of N values, or the words of a
+ * caller's buffer for a span of any length, laid out like a mask.
+ */
+namespace batch {
+
+/**
+ * Compare a batch of strong values for equality.
+ *
+ * @tparam N The number of values to compare.
+ * @param lhs The first of N values on the left-hand side.
+ * @param rhs The first of N values on the right-hand side, or the single value to compare with.
+ * @return Bit i is set if lhs[i] equals rhs[i].
+ */
+template<std::size_t N, class TypeName, class Rhs>
+mask<N> equal(TypeName const *lhs, Rhs const &rhs)
+{
+  mask<N> result;
+  detail::compare_span(lhs, rhs, N, result.data(), detail::equal_to());
+  return result;
+}
+
+/**
+ * Compare a batch of strong values for inequality.
+ *
+ * @tparam N The number of values to compare.
+ * @param lhs The first of N values on the left-hand side.
+ * @param rhs The first of N values on the right-hand side, or the single value to compare with.
+ * @return Bit i is set if lhs[i] does not equal rhs[i].
+ */
+template<std::size_t N, class TypeName, class Rhs>
+mask<N> not_equal(TypeName const *lhs, Rhs const &rhs)
+{
+  mask<N> result;
+  detail::compare_span(lhs, rhs, N, result.data(), detail::not_equal_to());
+  return result;
+}
+
+/**
+ * Compare a batch of strong values with <.
+ *
+ * @tparam N The number of values to compare.
+ * @param lhs The first of N values on the left-hand side.
+ * @param rhs The first of N values on the right-hand side, or the single value to compare with.
+ * @return Bit i is set if lhs[i] < rhs[i].
+ */
+template<std::size_t N, class TypeName, class Rhs>
+mask<N> less(TypeName const *lhs, Rhs const &rhs)
+{
+  mask<N> result;
+  detail::compare_span(lhs, rhs, N, result.data(), detail::less());
+  return result;
+}
+
+/**
+ * Compare a batch of strong values with <=.
+ *
+ * @tparam N The number of values to compare.
+ * @param lhs The first of N values on the left-hand side.
+ * @param rhs The first of N values on the right-hand side, or the single value to compare with.
+ * @return Bit i is set if lhs[i] <= rhs[i].
+ */
+template<std::size_t N, class TypeName, class Rhs>
+mask<N> less_equal(TypeName const *lhs, Rhs const &rhs)
+{
+  mask<N> result;
+  detail::compare_span(lhs, rhs, N, result.data(), detail::less_equal());
+  return result;
+}
+
+/**
+ * Compare a batch of strong values with >.
+ *
+ * @tparam N The number of values to compare.
+ * @param lhs The first of N values on the left-hand side.
+ * @param rhs The first of N values on the right-hand side, or the single value to compare with.
+ * @return Bit i is set if lhs[i] > rhs[i].
+ */
+template<std::size_t N, class TypeName, class Rhs>
+mask<N> greater(TypeName const *lhs, Rhs const &rhs)
+{
+  mask<N> result;
+  detail::compare_span(lhs, rhs, N, result.data(), detail::greater());
+  return result;
+}
+
+/**
+ * Compare a batch of strong values with >=.
+ *
+ * @tparam N The number of values to compare.
+ * @param lhs The first of N values on the left-hand side.
+ * @param rhs The first of N values on the right-hand side, or the single value to compare with.
+ * @return Bit i is set if lhs[i] >= rhs[i].
+ */
+template<std::size_t N, class TypeName, class Rhs>
+mask<N> greater_equal(TypeName const *lhs, Rhs const &rhs)
+{
+  mask<N> result;
+  detail::compare_span(lhs, rhs, N, result.data(), detail::greater_equal());
+  return result;
+}
+
+/**
+ * Compare a span of strong values for equality.
+ *
+ * @param lhs The first of count values on the left-hand side.
+ * @param rhs The first of count values on the right-hand side, or the single value to compare with.
+ * @param count The number of values to compare.
+ * @param bits Receives bit i set if lhs[i] equals rhs[i]; must have room for (count + 63) / 64 words.
+ * @return The number of bits set.
+ */
+template<class TypeName, class Rhs>
+std::size_t equal(TypeName const *lhs, Rhs const &rhs, std::size_t count, std::uint64_t *bits)
+{
+  return detail::compare_span(lhs, rhs, count, bits, detail::equal_to());
+}
+
+/**
+ * Compare a span of strong values for inequality.
+ *
+ * @param lhs The first of count values on the left-hand side.
+ * @param rhs The first of count values on the right-hand side, or the single value to compare with.
+ * @param count The number of values to compare.
+ * @param bits Receives bit i set if lhs[i] does not equal rhs[i]; must have room for (count + 63) / 64 words.
+ * @return The number of bits set.
+ */
+template<class TypeName, class Rhs>
+std::size_t not_equal(TypeName const *lhs, Rhs const &rhs, std::size_t count, std::uint64_t *bits)
+{
+  return detail::compare_span(lhs, rhs, count, bits, detail::not_equal_to());
+}
+
+/**
+ * Compare a span of strong values with <.
+ *
+ * @param lhs The first of count values on the left-hand side.
+ * @param rhs The first of count values on the right-hand side, or the single value to compare with.
+ * @param count The number of values to compare.
+ * @param bits Receives bit i set if lhs[i] < rhs[i]; must have room for (count + 63) / 64 words.
+ * @return The number of bits set.
+ */
+template<class TypeName, class Rhs>
+std::size_t less(TypeName const *lhs, Rhs const &rhs, std::size_t count, std::uint64_t *bits)
+{
+  return detail::compare_span(lhs, rhs, count, bits, detail::less());
+}
+
+/**
+ * Compare a span of strong values with <=.
+ *
+ * @param lhs The first of count values on the left-hand side.
+ * @param rhs The first of count values on the right-hand side, or the single value to compare with.
+ * @param count The number of values to compare.
+ * @param bits Receives bit i set if lhs[i] <= rhs[i]; must have room for (count + 63) / 64 words.
+ * @return The number of bits set.
+ */
+template<class TypeName, class Rhs>
+std::size_t less_equal(TypeName const *lhs, Rhs const &rhs, std::size_t count, std::uint64_t *bits)
+{
+  return detail::compare_span(lhs, rhs, count, bits, detail::less_equal());
+}
+
+/**
+ * Compare a span of strong values with >.
+ *
+ * @param lhs The first of count values on the left-hand side.
+ * @param rhs The first of count values on the right-hand side, or the single value to compare with.
+ * @param count The number of values to compare.
+ * @param bits Receives bit i set if lhs[i] > rhs[i]; must have room for (count + 63) / 64 words.
+ * @return The number of bits set.
+ */
+template<class TypeName, class Rhs>
+std::size_t greater(TypeName const *lhs, Rhs const &rhs, std::size_t count, std::uint64_t *bits)
+{
+  return detail::compare_span(lhs, rhs, count, bits, detail::greater());
+}
+
+/**
+ * Compare a span of strong values with >=.
+ *
+ * @param lhs The first of count values on the left-hand side.
+ * @param rhs The first of count values on the right-hand side, or the single value to compare with.
+ * @param count The number of values to compare.
+ * @param bits Receives bit i set if lhs[i] >= rhs[i]; must have room for (count + 63) / 64 words.
+ * @return The number of bits set.
+ */
+template<class TypeName, class Rhs>
+std::size_t greater_equal(TypeName const *lhs, Rhs const &rhs, std::size_t count, std::uint64_t *bits)
+{
+  return detail::compare_span(lhs, rhs, count, bits, detail::greater_equal());
+}
+
+/**
+ * Write the positions of the set bits of a span comparison, in increasing order.
+ *
+ * Together with a span comparison this turns a filter into a selection vector, e.g. the positions
+ * of the values under a threshold, without a branch per value.
+ *
+ * @param bits The words written by a span comparison.
+ * @param count The number of values that were compared.
+ * @param output Receives the positions; must have room for as many as the comparison returned.
+ * @return The end of the output.
+ */
+template<class OutputIt>
+OutputIt select(std::uint64_t const *bits, std::size_t count, OutputIt output)
+{
+  for(std::size_t i = 0; i < (count + 63) / 64; ++i) {
+    for(auto word = bits[i]; word != 0; word &= word - 1) {
+      *output = i * 64 + detail::lowest_bit(word);
+      ++output;
+    }
+  }
+  return output;
+}
+
+}
+
+}
+
+#endif //STRONG_MASK_HPP
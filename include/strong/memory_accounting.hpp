@@ -0,0 +1,337 @@
+#ifndef STRONG_MEMORY_ACCOUNTING_HPP
+#define STRONG_MEMORY_ACCOUNTING_HPP
+
+#include <strong.hpp>
+#include <strong/aligned_allocator.hpp>
+#include <strong/tag.hpp>
+#include <strong/vector.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+/**
+ * The memory allocated through accounting allocators of one tag.
+ */
+struct memory_usage {
+  /**
+   * The name of the tag, as given by tag_name.
+   */
+  std::string tag;
+
+  /**
+   * The number of bytes currently allocated.
+   */
+  std::uint64_t bytes;
+
+  /**
+   * The number of allocations not yet deallocated.
+   */
+  std::uint64_t allocations;
+
+  /**
+   * The number of bytes allocated over the life of the program.
+   */
+  std::uint64_t total_bytes;
+
+  /**
+   * The number of allocations made over the life of the program.
+   */
+  std::uint64_t total_allocations;
+};
+
+namespace detail {
+
+struct memory_cell {
+  std::atomic<std::uint64_t> allocated_bytes;
+  std::atomic<std::uint64_t> freed_bytes;
+  std::atomic<std::uint64_t> allocations;
+  std::atomic<std::uint64_t> deallocations;
+  char padding[64 - 4 * sizeof(std::atomic<std::uint64_t>)];
+};
+
+// The counters of one tag, spread over cache lines so that threads allocating at the same time
+// update different lines. Each thread always uses the same line, and a report sums them.
+class memory_account {
+public:
+  explicit memory_account(std::string name) : name(std::move(name)), cells(stripe_count())
+  {
+  }
+
+  void allocated(std::size_t bytes) noexcept
+  {
+    auto &cell = cells[thread_stripe() & (cells.size() - 1)];
+    cell.allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    cell.allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void deallocated(std::size_t bytes) noexcept
+  {
+    auto &cell = cells[thread_stripe() & (cells.size() - 1)];
+    cell.freed_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    cell.deallocations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  memory_usage usage() const
+  {
+    std::uint64_t allocated_bytes = 0, freed_bytes = 0, allocations = 0, deallocations = 0;
+    for(auto const &cell : cells) {
+      allocated_bytes += cell.allocated_bytes.load(std::memory_order_relaxed);
+      freed_bytes += cell.freed_bytes.load(std::memory_order_relaxed);
+      allocations += cell.allocations.load(std::memory_order_relaxed);
+      deallocations += cell.deallocations.load(std::memory_order_relaxed);
+    }
+    // a memory block freed on another thread may be counted before its allocation is
+    return memory_usage{name, allocated_bytes > freed_bytes ? allocated_bytes - freed_bytes : 0,
+                        allocations > deallocations ? allocations - deallocations : 0, allocated_bytes, allocations};
+  }
+
+private:
+  static unsigned stripe_count() noexcept
+  {
+    unsigned stripes = 1;
+    while(stripes < std::thread::hardware_concurrency() && stripes < 64) {
+      stripes *= 2;
+    }
+    return stripes;
+  }
+
+  static unsigned thread_stripe() noexcept
+  {
+    static std::atomic<unsigned> next{0};
+    static thread_local unsigned stripe = next.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+  }
+
+  std::string const name;
+  std::vector<memory_cell, aligned_allocator<memory_cell, 64>> cells;
+};
+
+struct memory_accounts {
+  std::mutex mutex;
+  std::vector<memory_account const *> accounts;
+
+  // never destroyed, so that containers destroyed during static destruction can still be counted
+  static memory_accounts & instance()
+  {
+    static auto const accounts = new memory_accounts();
+    return *accounts;
+  }
+};
+
+template<class Tag>
+memory_account & account_of()
+{
+  static auto const account = [] {
+    auto const created = new memory_account(tag_name<Tag>());
+    auto &registry = memory_accounts::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.accounts.push_back(created);
+    return created;
+  }();
+  return *account;
+}
+
+}
+
+/**
+ * An allocator adaptor that counts the memory allocated for a strong tag.
+ *
+ * Every allocation and deallocation is forwarded to Allocator and counted against Tag, so that the
+ * memory of everything keyed by a type, e.g. all arrays indexed by intersection_id, can be reported
+ * with memory_report. Counting costs two relaxed atomic additions on a cache line private to the
+ * thread, so it can stay enabled in production.
+ *
+ * Use it as the allocator of a strong::vector (see accounted_vector), of sparse_set, component_pool,
+ * disjoint_sets and dense_remapper, or of any standard container. The containers rebind it for their
+ * internal arrays, so all of their memory is counted against the same tag.
+ *
+ * @tparam Tag The strong typedef to count the memory against.
+ * @tparam T The type of the elements to allocate.
+ * @tparam Allocator The allocator that provides the memory.
+ */
+template<class Tag, typename T, class Allocator = std::allocator<T>>
+class accounting_allocator {
+  using traits = std::allocator_traits<Allocator>;
+
+public:
+  using value_type = T;
+  using pointer = typename traits::pointer;
+  using const_pointer = typename traits::const_pointer;
+  using size_type = typename traits::size_type;
+  using difference_type = typename traits::difference_type;
+  using propagate_on_container_copy_assignment = typename traits::propagate_on_container_copy_assignment;
+  using propagate_on_container_move_assignment = typename traits::propagate_on_container_move_assignment;
+  using propagate_on_container_swap = typename traits::propagate_on_container_swap;
+
+  template<typename U>
+  struct rebind {
+    using other = accounting_allocator<Tag, U, typename traits::template rebind_alloc<U>>;
+  };
+
+  /**
+   * Construct an allocator with a default constructed underlying allocator.
+   */
+  accounting_allocator() = default;
+
+  /**
+   * Construct an allocator that forwards to a copy of an allocator.
+   *
+   * @param allocator The allocator that provides the memory.
+   */
+  explicit accounting_allocator(Allocator const &allocator) noexcept : allocator(allocator)
+  {
+  }
+
+  /**
+   * Construct an allocator from one for another element type.
+   *
+   * @param other The allocator to copy.
+   */
+  template<typename U, class Other>
+  accounting_allocator(accounting_allocator<Tag, U, Other> const &other) noexcept : allocator(other.underlying())
+  {
+  }
+
+  /**
+   * Allocate memory and count it against Tag.
+   *
+   * @param count The number of elements to allocate memory for.
+   * @return The memory.
+   */
+  pointer allocate(size_type count)
+  {
+    auto const memory = traits::allocate(allocator, count);
+    detail::account_of<Tag>().allocated(count * sizeof(T));
+    return memory;
+  }
+
+  /**
+   * Deallocate memory and deduct it from Tag.
+   *
+   * @param memory The memory returned by allocate.
+   * @param count The number of elements passed to allocate.
+   */
+  void deallocate(pointer memory, size_type count) noexcept
+  {
+    detail::account_of<Tag>().deallocated(count * sizeof(T));
+    traits::deallocate(allocator, memory, count);
+  }
+
+  /**
+   * @return The allocator to use for a copy of a container.
+   */
+  accounting_allocator select_on_container_copy_construction() const
+  {
+    return accounting_allocator(traits::select_on_container_copy_construction(allocator));
+  }
+
+  /**
+   * @return The allocator that provides the memory.
+   */
+  Allocator const & underlying() const noexcept
+  {
+    return allocator;
+  }
+
+  template<typename U, class Other>
+  friend bool operator==(accounting_allocator const &lhs, accounting_allocator<Tag, U, Other> const &rhs) noexcept
+  {
+    return lhs.underlying() == rhs.underlying();
+  }
+
+  template<typename U, class Other>
+  friend bool operator!=(accounting_allocator const &lhs, accounting_allocator<Tag, U, Other> const &rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+private:
+  Allocator allocator;
+};
+
+/**
+ * A strong::vector whose memory is counted against its index type.
+ *
+ * @tparam Index The strong typedef that indexes the array and that its memory is counted against.
+ * @tparam T The type of the elements.
+ */
+template<class Index, typename T>
+using accounted_vector = vector<Index, T, accounting_allocator<Index, T>>;
+
+/**
+ * The memory counted against one tag.
+ *
+ * @tparam Tag The strong typedef the memory is counted against.
+ * @return The memory usage of the tag.
+ */
+template<class Tag>
+memory_usage memory_usage_of()
+{
+  return detail::account_of<Tag>().usage();
+}
+
+/**
+ * The memory counted against every tag that has allocated through an accounting allocator.
+ *
+ * Each tag is read atomically, but allocations made during the report may be reflected in some
+ * tags and not in others.
+ *
+ * @return The memory usage of each tag, in the order the tags first allocated.
+ */
+inline std::vector<memory_usage> memory_report()
+{
+  auto &registry = detail::memory_accounts::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<memory_usage> report;
+  for(auto const account : registry.accounts) {
+    report.push_back(account->usage());
+  }
+  return report;
+}
+
+/**
+ * Render a memory report as a table, one tag per line.
+ *
+ * @param report The report to render.
+ * @return The table.
+ */
+inline std::string render_memory_report(std::vector<memory_usage> const &report)
+{
+  // format every cell first, so that each column can be as wide as its widest cell
+  std::vector<std::vector<std::string>> rows = {{"tag", "bytes", "allocations", "total_bytes", "total_allocations"}};
+  for(auto const &usage : report) {
+    rows.push_back({usage.tag, std::to_string(usage.bytes), std::to_string(usage.allocations),
+                    std::to_string(usage.total_bytes), std::to_string(usage.total_allocations)});
+  }
+  std::vector<std::size_t> widths(rows.front().size(), 0);
+  for(auto const &row : rows) {
+    for(std::size_t column = 0; column < row.size(); ++column) {
+      widths[column] = std::max(widths[column], row[column].size());
+    }
+  }
+
+  // the tag is aligned left and the numbers right
+  std::string output;
+  for(auto const &row : rows) {
+    output += row[0] + std::string(widths[0] - row[0].size(), ' ');
+    for(std::size_t column = 1; column < row.size(); ++column) {
+      output += "  " + std::string(widths[column] - row[column].size(), ' ') + row[column];
+    }
+    output += '\n';
+  }
+  return output;
+}
+
+}
+
+#endif //STRONG_MEMORY_ACCOUNTING_HPP
@@ -0,0 +1,691 @@
+#ifndef STRONG_METRICS_HPP
+#define STRONG_METRICS_HPP
+
+#include <strong.hpp>
+#include <strong/aligned_allocator.hpp>
+#include <strong/bytes.hpp>
+#include <strong/tag.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace strong {
+
+/**
+ * Whether a metric only ever increases or can move in both directions.
+ */
+enum class metric_type : std::uint8_t {
+  counter,
+  gauge
+};
+
+/**
+ * The value of a metric at the time of a snapshot, kept in the representation of its underlying
+ * type so that large integer counters are not rounded.
+ */
+struct metric_value {
+  /**
+   * Which member holds the value.
+   */
+  enum class kind : std::uint8_t {
+    signed_integer,
+    unsigned_integer,
+    floating_point
+  };
+
+  kind type;
+  std::int64_t as_signed;
+  std::uint64_t as_unsigned;
+  double as_double;
+
+  /**
+   * @return The value as a double.
+   */
+  double to_double() const noexcept
+  {
+    return type == kind::floating_point ? as_double
+           : type == kind::signed_integer ? static_cast<double>(as_signed) : static_cast<double>(as_unsigned);
+  }
+};
+
+/**
+ * One metric in a snapshot.
+ */
+struct metric_sample {
+  std::string name;
+  std::string help;
+  std::string tag;
+  std::uint64_t fingerprint;
+  metric_type type;
+  metric_value value;
+};
+
+namespace detail {
+
+template<typename T>
+metric_value make_metric_value(T value) noexcept
+{
+  metric_value result{metric_value::kind::floating_point, 0, 0, 0};
+  if(std::is_floating_point<T>::value) {
+    result.as_double = static_cast<double>(value);
+  } else if(std::is_signed<T>::value) {
+    result.type = metric_value::kind::signed_integer;
+    result.as_signed = static_cast<std::int64_t>(value);
+  } else {
+    result.type = metric_value::kind::unsigned_integer;
+    result.as_unsigned = static_cast<std::uint64_t>(value);
+  }
+  return result;
+}
+
+template<typename T>
+void atomic_add(std::atomic<T> &cell, T amount, std::true_type) noexcept
+{
+  cell.fetch_add(amount, std::memory_order_relaxed);
+}
+
+template<typename T>
+void atomic_add(std::atomic<T> &cell, T amount, std::false_type) noexcept
+{
+  // floating point atomics only have fetch_add from C++20
+  auto current = cell.load(std::memory_order_relaxed);
+  while(!cell.compare_exchange_weak(current, current + amount, std::memory_order_relaxed)) {
+  }
+}
+
+template<typename T>
+struct metric_cell {
+  std::atomic<T> value;
+  char padding[64 - sizeof(std::atomic<T>) % 64];
+};
+
+inline unsigned metric_stripes() noexcept
+{
+  unsigned stripes = 1;
+  while(stripes < std::thread::hardware_concurrency() && stripes < 64) {
+    stripes *= 2;
+  }
+  return stripes;
+}
+
+inline unsigned metric_thread_index() noexcept
+{
+  static std::atomic<unsigned> next{0};
+  static thread_local unsigned index = next.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+// Prometheus names may only hold letters, digits, underscores and colons, and colons are
+// reserved for recording rules.
+inline std::string metric_name(std::string const &tag)
+{
+  std::string name;
+  for(std::size_t i = 0; i < tag.size(); ++i) {
+    auto const c = tag[i];
+    if(c == ':' && i + 1 < tag.size() && tag[i + 1] == ':') {
+      name += '_';
+      ++i;
+    } else if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9' && !name.empty()) || c == '_') {
+      name += c;
+    } else {
+      name += '_';
+    }
+  }
+  return name;
+}
+
+class metric_base {
+public:
+  metric_base(std::string name, std::string help, std::string tag, std::uint64_t fingerprint, metric_type type)
+    : name(std::move(name)), help(std::move(help)), tag(std::move(tag)), fingerprint(fingerprint), type(type)
+  {
+  }
+
+  virtual ~metric_base() = default;
+
+  virtual metric_value sample() const noexcept = 0;
+
+  std::string name;
+  std::string help;
+  std::string tag;
+  std::uint64_t fingerprint;
+  metric_type type;
+};
+
+constexpr std::uint32_t metrics_magic = 0x4d525453; // "STRM"
+
+}
+
+/**
+ * A monotonically increasing metric of a strong typedef, such as a cycle count.
+ *
+ * Each thread adds to its own cache line of the counter with a relaxed atomic operation, so
+ * updates from different threads neither lock nor contend. Reading the counter sums the lines.
+ *
+ * @tparam TypeName The strong typedef of the metric, with an arithmetic underlying type.
+ */
+template<class TypeName>
+class counter : public detail::metric_base {
+public:
+  /**
+   * Add to the counter.
+   *
+   * @param amount The amount to add, which must not be negative.
+   */
+  void add(TypeName const &amount) noexcept
+  {
+    detail::atomic_add(cells[detail::metric_thread_index() & (cells.size() - 1)].value, get(amount), std::is_integral<T>());
+  }
+
+  /**
+   * Add one to the counter.
+   */
+  void increment() noexcept
+  {
+    add(TypeName(T(1)));
+  }
+
+  /**
+   * @return The total of every addition so far.
+   */
+  TypeName value() const noexcept
+  {
+    T total = 0;
+    for(auto const &cell : cells) {
+      total += cell.value.load(std::memory_order_relaxed);
+    }
+    return TypeName(total);
+  }
+
+  metric_value sample() const noexcept override
+  {
+    return detail::make_metric_value(get(value()));
+  }
+
+private:
+  using T = typename underlying_type<TypeName>::type;
+
+  friend class metrics_registry;
+
+  counter(std::string name, std::string help)
+    : metric_base(std::move(name), std::move(help), tag_name<TypeName>(), tag_fingerprint<TypeName>(), metric_type::counter),
+      cells(detail::metric_stripes())
+  {
+  }
+
+  std::vector<detail::metric_cell<T>, detail::aligned_allocator<detail::metric_cell<T>, 64>> cells;
+};
+
+/**
+ * A metric of a strong typedef that can be set or moved in both directions, such as a frequency.
+ *
+ * The gauge is a single atomic value, since the last value set wins whichever thread set it.
+ *
+ * @tparam TypeName The strong typedef of the metric, with an arithmetic underlying type.
+ */
+template<class TypeName>
+class gauge : public detail::metric_base {
+public:
+  /**
+   * Set the gauge.
+   *
+   * @param value The new value.
+   */
+  void set(TypeName const &value) noexcept
+  {
+    cell.value.store(get(value), std::memory_order_relaxed);
+  }
+
+  /**
+   * Add to the gauge.
+   *
+   * @param amount The amount to add, which may be negative.
+   */
+  void add(TypeName const &amount) noexcept
+  {
+    detail::atomic_add(cell.value, get(amount), std::is_integral<T>());
+  }
+
+  /**
+   * @return The current value.
+   */
+  TypeName value() const noexcept
+  {
+    return TypeName(cell.value.load(std::memory_order_relaxed));
+  }
+
+  metric_value sample() const noexcept override
+  {
+    return detail::make_metric_value(get(value()));
+  }
+
+private:
+  using T = typename underlying_type<TypeName>::type;
+
+  friend class metrics_registry;
+
+  gauge(std::string name, std::string help)
+    : metric_base(std::move(name), std::move(help), tag_name<TypeName>(), tag_fingerprint<TypeName>(), metric_type::gauge)
+  {
+    cell.value.store(T(), std::memory_order_relaxed);
+  }
+
+  detail::metric_cell<T> cell;
+};
+
+/**
+ * A set of named counters and gauges.
+ *
+ * Metrics are named after the tag of their strong typedef unless a name is given, so that
+ * counter<cycle_count> is exported as cycle_count_total. Declaring a metric takes a lock and
+ * returns a reference that stays valid for the life of the registry; updating it does not touch
+ * the registry at all.
+ */
+class metrics_registry {
+public:
+  /**
+   * Declare a counter, or find the one already declared with the same name.
+   *
+   * @tparam TypeName The strong typedef of the counter.
+   * @param help A description of the metric.
+   * @param name The name of the metric, or empty to derive it from the tag name of TypeName.
+   * @return The counter.
+   * @throws std::invalid_argument If the name is taken by a metric of another kind or type.
+   */
+  template<class TypeName>
+  strong::counter<TypeName> & counter(std::string const &help = std::string(), std::string const &name = std::string())
+  {
+    using T = typename underlying_type<TypeName>::type;
+    static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                  "metrics require a strong typedef with an integral or floating point underlying type");
+    return declare<strong::counter<TypeName>, TypeName>(help, name, metric_type::counter);
+  }
+
+  /**
+   * Declare a gauge, or find the one already declared with the same name.
+   *
+   * @tparam TypeName The strong typedef of the gauge.
+   * @param help A description of the metric.
+   * @param name The name of the metric, or empty to derive it from the tag name of TypeName.
+   * @return The gauge.
+   * @throws std::invalid_argument If the name is taken by a metric of another kind or type.
+   */
+  template<class TypeName>
+  strong::gauge<TypeName> & gauge(std::string const &help = std::string(), std::string const &name = std::string())
+  {
+    using T = typename underlying_type<TypeName>::type;
+    static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                  "metrics require a strong typedef with an integral or floating point underlying type");
+    return declare<strong::gauge<TypeName>, TypeName>(help, name, metric_type::gauge);
+  }
+
+  /**
+   * Read every metric.
+   *
+   * Each metric is read atomically, but updates made during the snapshot may be reflected in some
+   * metrics and not in others.
+   *
+   * @return The metrics, in order of declaration.
+   */
+  std::vector<metric_sample> snapshot() const
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<metric_sample> samples;
+    for(auto const &metric : metrics) {
+      samples.push_back(metric_sample{metric->name, metric->help, metric->tag, metric->fingerprint, metric->type,
+                                      metric->sample()});
+    }
+    return samples;
+  }
+
+private:
+  template<class Metric, class TypeName>
+  Metric & declare(std::string const &help, std::string const &name, metric_type type)
+  {
+    auto const full_name = detail::metric_name(name.empty() ? tag_name<TypeName>() : name);
+    std::lock_guard<std::mutex> lock(mutex);
+    for(auto const &metric : metrics) {
+      if(metric->name == full_name) {
+        if(metric->type != type || metric->fingerprint != tag_fingerprint<TypeName>()) {
+          throw std::invalid_argument("strong::metrics_registry: " + full_name + " is already declared differently");
+        }
+        return static_cast<Metric &>(*metric);
+      }
+    }
+    metrics.emplace_back(new Metric(full_name, help));
+    return static_cast<Metric &>(*metrics.back());
+  }
+
+  mutable std::mutex mutex;
+  std::vector<std::unique_ptr<detail::metric_base>> metrics;
+};
+
+/**
+ * Render a snapshot in the Prometheus text exposition format (version 0.0.4).
+ *
+ * Counters get the conventional _total suffix, and the tag name of each metric is attached as the
+ * strong_tag label.
+ *
+ * @param samples The snapshot to render.
+ * @return The exposition text.
+ */
+inline std::string render_prometheus(std::vector<metric_sample> const &samples)
+{
+  std::ostringstream output;
+  output.precision(std::numeric_limits<double>::max_digits10);
+  for(auto const &sample : samples) {
+    auto const name = sample.type == metric_type::counter ? sample.name + "_total" : sample.name;
+
+    if(!sample.help.empty()) {
+      output << "# HELP " << name << ' ';
+      for(auto const c : sample.help) {
+        output << (c == '\\' ? "\\\\" : c == '\n' ? "\\n" : std::string(1, c));
+      }
+      output << '\n';
+    }
+    output << "# TYPE " << name << (sample.type == metric_type::counter ? " counter\n" : " gauge\n");
+
+    output << name << "{strong_tag=\"";
+    for(auto const c : sample.tag) {
+      output << (c == '\\' || c == '"' ? std::string(1, '\\') + c : std::string(1, c));
+    }
+    output << "\"} ";
+    switch(sample.value.type) {
+    case metric_value::kind::signed_integer:
+      output << sample.value.as_signed;
+      break;
+    case metric_value::kind::unsigned_integer:
+      output << sample.value.as_unsigned;
+      break;
+    default:
+      if(std::isnan(sample.value.as_double)) {
+        output << "NaN";
+      } else if(std::isinf(sample.value.as_double)) {
+        output << (sample.value.as_double > 0 ? "+Inf" : "-Inf");
+      } else {
+        output << sample.value.as_double;
+      }
+    }
+    output << '\n';
+  }
+  return output.str();
+}
+
+/**
+ * Serialize a snapshot in a compact binary form, in the byte order of the machine.
+ *
+ * @param samples The snapshot to serialize.
+ * @return The serialized snapshot.
+ */
+inline std::vector<unsigned char> serialize_metrics(std::vector<metric_sample> const &samples)
+{
+  std::vector<unsigned char> buffer;
+  auto const append_string = [&buffer](std::string const &value) {
+    detail::append_bytes(buffer, static_cast<std::uint32_t>(value.size()));
+    buffer.insert(buffer.end(), value.begin(), value.end());
+  };
+
+  detail::append_bytes(buffer, detail::metrics_magic);
+  detail::append_bytes(buffer, static_cast<std::uint32_t>(samples.size()));
+  for(auto const &sample : samples) {
+    append_string(sample.name);
+    append_string(sample.help);
+    append_string(sample.tag);
+    detail::append_bytes(buffer, sample.fingerprint);
+    detail::append_bytes(buffer, static_cast<std::uint8_t>(sample.type));
+    detail::append_bytes(buffer, static_cast<std::uint8_t>(sample.value.type));
+    switch(sample.value.type) {
+    case metric_value::kind::signed_integer:
+      detail::append_bytes(buffer, sample.value.as_signed);
+      break;
+    case metric_value::kind::unsigned_integer:
+      detail::append_bytes(buffer, sample.value.as_unsigned);
+      break;
+    default:
+      detail::append_bytes(buffer, sample.value.as_double);
+    }
+  }
+  return buffer;
+}
+
+/**
+ * Read a snapshot serialized by serialize_metrics.
+ *
+ * @param data The serialized snapshot.
+ * @param size The size of the serialized snapshot in bytes.
+ * @return The snapshot.
+ * @throws std::invalid_argument If the data is not a serialized snapshot.
+ */
+inline std::vector<metric_sample> deserialize_metrics(void const *data, std::size_t size)
+{
+  auto const what = "strong::deserialize_metrics: not a serialized snapshot";
+  auto position = static_cast<unsigned char const *>(data);
+  auto const end = position + size;
+  auto const read_string = [&]() {
+    auto const length = detail::read_bytes<std::uint32_t>(position, end, what);
+    if(static_cast<std::size_t>(end - position) < length) {
+      throw std::invalid_argument(what);
+    }
+    std::string value(reinterpret_cast<char const *>(position), length);
+    position += length;
+    return value;
+  };
+
+  if(detail::read_bytes<std::uint32_t>(position, end, what) != detail::metrics_magic) {
+    throw std::invalid_argument(what);
+  }
+  std::vector<metric_sample> samples(detail::read_bytes<std::uint32_t>(position, end, what));
+  for(auto &sample : samples) {
+    sample.name = read_string();
+    sample.help = read_string();
+    sample.tag = read_string();
+    sample.fingerprint = detail::read_bytes<std::uint64_t>(position, end, what);
+    sample.type = static_cast<metric_type>(detail::read_bytes<std::uint8_t>(position, end, what));
+    sample.value = metric_value{static_cast<metric_value::kind>(detail::read_bytes<std::uint8_t>(position, end, what)), 0, 0, 0};
+    switch(sample.value.type) {
+    case metric_value::kind::signed_integer:
+      sample.value.as_signed = detail::read_bytes<std::int64_t>(position, end, what);
+      break;
+    case metric_value::kind::unsigned_integer:
+      sample.value.as_unsigned = detail::read_bytes<std::uint64_t>(position, end, what);
+      break;
+    default:
+      sample.value.as_double = detail::read_bytes<double>(position, end, what);
+    }
+  }
+  return samples;
+}
+
+/**
+ * The formats a snapshot can be written in.
+ */
+enum class metrics_format {
+  prometheus,
+  binary
+};
+
+/**
+ * Write a snapshot of a registry to a file, replacing it atomically.
+ *
+ * The snapshot is written to a temporary file beside the target and then renamed over it, so that
+ * readers such as the node exporter's textfile collector never see a partial file.
+ *
+ * @param registry The metrics to write.
+ * @param path The path of the file.
+ * @param format The format to write.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+inline void write_metrics(metrics_registry const &registry, std::string const &path,
+                          metrics_format format = metrics_format::prometheus)
+{
+  auto const samples = registry.snapshot();
+  auto const temporary = path + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if(format == metrics_format::prometheus) {
+      file << render_prometheus(samples);
+    } else {
+      auto const bytes = serialize_metrics(samples);
+      file.write(reinterpret_cast<char const *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+    if(!file.flush()) {
+      throw std::runtime_error("strong::write_metrics: cannot write " + temporary);
+    }
+  }
+  if(std::rename(temporary.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error("strong::write_metrics: cannot replace " + path);
+  }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+/**
+ * A minimal HTTP endpoint on the loopback interface that serves a registry to Prometheus.
+ *
+ * A background thread answers every request, whatever its path, with the Prometheus text of a
+ * fresh snapshot and then closes the connection. Requests are served one at a time.
+ */
+class metrics_server {
+public:
+  /**
+   * Start serving.
+   *
+   * @param registry The metrics to serve, which must outlive the server.
+   * @param port The TCP port to listen on, or 0 to let the system choose one.
+   * @throws std::runtime_error If the socket cannot be set up.
+   */
+  explicit metrics_server(metrics_registry const &registry, std::uint16_t port = 0) : registry(registry)
+  {
+    listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    if(listener < 0) {
+      throw std::runtime_error("strong::metrics_server: cannot create a socket");
+    }
+    int const reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if(::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(listener, 16) != 0
+       || ::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length) != 0) {
+      ::close(listener);
+      throw std::runtime_error("strong::metrics_server: cannot listen on port " + std::to_string(port));
+    }
+    bound = ntohs(address.sin_port);
+
+    running = true;
+    worker = std::thread([this] { serve(); });
+  }
+
+  metrics_server(metrics_server const &) = delete;
+  metrics_server & operator=(metrics_server const &) = delete;
+
+  /**
+   * Stop serving and close the socket.
+   */
+  ~metrics_server()
+  {
+    running = false;
+    worker.join();
+    ::close(listener);
+  }
+
+  /**
+   * @return The port the server listens on.
+   */
+  std::uint16_t port() const noexcept
+  {
+    return bound;
+  }
+
+private:
+  void serve()
+  {
+    while(running) {
+      // wake up periodically to notice that the server is stopping
+      pollfd waiting = {listener, POLLIN, 0};
+      if(::poll(&waiting, 1, 100) <= 0) {
+        continue;
+      }
+      auto const connection = ::accept(listener, nullptr, nullptr);
+      if(connection < 0) {
+        continue;
+      }
+
+      // read the request headers, giving up on clients that are slow to send them
+      std::string request;
+      char buffer[1024];
+      pollfd reading = {connection, POLLIN, 0};
+      while(request.find("\r\n\r\n") == std::string::npos && request.size() < 8192 && ::poll(&reading, 1, 1000) > 0) {
+        auto const received = ::recv(connection, buffer, sizeof(buffer), 0);
+        if(received <= 0) {
+          break;
+        }
+        request.append(buffer, static_cast<std::size_t>(received));
+      }
+
+      std::string body;
+      try {
+        body = render_prometheus(registry.snapshot());
+      } catch(...) {
+      }
+      auto const response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                            + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+      send_all(connection, response);
+      ::close(connection);
+    }
+  }
+
+  static void send_all(int connection, std::string const &data)
+  {
+#ifdef MSG_NOSIGNAL
+    int const flags = MSG_NOSIGNAL;
+#else
+    int const flags = 0;
+#endif
+    std::size_t sent = 0;
+    while(sent < data.size()) {
+      auto const count = ::send(connection, data.data() + sent, data.size() - sent, flags);
+      if(count <= 0) {
+        return;
+      }
+      sent += static_cast<std::size_t>(count);
+    }
+  }
+
+  metrics_registry const &registry;
+  int listener;
+  std::uint16_t bound;
+  std::atomic<bool> running{false};
+  std::thread worker;
+};
+
+#endif
+
+}
+
+#endif //STRONG_METRICS_HPP
@@ -0,0 +1,451 @@
+#ifndef STRONG_PARALLEL_HPP
+#define STRONG_PARALLEL_HPP
+
+#include <strong.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace strong {
+
+namespace detail {
+
+// Tasks of one call to parallel_for, or of any other fork-join region: the number still to finish,
+// and the first exception thrown by one of them.
+class task_group {
+public:
+  task_group() noexcept : pending(1), failed(false)
+  {
+  }
+
+  void add() noexcept
+  {
+    pending.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void done() noexcept
+  {
+    pending.fetch_sub(1, std::memory_order_release);
+  }
+
+  bool finished() const noexcept
+  {
+    return pending.load(std::memory_order_acquire) == 0;
+  }
+
+  bool cancelled() const noexcept
+  {
+    return failed.load(std::memory_order_relaxed);
+  }
+
+  void fail(std::exception_ptr exception) noexcept
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!failed.exchange(true, std::memory_order_relaxed)) {
+      error = exception;
+    }
+  }
+
+  void rethrow()
+  {
+    if(error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+private:
+  std::atomic<std::size_t> pending;
+  std::atomic<bool> failed;
+  std::mutex mutex;
+  std::exception_ptr error;
+};
+
+class task {
+public:
+  explicit task(task_group &group) noexcept : group(group)
+  {
+  }
+
+  virtual ~task() = default;
+
+  // run the task, record any exception in its group, and mark it finished
+  void execute() noexcept
+  {
+    if(!group.cancelled()) {
+      try {
+        run();
+      } catch(...) {
+        group.fail(std::current_exception());
+      }
+    }
+    group.done();
+  }
+
+protected:
+  virtual void run() = 0;
+
+  task_group &group;
+};
+
+// A double-ended queue of tasks: its owner pushes and pops at the back, so it works depth first
+// on the tasks it split off most recently, while thieves take the oldest, largest tasks from the
+// front.
+class task_queue {
+public:
+  void push(std::unique_ptr<task> item)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    items.push_back(std::move(item));
+    count.store(items.size(), std::memory_order_relaxed);
+  }
+
+  std::unique_ptr<task> pop()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return take(false);
+  }
+
+  std::unique_ptr<task> steal()
+  {
+    if(empty()) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return take(true);
+  }
+
+  bool empty() const noexcept
+  {
+    return count.load(std::memory_order_relaxed) == 0;
+  }
+
+private:
+  std::unique_ptr<task> take(bool front)
+  {
+    if(items.empty()) {
+      return nullptr;
+    }
+    std::unique_ptr<task> item;
+    if(front) {
+      item = std::move(items.front());
+      items.pop_front();
+    } else {
+      item = std::move(items.back());
+      items.pop_back();
+    }
+    count.store(items.size(), std::memory_order_relaxed);
+    return item;
+  }
+
+  std::mutex mutex;
+  std::deque<std::unique_ptr<task>> items;
+  std::atomic<std::size_t> count{0};
+};
+
+template<class Index, class Function>
+class range_task;
+
+}
+
+template<class TaskId>
+class task_graph;
+
+/**
+ * A pool of worker threads that share fork-join tasks by work stealing.
+ *
+ * Each worker has its own queue of tasks. A worker takes the newest task from its own queue and,
+ * when that is empty, steals the oldest task from another queue; idle workers sleep until new
+ * tasks are queued. A thread that waits for its tasks, whether a worker or not, runs queued tasks
+ * instead of blocking, so parallel loops can be nested.
+ */
+class task_scheduler {
+public:
+  /**
+   * Start the workers.
+   *
+   * @param threads The number of worker threads. The thread that calls parallel_for works too, so
+   *                the default uses every hardware thread.
+   */
+  explicit task_scheduler(unsigned threads = default_threads()) : queues(threads + 1), stopping(false), queued(0), idle(0)
+  {
+    workers.reserve(threads);
+    for(unsigned i = 0; i < threads; ++i) {
+      workers.emplace_back([this, i] { work(i); });
+    }
+  }
+
+  task_scheduler(task_scheduler const &) = delete;
+  task_scheduler & operator=(task_scheduler const &) = delete;
+
+  /**
+   * Stop the workers once they have finished the tasks that are running.
+   */
+  ~task_scheduler()
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for(auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  /**
+   * @return The number of threads that run tasks: the workers and the calling thread.
+   */
+  unsigned concurrency() const noexcept
+  {
+    return static_cast<unsigned>(workers.size()) + 1;
+  }
+
+  /**
+   * @return A scheduler with the default number of threads, started on first use.
+   */
+  static task_scheduler & global()
+  {
+    static task_scheduler scheduler;
+    return scheduler;
+  }
+
+  /**
+   * @return One worker for every hardware thread but the calling one.
+   */
+  static unsigned default_threads() noexcept
+  {
+    auto const hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+  }
+
+private:
+  template<class Index, class Function>
+  friend class detail::range_task;
+
+  template<class TaskId>
+  friend class task_graph;
+
+  template<class Index, class Function>
+  friend void parallel_for(task_scheduler &, Index const &, Index const &, std::size_t, Function const &);
+
+  // Queue a task where the current thread, and then thieves, will find it.
+  void spawn(std::unique_ptr<detail::task> item)
+  {
+    local_queue().push(std::move(item));
+    queued.fetch_add(1);
+    if(idle.load() != 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      wake.notify_one();
+    }
+  }
+
+  // Whether the tasks the current thread has queued have all been taken, so more splitting helps.
+  bool hungry() const noexcept
+  {
+    return local_queue().empty();
+  }
+
+  // Run queued tasks until the group has finished, then rethrow its first exception.
+  void wait(detail::task_group &group)
+  {
+    auto const self = current_index();
+    unsigned spins = 0;
+    while(!group.finished()) {
+      if(run_one(self)) {
+        spins = 0;
+      } else if(++spins > 64) {
+        std::this_thread::yield();
+      }
+    }
+    group.rethrow();
+  }
+
+  // the queue of the calling thread: its own for a worker of this scheduler, and otherwise the
+  // queue shared by every other thread
+  detail::task_queue & local_queue() const noexcept
+  {
+    return const_cast<detail::task_queue &>(queues[current_index()]);
+  }
+
+  std::size_t current_index() const noexcept
+  {
+    return current_scheduler() == this ? current_worker() : workers.size();
+  }
+
+  static task_scheduler const *& current_scheduler() noexcept
+  {
+    static thread_local task_scheduler const *scheduler = nullptr;
+    return scheduler;
+  }
+
+  static std::size_t & current_worker() noexcept
+  {
+    static thread_local std::size_t worker = 0;
+    return worker;
+  }
+
+  bool run_one(std::size_t self)
+  {
+    auto item = queues[self].pop();
+    if(!item) {
+      // start stealing at a different queue on each attempt, to spread the thieves out
+      static thread_local std::uint32_t random = 0x9e3779b9u;
+      random ^= random << 13;
+      random ^= random >> 17;
+      random ^= random << 5;
+      for(std::size_t i = 0; i < queues.size() && !item; ++i) {
+        item = queues[(random + i) % queues.size()].steal();
+      }
+    }
+    if(!item) {
+      return false;
+    }
+    queued.fetch_sub(1);
+    item->execute();
+    return true;
+  }
+
+  void work(std::size_t index)
+  {
+    current_scheduler() = this;
+    current_worker() = index;
+    for(;;) {
+      if(run_one(index)) {
+        continue;
+      }
+      idle.fetch_add(1);
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      wake.wait(lock, [this] { return stopping || queued.load() != 0; });
+      idle.fetch_sub(1);
+      if(stopping) {
+        return;
+      }
+    }
+  }
+
+  std::vector<detail::task_queue> queues;
+  std::vector<std::thread> workers;
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  bool stopping;
+  std::atomic<std::size_t> queued;
+  std::atomic<std::size_t> idle;
+};
+
+namespace detail {
+
+template<class Index>
+struct check_parallel_index {
+  static_assert(std::is_integral<typename underlying_type<Index>::type>::value,
+                "parallel_for requires a strong typedef with an integral underlying type");
+};
+
+// A range of indices that splits itself lazily: only while the tasks it split off before have
+// been stolen, i.e. while other threads are hungry for work. An uncontended loop therefore runs
+// in grain-sized chunks without creating tasks, and a contended one splits in halves as deep as
+// the thieves need.
+template<class Index, class Function>
+class range_task : public task {
+public:
+  using value_type = typename underlying_type<Index>::type;
+
+  range_task(task_group &group, task_scheduler &scheduler, value_type first, value_type last, std::size_t grain,
+             Function const &function) noexcept
+    : task(group), scheduler(scheduler), first(first), last(last), grain(grain), function(function)
+  {
+  }
+
+  void run() override
+  {
+    while(static_cast<std::size_t>(last - first) > grain) {
+      if(scheduler.hungry()) {
+        auto const middle = static_cast<value_type>(first + (last - first) / 2);
+        group.add();
+        scheduler.spawn(std::unique_ptr<task>(new range_task(group, scheduler, middle, last, grain, function)));
+        last = middle;
+      } else {
+        auto const stop = static_cast<value_type>(first + grain);
+        run_chunk(stop);
+        if(group.cancelled()) {
+          return;
+        }
+      }
+    }
+    run_chunk(last);
+  }
+
+private:
+  void run_chunk(value_type stop)
+  {
+    for(; first != stop; ++first) {
+      function(Index(first));
+    }
+  }
+
+  task_scheduler &scheduler;
+  value_type first;
+  value_type last;
+  std::size_t grain;
+  Function const &function;
+};
+
+}
+
+/**
+ * Call a function for every strong index in a range, in parallel.
+ *
+ * The range is split between the threads of the scheduler by work stealing: the calling thread
+ * starts on the whole range and splits off halves only while other threads are waiting for work,
+ * so the number of tasks adapts to the load. The call returns when every index has been visited.
+ *
+ * @param scheduler The threads to run on.
+ * @param first The first index.
+ * @param last The index past the last one.
+ * @param grain The number of indices below which a range is not split further.
+ * @param function Called as function(index) for each index, from any thread and in any order.
+ * @throws Any exception thrown by the function, after the loop has stopped; the first one is
+ *         rethrown and indices not yet visited are skipped.
+ */
+template<class Index, class Function>
+void parallel_for(task_scheduler &scheduler, Index const &first, Index const &last, std::size_t grain,
+                  Function const &function)
+{
+  detail::check_parallel_index<Index>();
+  if(!(get(first) < get(last))) {
+    return;
+  }
+
+  detail::task_group group;
+  detail::range_task<Index, Function>(group, scheduler, get(first), get(last), grain == 0 ? 1 : grain, function)
+    .execute();
+  scheduler.wait(group);
+}
+
+/**
+ * Call a function for every strong index in a range, in parallel on the global scheduler.
+ *
+ * @param first The first index.
+ * @param last The index past the last one.
+ * @param grain The number of indices below which a range is not split further.
+ * @param function Called as function(index) for each index, from any thread and in any order.
+ * @throws Any exception thrown by the function, after the loop has stopped.
+ */
+template<class Index, class Function>
+void parallel_for(Index const &first, Index const &last, std::size_t grain, Function const &function)
+{
+  parallel_for(task_scheduler::global(), first, last, grain, function);
+}
+
+}
+
+#endif //STRONG_PARALLEL_HPP
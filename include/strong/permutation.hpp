@@ -0,0 +1,483 @@
+#ifndef STRONG_PERMUTATION_HPP
+#define STRONG_PERMUTATION_HPP
+
+#include <strong.hpp>
+#include <strong/vector.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+namespace detail {
+
+inline std::uint64_t spread_bits(std::uint64_t v) noexcept
+{
+  v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+  v = (v | (v << 8)) & 0x00ff00ff00ff00ffULL;
+  v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  v = (v | (v << 2)) & 0x3333333333333333ULL;
+  v = (v | (v << 1)) & 0x5555555555555555ULL;
+  return v;
+}
+
+}
+
+/**
+ * A one-to-one mapping from one ID space to another.
+ *
+ * Relabeling IDs so that related elements have nearby IDs improves the locality of every array
+ * indexed by those IDs. The permutation is typed by both ID spaces, so a mapping computed for
+ * intersections cannot be applied to an array of streets, and data indexed by the old IDs cannot
+ * be confused with data indexed by the new IDs.
+ *
+ * @tparam FromId The strong typedef of the original IDs.
+ * @tparam ToId The strong typedef of the relabeled IDs.
+ */
+template<class FromId, class ToId>
+class permutation {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Construct an empty permutation.
+   */
+  permutation() = default;
+
+  /**
+   * Construct a permutation from a new order of the original IDs.
+   *
+   * @param order The original IDs listed in their new order, so order[i] receives the new ID i.
+   * @throws std::invalid_argument If order is not a permutation of 0 to order.size() - 1.
+   */
+  explicit permutation(std::vector<FromId> order) : backward(std::move(order))
+  {
+    forward.assign(backward.size(), invalid<ToId>());
+
+    for(size_type i = 0; i < backward.size(); ++i) {
+      auto const from = static_cast<size_type>(get(backward[i]));
+      if(from >= forward.size() || get(forward[from]) != get(invalid<ToId>())) {
+        throw std::invalid_argument("strong::permutation: order is not a permutation");
+      }
+      forward[from] = to_id<ToId>(i);
+    }
+  }
+
+  /**
+   * Construct the identity permutation.
+   *
+   * @param count The number of IDs.
+   * @return The permutation that maps each ID to the ID with the same underlying value.
+   */
+  static permutation identity(size_type count)
+  {
+    permutation result;
+    result.forward.reserve(count);
+    result.backward.reserve(count);
+    for(size_type i = 0; i < count; ++i) {
+      result.forward.push_back(to_id<ToId>(i));
+      result.backward.push_back(to_id<FromId>(i));
+    }
+    return result;
+  }
+
+  /**
+   * Map an original ID to its new ID.
+   *
+   * @param id The original ID.
+   * @return The new ID.
+   */
+  ToId operator()(FromId const &id) const noexcept
+  {
+    return forward[static_cast<size_type>(get(id))];
+  }
+
+  /**
+   * Map a new ID back to its original ID.
+   *
+   * @param id The new ID.
+   * @return The original ID.
+   */
+  FromId source(ToId const &id) const noexcept
+  {
+    return backward[static_cast<size_type>(get(id))];
+  }
+
+  /**
+   * @return The permutation that maps the new IDs back to the original IDs.
+   */
+  permutation<ToId, FromId> inverse() const
+  {
+    return permutation<ToId, FromId>(forward);
+  }
+
+  /**
+   * @return The original IDs listed in their new order.
+   */
+  std::vector<FromId> const & order() const noexcept
+  {
+    return backward;
+  }
+
+  /**
+   * @return The number of IDs.
+   */
+  size_type size() const noexcept
+  {
+    return forward.size();
+  }
+
+private:
+  template<class Id>
+  static Id to_id(size_type i)
+  {
+    return Id(static_cast<typename underlying_type<Id>::type>(i));
+  }
+
+  template<class Id>
+  static Id invalid()
+  {
+    return Id(static_cast<typename underlying_type<Id>::type>(-1));
+  }
+
+  std::vector<ToId> forward;
+  std::vector<FromId> backward;
+};
+
+/**
+ * Compose two permutations.
+ *
+ * @param first The permutation to apply first.
+ * @param second The permutation to apply second.
+ * @return The permutation equivalent to applying first and then second.
+ */
+template<class FromId, class MiddleId, class ToId>
+permutation<FromId, ToId> compose(permutation<FromId, MiddleId> const &first,
+                                  permutation<MiddleId, ToId> const &second)
+{
+  std::vector<FromId> order;
+  order.reserve(second.size());
+  for(auto const &middle : second.order()) {
+    order.push_back(first.source(middle));
+  }
+  return permutation<FromId, ToId>(std::move(order));
+}
+
+/**
+ * Reorder an array indexed by the original IDs into an array indexed by the new IDs.
+ *
+ * Implemented as a gather (result[new] = values[old]) so that the writes are sequential; the loop
+ * has no branches and can be vectorized with gather instructions where the target supports them.
+ *
+ * @param mapping The permutation to apply.
+ * @param values The array indexed by the original IDs, with one element per ID.
+ * @return The array indexed by the new IDs.
+ * @throws std::invalid_argument If values does not have one element per ID.
+ */
+template<class FromId, class ToId, typename T, class Allocator>
+vector<ToId, T, Allocator> permute(permutation<FromId, ToId> const &mapping,
+                                   vector<FromId, T, Allocator> const &values)
+{
+  if(values.size() != mapping.size()) {
+    throw std::invalid_argument("strong::permute: values and permutation differ in size");
+  }
+
+  vector<ToId, T, Allocator> result(values.get_allocator());
+  result.reserve(mapping.size());
+
+  auto const source = values.data();
+  for(auto const &from : mapping.order()) {
+    result.push_back(source[static_cast<std::size_t>(get(from))]);
+  }
+  return result;
+}
+
+/**
+ * Replace each original ID in a range with its new ID.
+ *
+ * Use this to rewrite data that stores IDs as values (e.g. adjacency lists) after relabeling.
+ *
+ * @param mapping The permutation to apply.
+ * @param first The beginning of the range of original IDs.
+ * @param last The end of the range of original IDs.
+ * @param output The beginning of the range that receives the new IDs.
+ * @return The end of the output range.
+ */
+template<class FromId, class ToId, class InputIt, class OutputIt>
+OutputIt relabel(permutation<FromId, ToId> const &mapping, InputIt first, InputIt last, OutputIt output)
+{
+  for(; first != last; ++first, ++output) {
+    *output = mapping(*first);
+  }
+  return output;
+}
+
+/**
+ * Interleave the bits of two coordinates into a Z-order (Morton) key.
+ *
+ * @param x The first coordinate.
+ * @param y The second coordinate.
+ * @return The Z-order key, where bit 2i is bit i of x and bit 2i + 1 is bit i of y.
+ */
+inline std::uint64_t z_order_key(std::uint32_t x, std::uint32_t y) noexcept
+{
+  return detail::spread_bits(x) | (detail::spread_bits(y) << 1);
+}
+
+/**
+ * Compute the distance of a point along a Hilbert curve that covers the 32-bit grid.
+ *
+ * Points that are close on the Hilbert curve are close in space, and unlike Z-order the curve has
+ * no long jumps between neighbouring keys.
+ *
+ * @param x The first coordinate.
+ * @param y The second coordinate.
+ * @return The Hilbert key.
+ */
+inline std::uint64_t hilbert_key(std::uint32_t x, std::uint32_t y) noexcept
+{
+  std::uint64_t key = 0;
+  for(std::uint32_t s = 1u << 31; s > 0; s >>= 1) {
+    std::uint32_t const rx = (x & s) ? 1 : 0;
+    std::uint32_t const ry = (y & s) ? 1 : 0;
+    key += static_cast<std::uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+    // rotate the quadrant so that the curve is continuous
+    if(ry == 0) {
+      if(rx == 1) {
+        x = ~x;
+        y = ~y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return key;
+}
+
+namespace detail {
+
+template<class ToId, class FromId, typename Key>
+permutation<FromId, ToId> sort_by_key(std::vector<std::pair<Key, std::size_t>> keys)
+{
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<FromId> order;
+  order.reserve(keys.size());
+  for(auto const &key : keys) {
+    order.push_back(FromId(static_cast<typename underlying_type<FromId>::type>(key.second)));
+  }
+  return permutation<FromId, ToId>(std::move(order));
+}
+
+template<typename Coordinate>
+struct grid {
+  explicit grid(Coordinate const *values, std::size_t count)
+  {
+    if(count > 0) {
+      auto const bounds = std::minmax_element(values, values + count);
+      low = static_cast<double>(*bounds.first);
+      double const range = static_cast<double>(*bounds.second) - low;
+      scale = range > 0 ? 4294967295.0 / range : 0;
+    }
+  }
+
+  std::uint32_t operator()(Coordinate const &value) const noexcept
+  {
+    // rounding can push the maximum past 2^32 - 1, and a NaN has no cell; both would make the
+    // cast undefined
+    auto const scaled = (static_cast<double>(value) - low) * scale;
+    return scaled >= 4294967295.0 ? 4294967295u : scaled > 0 ? static_cast<std::uint32_t>(scaled) : 0;
+  }
+
+  double low = 0;
+  double scale = 0;
+};
+
+template<class ToId, class FromId, typename Coordinate, class Allocator, class KeyFunction>
+permutation<FromId, ToId> order_by_curve(vector<FromId, Coordinate, Allocator> const &x,
+                                         vector<FromId, Coordinate, Allocator> const &y,
+                                         KeyFunction key_of)
+{
+  if(x.size() != y.size()) {
+    throw std::invalid_argument("strong::permutation: coordinate arrays differ in size");
+  }
+
+  grid<Coordinate> const x_grid(x.data(), x.size());
+  grid<Coordinate> const y_grid(y.data(), y.size());
+
+  std::vector<std::pair<std::uint64_t, std::size_t>> keys;
+  keys.reserve(x.size());
+  for(std::size_t i = 0; i < x.size(); ++i) {
+    keys.emplace_back(key_of(x_grid(x.data()[i]), y_grid(y.data()[i])), i);
+  }
+  return sort_by_key<ToId, FromId>(std::move(keys));
+}
+
+template<class FromId>
+std::size_t to_position(FromId const &id) noexcept
+{
+  return static_cast<std::size_t>(get(id));
+}
+
+}
+
+/**
+ * Order IDs by their position along a Z-order curve.
+ *
+ * Coordinates are scaled to a 32-bit grid using their minimum and maximum values.
+ *
+ * @tparam ToId The strong typedef of the relabeled IDs.
+ * @param x The first coordinate of each ID.
+ * @param y The second coordinate of each ID.
+ * @return The permutation that sorts the IDs by Z-order key.
+ */
+template<class ToId, class FromId, typename Coordinate, class Allocator>
+permutation<FromId, ToId> z_order(vector<FromId, Coordinate, Allocator> const &x,
+                                  vector<FromId, Coordinate, Allocator> const &y)
+{
+  return detail::order_by_curve<ToId>(x, y, z_order_key);
+}
+
+/**
+ * Order IDs by their position along a Hilbert curve.
+ *
+ * Coordinates are scaled to a 32-bit grid using their minimum and maximum values.
+ *
+ * @tparam ToId The strong typedef of the relabeled IDs.
+ * @param x The first coordinate of each ID.
+ * @param y The second coordinate of each ID.
+ * @return The permutation that sorts the IDs by Hilbert key.
+ */
+template<class ToId, class FromId, typename Coordinate, class Allocator>
+permutation<FromId, ToId> hilbert_order(vector<FromId, Coordinate, Allocator> const &x,
+                                        vector<FromId, Coordinate, Allocator> const &y)
+{
+  return detail::order_by_curve<ToId>(x, y, hilbert_key);
+}
+
+/**
+ * Order the vertices of a graph by decreasing degree.
+ *
+ * Placing high-degree vertices first packs the most frequently accessed data together. Vertices
+ * with equal degree keep their original relative order.
+ *
+ * @tparam ToId The strong typedef of the relabeled IDs.
+ * @param adjacency The neighbours of each vertex.
+ * @return The permutation that sorts the vertices by decreasing degree.
+ */
+template<class ToId, class FromId, class Neighbours, class Allocator>
+permutation<FromId, ToId> degree_order(vector<FromId, Neighbours, Allocator> const &adjacency)
+{
+  std::vector<std::pair<std::size_t, std::size_t>> keys;
+  keys.reserve(adjacency.size());
+
+  std::size_t i = 0;
+  for(auto const &neighbours : adjacency) {
+    // negate the degree so that the ascending sort places high degrees first
+    keys.emplace_back(~static_cast<std::size_t>(neighbours.size()), i++);
+  }
+  return detail::sort_by_key<ToId, FromId>(std::move(keys));
+}
+
+/**
+ * Order the vertices of a graph by a breadth-first traversal.
+ *
+ * Each connected component is traversed in turn, starting from its lowest original ID.
+ *
+ * @tparam ToId The strong typedef of the relabeled IDs.
+ * @param adjacency The neighbours of each vertex.
+ * @return The permutation that numbers vertices in the order they are discovered.
+ */
+template<class ToId, class FromId, class Neighbours, class Allocator>
+permutation<FromId, ToId> bfs_order(vector<FromId, Neighbours, Allocator> const &adjacency)
+{
+  std::vector<FromId> order;
+  order.reserve(adjacency.size());
+  std::vector<bool> visited(adjacency.size(), false);
+
+  for(std::size_t root = 0; root < adjacency.size(); ++root) {
+    if(visited[root]) {
+      continue;
+    }
+
+    visited[root] = true;
+    order.push_back(FromId(static_cast<typename underlying_type<FromId>::type>(root)));
+
+    for(auto head = order.size() - 1; head < order.size(); ++head) {
+      for(auto const &neighbour : adjacency[order[head]]) {
+        auto const position = detail::to_position(neighbour);
+        if(!visited[position]) {
+          visited[position] = true;
+          order.push_back(neighbour);
+        }
+      }
+    }
+  }
+
+  return permutation<FromId, ToId>(std::move(order));
+}
+
+/**
+ * Order the vertices of a graph with the reverse Cuthill-McKee algorithm.
+ *
+ * Reduces the bandwidth of the adjacency matrix, so that the neighbours of a vertex have IDs close
+ * to its own. Each connected component starts from a vertex of minimum degree and neighbours are
+ * visited in increasing order of degree.
+ *
+ * @tparam ToId The strong typedef of the relabeled IDs.
+ * @param adjacency The neighbours of each vertex.
+ * @return The reverse Cuthill-McKee permutation.
+ */
+template<class ToId, class FromId, class Neighbours, class Allocator>
+permutation<FromId, ToId> rcm_order(vector<FromId, Neighbours, Allocator> const &adjacency)
+{
+  auto const count = adjacency.size();
+  auto degree = [&](FromId const &id) { return adjacency[id].size(); };
+
+  // visit candidate roots in increasing order of degree
+  std::vector<FromId> roots;
+  roots.reserve(count);
+  for(std::size_t i = 0; i < count; ++i) {
+    roots.push_back(FromId(static_cast<typename underlying_type<FromId>::type>(i)));
+  }
+  std::stable_sort(roots.begin(), roots.end(), [&](FromId const &lhs, FromId const &rhs) {
+    return degree(lhs) < degree(rhs);
+  });
+
+  std::vector<FromId> order;
+  order.reserve(count);
+  std::vector<bool> visited(count, false);
+
+  for(auto const &root : roots) {
+    if(visited[detail::to_position(root)]) {
+      continue;
+    }
+
+    visited[detail::to_position(root)] = true;
+    order.push_back(root);
+
+    for(auto head = order.size() - 1; head < order.size(); ++head) {
+      auto const discovered = order.size();
+      for(auto const &neighbour : adjacency[order[head]]) {
+        auto const position = detail::to_position(neighbour);
+        if(!visited[position]) {
+          visited[position] = true;
+          order.push_back(neighbour);
+        }
+      }
+      std::stable_sort(order.begin() + static_cast<std::ptrdiff_t>(discovered), order.end(),
+                       [&](FromId const &lhs, FromId const &rhs) { return degree(lhs) < degree(rhs); });
+    }
+  }
+
+  std::reverse(order.begin(), order.end());
+  return permutation<FromId, ToId>(std::move(order));
+}
+
+}
+
+#endif //STRONG_PERMUTATION_HPP
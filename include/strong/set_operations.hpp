@@ -0,0 +1,253 @@
+#ifndef STRONG_SET_OPERATIONS_HPP
+#define STRONG_SET_OPERATIONS_HPP
+
+#include <strong.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace strong {
+
+/**
+ * The size ratio above which the set operations switch from merging to galloping search.
+ *
+ * When one list is this many times longer than the other, searching the longer list for each
+ * element of the shorter one (in O(n log(m / n)) time) beats walking both lists.
+ */
+constexpr std::size_t galloping_ratio = 32;
+
+namespace detail {
+
+template<class Id>
+struct check_sorted_ids {
+  static_assert(std::is_integral<typename underlying_type<Id>::type>::value,
+                "set operations require a strong typedef with an integral underlying type");
+};
+
+template<class Id>
+Id const * gallop(Id const *first, Id const *last, Id const &value) noexcept
+{
+  // double the step until it passes the value, then binary search the last step
+  std::size_t step = 1;
+  auto const count = static_cast<std::size_t>(last - first);
+  while(step < count && get(first[step]) < get(value)) {
+    step *= 2;
+  }
+
+  auto const low = first + step / 2;
+  auto const high = first + std::min(step + 1, count);
+  return std::lower_bound(low, high, value, [](Id const &lhs, Id const &rhs) { return get(lhs) < get(rhs); });
+}
+
+constexpr std::size_t block = 4;
+
+// Compare a block of lhs against a block of rhs, all pairs at once. The fixed trip counts and
+// lack of branches let the compiler vectorize the comparisons.
+template<class Id>
+unsigned block_matches(Id const *lhs, Id const *rhs) noexcept
+{
+  unsigned matches = 0;
+  for(std::size_t i = 0; i < block; ++i) {
+    unsigned match = 0;
+    for(std::size_t j = 0; j < block; ++j) {
+      match |= get(lhs[i]) == get(rhs[j]);
+    }
+    matches |= match << i;
+  }
+  return matches;
+}
+
+template<class Id, class Emit>
+void intersect(Id const *first1, Id const *last1, Id const *first2, Id const *last2, Emit emit)
+{
+  auto size1 = static_cast<std::size_t>(last1 - first1);
+  auto size2 = static_cast<std::size_t>(last2 - first2);
+  if(size1 > size2) {
+    std::swap(first1, first2);
+    std::swap(last1, last2);
+    std::swap(size1, size2);
+  }
+
+  if(size1 * galloping_ratio < size2) {
+    for(; first1 != last1 && first2 != last2; ++first1) {
+      first2 = gallop(first2, last2, *first1);
+      if(first2 != last2 && get(*first2) == get(*first1)) {
+        emit(*first1, true);
+        ++first2;
+      }
+    }
+    return;
+  }
+
+  // each value appears at most once per list, so it can only match in one pair of blocks
+  while(last1 - first1 >= static_cast<std::ptrdiff_t>(block) && last2 - first2 >= static_cast<std::ptrdiff_t>(block)) {
+    auto const matches = block_matches(first1, first2);
+    for(std::size_t i = 0; i < block; ++i) {
+      emit(first1[i], (matches >> i) & 1u);
+    }
+
+    auto const max1 = get(first1[block - 1]);
+    auto const max2 = get(first2[block - 1]);
+    first1 += max1 <= max2 ? block : 0;
+    first2 += max2 <= max1 ? block : 0;
+  }
+
+  while(first1 != last1 && first2 != last2) {
+    auto const a = get(*first1);
+    auto const b = get(*first2);
+    emit(*first1, a == b);
+    first1 += a <= b;
+    first2 += b <= a;
+  }
+}
+
+}
+
+/**
+ * Intersect two sorted lists of strong IDs.
+ *
+ * Both lists must be sorted in increasing order and contain no duplicates. Lists of similar size
+ * are merged without data-dependent branches, comparing blocks of IDs at once; when one list is
+ * much shorter, its IDs are located in the longer list by galloping search.
+ *
+ * @param first1 The beginning of the first list.
+ * @param last1 The end of the first list.
+ * @param first2 The beginning of the second list.
+ * @param last2 The end of the second list.
+ * @param output Receives the common IDs in increasing order; must have room for the shorter list.
+ * @return The end of the output.
+ */
+template<class Id>
+Id * sorted_intersection(Id const *first1, Id const *last1, Id const *first2, Id const *last2, Id *output)
+{
+  detail::check_sorted_ids<Id>();
+  detail::intersect(first1, last1, first2, last2, [&output](Id const &id, bool match) {
+    // always store, but only keep the store if it was a match
+    *output = id;
+    output += match;
+  });
+  return output;
+}
+
+/**
+ * Count the IDs common to two sorted lists of strong IDs.
+ *
+ * @param first1 The beginning of the first list.
+ * @param last1 The end of the first list.
+ * @param first2 The beginning of the second list.
+ * @param last2 The end of the second list.
+ * @return The size of the intersection.
+ * @see sorted_intersection
+ */
+template<class Id>
+std::size_t sorted_intersection_size(Id const *first1, Id const *last1, Id const *first2, Id const *last2)
+{
+  detail::check_sorted_ids<Id>();
+  std::size_t count = 0;
+  detail::intersect(first1, last1, first2, last2, [&count](Id const &, bool match) { count += match; });
+  return count;
+}
+
+/**
+ * Merge two sorted lists of strong IDs into their union.
+ *
+ * Both lists must be sorted in increasing order and contain no duplicates. IDs present in both
+ * lists are written once.
+ *
+ * @param first1 The beginning of the first list.
+ * @param last1 The end of the first list.
+ * @param first2 The beginning of the second list.
+ * @param last2 The end of the second list.
+ * @param output Receives the union in increasing order; must have room for both lists.
+ * @return The end of the output.
+ */
+template<class Id>
+Id * sorted_union(Id const *first1, Id const *last1, Id const *first2, Id const *last2, Id *output)
+{
+  detail::check_sorted_ids<Id>();
+  while(first1 != last1 && first2 != last2) {
+    auto const a = get(*first1);
+    auto const b = get(*first2);
+    *output++ = a <= b ? *first1 : *first2;
+    first1 += a <= b;
+    first2 += b <= a;
+  }
+  output = std::copy(first1, last1, output);
+  return std::copy(first2, last2, output);
+}
+
+/**
+ * Count the IDs in the union of two sorted lists of strong IDs.
+ *
+ * @param first1 The beginning of the first list.
+ * @param last1 The end of the first list.
+ * @param first2 The beginning of the second list.
+ * @param last2 The end of the second list.
+ * @return The size of the union.
+ * @see sorted_union
+ */
+template<class Id>
+std::size_t sorted_union_size(Id const *first1, Id const *last1, Id const *first2, Id const *last2)
+{
+  return static_cast<std::size_t>(last1 - first1) + static_cast<std::size_t>(last2 - first2)
+         - sorted_intersection_size(first1, last1, first2, last2);
+}
+
+/**
+ * Find the IDs of one sorted list that are not in another.
+ *
+ * Both lists must be sorted in increasing order and contain no duplicates. When the second list
+ * is much longer than the first, the first list's IDs are located in it by galloping search.
+ *
+ * @param first1 The beginning of the list to keep IDs from.
+ * @param last1 The end of the list to keep IDs from.
+ * @param first2 The beginning of the list of IDs to remove.
+ * @param last2 The end of the list of IDs to remove.
+ * @param output Receives the difference in increasing order; must have room for the first list.
+ * @return The end of the output.
+ */
+template<class Id>
+Id * sorted_difference(Id const *first1, Id const *last1, Id const *first2, Id const *last2, Id *output)
+{
+  detail::check_sorted_ids<Id>();
+  if(static_cast<std::size_t>(last1 - first1) * galloping_ratio < static_cast<std::size_t>(last2 - first2)) {
+    for(; first1 != last1; ++first1) {
+      first2 = detail::gallop(first2, last2, *first1);
+      *output = *first1;
+      output += first2 == last2 || get(*first2) != get(*first1);
+    }
+    return output;
+  }
+
+  while(first1 != last1 && first2 != last2) {
+    auto const a = get(*first1);
+    auto const b = get(*first2);
+    *output = *first1;
+    output += a < b;
+    first1 += a <= b;
+    first2 += b <= a;
+  }
+  return std::copy(first1, last1, output);
+}
+
+/**
+ * Count the IDs of one sorted list that are not in another.
+ *
+ * @param first1 The beginning of the list to keep IDs from.
+ * @param last1 The end of the list to keep IDs from.
+ * @param first2 The beginning of the list of IDs to remove.
+ * @param last2 The end of the list of IDs to remove.
+ * @return The size of the difference.
+ * @see sorted_difference
+ */
+template<class Id>
+std::size_t sorted_difference_size(Id const *first1, Id const *last1, Id const *first2, Id const *last2)
+{
+  return static_cast<std::size_t>(last1 - first1) - sorted_intersection_size(first1, last1, first2, last2);
+}
+
+}
+
+#endif //STRONG_SET_OPERATIONS_HPP
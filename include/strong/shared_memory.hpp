@@ -0,0 +1,827 @@
+#ifndef STRONG_SHARED_MEMORY_HPP
+#define STRONG_SHARED_MEMORY_HPP
+
+#include <strong.hpp>
+#include <strong/hash.hpp>
+#include <strong/tag.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace strong {
+
+/**
+ * A reference to an object in a shared memory segment, stored as its offset from the start.
+ *
+ * Each process may map a segment at a different address, so the containers in a segment link
+ * their parts with offsets rather than pointers. The default offset is null.
+ *
+ * @tparam T The type of the object.
+ */
+template<typename T>
+class shared_offset
+  : public type<shared_offset<T>, std::uint64_t>
+  , public op::equals<shared_offset<T>> {
+public:
+  using type<shared_offset<T>, std::uint64_t>::type;
+
+  /**
+   * @return Whether the offset refers to an object.
+   */
+  explicit constexpr operator bool() const noexcept
+  {
+    return get(*this) != 0;
+  }
+};
+
+/**
+ * A mutex that works across processes when placed in shared memory.
+ *
+ * It is a spin lock on a lock-free atomic, which is address-free, so it does not depend on
+ * process-shared pthread mutexes and works wherever the segment is mapped. Waiters yield the
+ * processor while the lock is held, so it suits the short critical sections of the shared
+ * containers rather than long waits. It meets the Lockable requirements, e.g. for std::lock_guard.
+ *
+ * The lock is not robust: if a process dies while holding it, every other process that tries to
+ * acquire it waits forever, so nothing that can crash or be killed should run while it is held.
+ */
+class interprocess_mutex {
+public:
+  static_assert(ATOMIC_INT_LOCK_FREE == 2, "process-shared atomics must be lock-free");
+
+  interprocess_mutex() noexcept : state(0)
+  {
+  }
+
+  interprocess_mutex(interprocess_mutex const &) = delete;
+  interprocess_mutex & operator=(interprocess_mutex const &) = delete;
+
+  /**
+   * Acquire the lock, waiting until it is free.
+   */
+  void lock() noexcept
+  {
+    while(state.exchange(1, std::memory_order_acquire) != 0) {
+      // wait without writing, so the waiters do not bounce the cache line between them
+      for(unsigned spins = 0; state.load(std::memory_order_relaxed) != 0; ++spins) {
+        if(spins >= 64) {
+          ::sched_yield();
+        }
+      }
+    }
+  }
+
+  /**
+   * Acquire the lock if it is free.
+   *
+   * @return Whether the lock was acquired.
+   */
+  bool try_lock() noexcept
+  {
+    return state.load(std::memory_order_relaxed) == 0 && state.exchange(1, std::memory_order_acquire) == 0;
+  }
+
+  /**
+   * Release the lock.
+   */
+  void unlock() noexcept
+  {
+    state.store(0, std::memory_order_release);
+  }
+
+private:
+  std::atomic<std::uint32_t> state;
+};
+
+namespace detail {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "process-shared atomics must be lock-free");
+
+constexpr std::uint64_t shared_memory_magic = 0x4d48535f52545301; // "\1STR_SHM"
+constexpr std::size_t shared_directory_size = 32;
+constexpr std::size_t shared_name_size = 48;
+
+struct shared_directory_entry {
+  char name[shared_name_size];
+  std::uint64_t fingerprint;
+  std::atomic<std::uint64_t> offset;
+};
+
+struct shared_header {
+  std::uint64_t magic;
+  std::uint64_t size;
+  std::atomic<std::uint64_t> used;
+  interprocess_mutex directory_lock;
+  shared_directory_entry directory[shared_directory_size];
+};
+
+// Where a container lives: the start of the local mapping of its segment, and its own offset in
+// it. Containers keep their offset so that they can find the segment from this in any process.
+struct shared_context {
+  unsigned char *base;
+  std::uint64_t self;
+};
+
+inline unsigned char * shared_base(void const *object, std::uint64_t self) noexcept
+{
+  return const_cast<unsigned char *>(static_cast<unsigned char const *>(object)) - self;
+}
+
+template<typename T>
+T * resolve(unsigned char *base, shared_offset<T> const &offset) noexcept
+{
+  return reinterpret_cast<T *>(base + get(offset));
+}
+
+// Allocate from the segment by bumping the used size. Memory is never returned.
+inline std::uint64_t shared_allocate(unsigned char *base, std::size_t size, std::size_t alignment)
+{
+  auto &header = *reinterpret_cast<shared_header *>(base);
+  alignment = alignment < 8 ? 8 : alignment;
+  auto used = header.used.load(std::memory_order_relaxed);
+  std::uint64_t offset;
+  do {
+    offset = (used + alignment - 1) / alignment * alignment;
+    if(offset + size > header.size || offset + size < offset) {
+      throw std::length_error("strong::shared_memory: segment is full");
+    }
+  } while(!header.used.compare_exchange_weak(used, offset + size, std::memory_order_relaxed));
+  return offset;
+}
+
+template<typename T>
+struct check_shared_type {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "shared memory containers can only hold trivially copyable types, which have no pointers of their own");
+};
+
+}
+
+/**
+ * A shared memory segment that holds named containers for several processes.
+ *
+ * The segment is a POSIX shared memory object, created by name with shm_open or anonymously (with
+ * memfd_create where available) to be inherited by child processes or passed over a socket. Each
+ * process maps it at an address of its own choosing. Containers are constructed in the segment
+ * under a name by one process and found by that name in the others.
+ *
+ * Memory is allocated from the segment by bumping a shared counter and is never returned, which
+ * suits pipelines that fill buffers and then read them. The segment is unmapped, but not removed,
+ * when the object is destroyed.
+ */
+class shared_memory {
+public:
+  /**
+   * Create a named segment.
+   *
+   * @param name The name of the segment, e.g. "/pipeline"; a leading slash is added if missing.
+   * @param size The size of the segment in bytes.
+   * @return The segment, mapped into this process.
+   * @throws std::runtime_error If a segment of that name exists or cannot be created.
+   */
+  static shared_memory create(std::string const &name, std::size_t size)
+  {
+    auto const path = object_name(name);
+    auto const descriptor = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(descriptor < 0) {
+      throw std::runtime_error("strong::shared_memory: cannot create " + path);
+    }
+    try {
+      return shared_memory(descriptor, size);
+    } catch(...) {
+      ::shm_unlink(path.c_str());
+      throw;
+    }
+  }
+
+  /**
+   * Create an anonymous segment, to be shared through its descriptor.
+   *
+   * @param size The size of the segment in bytes.
+   * @return The segment, mapped into this process.
+   * @throws std::runtime_error If the segment cannot be created.
+   */
+  static shared_memory create_anonymous(std::size_t size)
+  {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    auto const descriptor = ::memfd_create("strong", MFD_CLOEXEC);
+#else
+    // an object that is unlinked at once has no name left to collide with
+    static std::atomic<unsigned> counter{0};
+    auto const path = "/strong-" + std::to_string(::getpid()) + "-" + std::to_string(counter++);
+    auto const descriptor = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(descriptor >= 0) {
+      ::shm_unlink(path.c_str());
+    }
+#endif
+    if(descriptor < 0) {
+      throw std::runtime_error("strong::shared_memory: cannot create an anonymous segment");
+    }
+    return shared_memory(descriptor, size);
+  }
+
+  /**
+   * Map a named segment created by another process.
+   *
+   * @param name The name given to create.
+   * @return The segment, mapped into this process.
+   * @throws std::runtime_error If the segment does not exist or cannot be mapped.
+   */
+  static shared_memory open(std::string const &name)
+  {
+    auto const path = object_name(name);
+    auto const descriptor = ::shm_open(path.c_str(), O_RDWR, 0600);
+    if(descriptor < 0) {
+      throw std::runtime_error("strong::shared_memory: cannot open " + path);
+    }
+    return shared_memory(descriptor);
+  }
+
+  /**
+   * Map a segment from a descriptor, e.g. one received from another process.
+   *
+   * @param descriptor The descriptor of the segment; it is duplicated, so the caller keeps its own.
+   * @return The segment, mapped into this process.
+   * @throws std::runtime_error If the descriptor is not a segment or cannot be mapped.
+   */
+  static shared_memory open(int descriptor)
+  {
+    auto const duplicate = ::fcntl(descriptor, F_DUPFD_CLOEXEC, 0);
+    if(duplicate < 0) {
+      throw std::runtime_error("strong::shared_memory: cannot duplicate the descriptor");
+    }
+    return shared_memory(duplicate);
+  }
+
+  /**
+   * Remove the name of a segment. Processes that have it mapped can keep using it.
+   *
+   * @param name The name given to create.
+   */
+  static void remove(std::string const &name) noexcept
+  {
+    ::shm_unlink(object_name(name).c_str());
+  }
+
+  shared_memory(shared_memory const &) = delete;
+  shared_memory & operator=(shared_memory const &) = delete;
+
+  shared_memory(shared_memory &&other) noexcept
+    : descriptor_(other.descriptor_), base(other.base), length(other.length)
+  {
+    other.descriptor_ = -1;
+    other.base = nullptr;
+  }
+
+  shared_memory & operator=(shared_memory &&other) noexcept
+  {
+    std::swap(descriptor_, other.descriptor_);
+    std::swap(base, other.base);
+    std::swap(length, other.length);
+    return *this;
+  }
+
+  /**
+   * Unmap the segment and close its descriptor.
+   */
+  ~shared_memory()
+  {
+    if(base != nullptr) {
+      ::munmap(base, length);
+    }
+    if(descriptor_ >= 0) {
+      ::close(descriptor_);
+    }
+  }
+
+  /**
+   * Construct a container, or any trivially copyable object, in the segment under a name.
+   *
+   * Containers of this header are given their place in the segment as a first argument before
+   * args; other types are constructed from args alone.
+   *
+   * @tparam T The type of the object.
+   * @param name The name to find the object by, of at most 47 characters.
+   * @param args The arguments forwarded to the constructor.
+   * @return The object.
+   * @throws std::invalid_argument If the name is too long or already taken.
+   * @throws std::length_error If the segment or its directory is full.
+   */
+  template<class T, typename... Args>
+  T & construct(std::string const &name, Args &&... args)
+  {
+    if(name.empty() || name.size() >= detail::shared_name_size) {
+      throw std::invalid_argument("strong::shared_memory: names must have 1 to 47 characters");
+    }
+
+    auto &header = this->header();
+    std::lock_guard<interprocess_mutex> lock(header.directory_lock);
+    detail::shared_directory_entry *free = nullptr;
+    for(auto &entry : header.directory) {
+      if(entry.offset.load(std::memory_order_relaxed) == 0) {
+        free = free == nullptr ? &entry : free;
+      } else if(name == entry.name) {
+        throw std::invalid_argument("strong::shared_memory: " + name + " already exists");
+      }
+    }
+    if(free == nullptr) {
+      throw std::length_error("strong::shared_memory: directory is full");
+    }
+
+    auto const offset = detail::shared_allocate(base_address(), sizeof(T), alignof(T));
+    auto const object = create<T>(base_address() + offset, offset, std::is_constructible<T, detail::shared_context const &, Args...>(),
+                                  std::forward<Args>(args)...);
+    std::memcpy(free->name, name.c_str(), name.size() + 1);
+    free->fingerprint = fingerprint<T>();
+    free->offset.store(offset, std::memory_order_release);
+    return *object;
+  }
+
+  /**
+   * Find an object constructed in the segment, by this or another process.
+   *
+   * @tparam T The type the object was constructed as.
+   * @param name The name it was constructed under.
+   * @return The object.
+   * @throws std::out_of_range If there is no object of that name.
+   * @throws std::invalid_argument If the object has a different type.
+   */
+  template<class T>
+  T & find(std::string const &name) const
+  {
+    for(auto const &entry : header().directory) {
+      auto const offset = entry.offset.load(std::memory_order_acquire);
+      if(offset != 0 && name == entry.name) {
+        if(entry.fingerprint != fingerprint<T>()) {
+          throw std::invalid_argument("strong::shared_memory: " + name + " has a different type");
+        }
+        return *reinterpret_cast<T *>(base_address() + offset);
+      }
+    }
+    throw std::out_of_range("strong::shared_memory: no object named " + name);
+  }
+
+  /**
+   * @return The descriptor of the segment, to pass to other processes.
+   */
+  int descriptor() const noexcept
+  {
+    return descriptor_;
+  }
+
+  /**
+   * @return The size of the segment in bytes.
+   */
+  std::size_t size() const noexcept
+  {
+    return length;
+  }
+
+  /**
+   * @return The number of bytes allocated from the segment so far.
+   */
+  std::size_t used() const noexcept
+  {
+    return static_cast<std::size_t>(header().used.load(std::memory_order_relaxed));
+  }
+
+private:
+  // create and size a new segment
+  shared_memory(int descriptor, std::size_t size) : descriptor_(descriptor)
+  {
+    if(size < sizeof(detail::shared_header) || ::ftruncate(descriptor, static_cast<off_t>(size)) != 0) {
+      ::close(descriptor);
+      descriptor_ = -1;
+      throw std::runtime_error("strong::shared_memory: cannot size the segment");
+    }
+    map(size);
+    auto const header = ::new(static_cast<void *>(base)) detail::shared_header();
+    header->size = size;
+    header->used.store(sizeof(detail::shared_header), std::memory_order_relaxed);
+    for(auto &entry : header->directory) {
+      entry.offset.store(0, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = detail::shared_memory_magic;
+  }
+
+  // map an existing segment
+  explicit shared_memory(int descriptor) : descriptor_(descriptor)
+  {
+    struct stat status;
+    if(::fstat(descriptor, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(detail::shared_header)) {
+      ::close(descriptor);
+      descriptor_ = -1;
+      throw std::runtime_error("strong::shared_memory: not a segment");
+    }
+    map(static_cast<std::size_t>(status.st_size));
+    if(header().magic != detail::shared_memory_magic || header().size != length) {
+      // the destructor does not run for a constructor that throws
+      ::munmap(base, length);
+      ::close(descriptor);
+      base = nullptr;
+      descriptor_ = -1;
+      throw std::runtime_error("strong::shared_memory: not a segment");
+    }
+  }
+
+  void map(std::size_t size)
+  {
+    auto const address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor_, 0);
+    if(address == MAP_FAILED) {
+      ::close(descriptor_);
+      descriptor_ = -1;
+      throw std::runtime_error("strong::shared_memory: cannot map the segment");
+    }
+    base = address;
+    length = size;
+  }
+
+  template<class T, typename... Args>
+  static T * create(unsigned char *address, std::uint64_t offset, std::true_type, Args &&... args)
+  {
+    return ::new(static_cast<void *>(address)) T(detail::shared_context{address - offset, offset}, std::forward<Args>(args)...);
+  }
+
+  template<class T, typename... Args>
+  static T * create(unsigned char *address, std::uint64_t, std::false_type, Args &&... args)
+  {
+    detail::check_shared_type<T>();
+    return ::new(static_cast<void *>(address)) T(std::forward<Args>(args)...);
+  }
+
+  template<class T>
+  static std::uint64_t fingerprint()
+  {
+    auto const &name = tag_name<T>();
+    return detail::fnv1a(name.data(), name.size());
+  }
+
+  static std::string object_name(std::string const &name)
+  {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+  }
+
+  unsigned char * base_address() const noexcept
+  {
+    return static_cast<unsigned char *>(base);
+  }
+
+  detail::shared_header & header() const noexcept
+  {
+    return *static_cast<detail::shared_header *>(base);
+  }
+
+  int descriptor_;
+  void *base = nullptr;
+  std::size_t length = 0;
+};
+
+/**
+ * A growable array in a shared memory segment, indexed by a strong typedef.
+ *
+ * Appending takes a process-shared lock, so several processes may produce; reading takes no lock,
+ * and an element is visible to every process once size() covers it. Elements that have been
+ * published should not be modified while other processes read them. Growing copies the elements
+ * to a larger block, and the old block is left in the segment, so reserve the expected capacity
+ * up front.
+ *
+ * @tparam Index A strong typedef whose underlying type is a non-negative integer.
+ * @tparam T The type of the elements, which must be trivially copyable.
+ */
+template<class Index, typename T>
+class shared_vector {
+public:
+  using index_type = Index;
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /**
+   * Construct an empty array; use shared_memory::construct, which provides the context.
+   *
+   * @param context The place of the array in its segment.
+   * @param capacity The number of elements to reserve space for.
+   */
+  shared_vector(detail::shared_context const &context, size_type capacity = 0)
+    : self(context.self), elements(0), count(0), reserved(0)
+  {
+    detail::check_shared_type<T>();
+    if(capacity != 0) {
+      elements.store(detail::shared_allocate(context.base, capacity * sizeof(T), alignof(T)), std::memory_order_relaxed);
+      reserved = capacity;
+    }
+  }
+
+  shared_vector(shared_vector const &) = delete;
+  shared_vector & operator=(shared_vector const &) = delete;
+
+  /**
+   * Append an element.
+   *
+   * @param value The element.
+   * @return The index of the element.
+   * @throws std::length_error If the segment is full.
+   */
+  Index push_back(T const &value)
+  {
+    return append(&value, 1);
+  }
+
+  /**
+   * Append several elements at once, publishing them together.
+   *
+   * @param values The first of the elements.
+   * @param number The number of elements.
+   * @return The index of the first element appended.
+   * @throws std::length_error If the segment is full.
+   */
+  Index append(T const *values, size_type number)
+  {
+    std::lock_guard<interprocess_mutex> guard(lock);
+    auto const size = count.load(std::memory_order_relaxed);
+    if(size + number > reserved) {
+      grow(size + number);
+    }
+    std::memcpy(mutable_data() + size, values, number * sizeof(T));
+    count.store(size + number, std::memory_order_release);
+    return Index(static_cast<typename underlying_type<Index>::type>(size));
+  }
+
+  /**
+   * Remove every element, keeping the capacity, so that the array can be filled again.
+   *
+   * No other process may be reading the array.
+   */
+  void clear() noexcept
+  {
+    std::lock_guard<interprocess_mutex> guard(lock);
+    count.store(0, std::memory_order_release);
+  }
+
+  /**
+   * Access an element without bounds checking.
+   *
+   * @param index The index of a published element.
+   * @return A reference to the element.
+   */
+  T const & operator[](Index const &index) const noexcept
+  {
+    return data()[static_cast<size_type>(get(index))];
+  }
+
+  /**
+   * Access an element.
+   *
+   * @param index The index of the element.
+   * @return A reference to the element.
+   * @throws std::out_of_range If the index is not less than the size.
+   */
+  T const & at(Index const &index) const
+  {
+    if(static_cast<size_type>(get(index)) >= size()) {
+      throw std::out_of_range("strong::shared_vector: index out of range");
+    }
+    return (*this)[index];
+  }
+
+  /**
+   * @return The number of published elements.
+   */
+  size_type size() const noexcept
+  {
+    return static_cast<size_type>(count.load(std::memory_order_acquire));
+  }
+
+  /**
+   * @return True if no element has been published.
+   */
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  /**
+   * @return A pointer to the first element, valid for the elements published when size() was read
+   *         before it.
+   */
+  T const * data() const noexcept
+  {
+    return detail::resolve(detail::shared_base(this, self), shared_offset<T>(elements.load(std::memory_order_acquire)));
+  }
+
+  /**
+   * @return A pointer to the first element.
+   */
+  T const * begin() const noexcept
+  {
+    return data();
+  }
+
+  /**
+   * @return A pointer past the last published element.
+   */
+  T const * end() const noexcept
+  {
+    auto const size = this->size();
+    return data() + size;
+  }
+
+private:
+  T * mutable_data() noexcept
+  {
+    return const_cast<T *>(data());
+  }
+
+  void grow(size_type needed)
+  {
+    auto const capacity = needed > 2 * reserved ? needed : 2 * reserved;
+    auto const base = detail::shared_base(this, self);
+    auto const offset = detail::shared_allocate(base, capacity * sizeof(T), alignof(T));
+    if(reserved != 0) {
+      std::memcpy(base + offset, data(), count.load(std::memory_order_relaxed) * sizeof(T));
+    }
+    // readers that already loaded the old block keep reading valid, unchanged elements from it
+    elements.store(offset, std::memory_order_release);
+    reserved = capacity;
+  }
+
+  std::uint64_t const self;
+  std::atomic<std::uint64_t> elements;
+  std::atomic<std::uint64_t> count;
+  std::uint64_t reserved;
+  interprocess_mutex lock;
+};
+
+/**
+ * A hash map in a shared memory segment, with chains linked by offsets.
+ *
+ * Inserting takes a process-shared lock, so several processes may produce; lookups take no lock
+ * and see an entry as soon as it is inserted. Entries cannot be changed or removed, and the
+ * number of buckets is fixed when the map is constructed.
+ *
+ * @tparam Key The strong typedef of the keys, which must be trivially copyable.
+ * @tparam T The type of the values, which must be trivially copyable.
+ * @tparam Hash The hash function, which must give the same results in every process.
+ */
+template<class Key, typename T, class Hash = hash<Key>>
+class shared_hash_map {
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using size_type = std::size_t;
+
+  /**
+   * Construct an empty map; use shared_memory::construct, which provides the context.
+   *
+   * @param context The place of the map in its segment.
+   * @param expected The number of entries expected, which sets the number of buckets.
+   * @throws std::length_error If the segment is full.
+   */
+  shared_hash_map(detail::shared_context const &context, size_type expected)
+    : self(context.self), buckets(0), mask(0), count(0)
+  {
+    detail::check_shared_type<Key>();
+    detail::check_shared_type<T>();
+    size_type bucket_count = 1;
+    while(bucket_count < expected) {
+      bucket_count *= 2;
+    }
+    buckets = detail::shared_allocate(context.base, bucket_count * sizeof(std::atomic<std::uint64_t>),
+                                      alignof(std::atomic<std::uint64_t>));
+    for(size_type i = 0; i < bucket_count; ++i) {
+      ::new(static_cast<void *>(bucket(context.base, i))) std::atomic<std::uint64_t>(0);
+    }
+    mask = bucket_count - 1;
+  }
+
+  shared_hash_map(shared_hash_map const &) = delete;
+  shared_hash_map & operator=(shared_hash_map const &) = delete;
+
+  /**
+   * Insert an entry if its key is not in the map.
+   *
+   * @param key The key.
+   * @param value The value.
+   * @return Whether the entry was inserted.
+   * @throws std::length_error If the segment is full.
+   */
+  bool insert(Key const &key, T const &value)
+  {
+    auto const base = detail::shared_base(this, self);
+    auto &head = *bucket(base, index_of(key));
+    std::lock_guard<interprocess_mutex> guard(lock);
+    if(find_in(base, head.load(std::memory_order_relaxed), key) != nullptr) {
+      return false;
+    }
+
+    auto const offset = detail::shared_allocate(base, sizeof(node), alignof(node));
+    ::new(static_cast<void *>(base + offset)) node{key, value, shared_offset<node>(head.load(std::memory_order_relaxed))};
+    head.store(offset, std::memory_order_release);
+    count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * Look up a key.
+   *
+   * @param key The key.
+   * @return The value of the key, or null if it is not in the map.
+   */
+  T const * find(Key const &key) const noexcept
+  {
+    auto const base = detail::shared_base(this, self);
+    return find_in(base, bucket(base, index_of(key))->load(std::memory_order_acquire), key);
+  }
+
+  /**
+   * @param key The key.
+   * @return Whether the key is in the map.
+   */
+  bool contains(Key const &key) const noexcept
+  {
+    return find(key) != nullptr;
+  }
+
+  /**
+   * Call a function for every entry, in no particular order.
+   *
+   * @param function Called as function(key, value) for each entry.
+   */
+  template<class Function>
+  void for_each(Function function) const
+  {
+    auto const base = detail::shared_base(this, self);
+    for(size_type i = 0; i <= mask; ++i) {
+      for(auto offset = bucket(base, i)->load(std::memory_order_acquire); offset != 0;) {
+        auto const &entry = *detail::resolve(base, shared_offset<node>(offset));
+        function(entry.key, entry.value);
+        offset = get(entry.next);
+      }
+    }
+  }
+
+  /**
+   * @return The number of entries.
+   */
+  size_type size() const noexcept
+  {
+    return static_cast<size_type>(count.load(std::memory_order_relaxed));
+  }
+
+private:
+  struct node {
+    Key key;
+    T value;
+    shared_offset<node> next;
+  };
+
+  std::atomic<std::uint64_t> * bucket(unsigned char *base, size_type index) const noexcept
+  {
+    return reinterpret_cast<std::atomic<std::uint64_t> *>(base + buckets) + index;
+  }
+
+  size_type index_of(Key const &key) const
+  {
+    return static_cast<size_type>(Hash()(key)) & mask;
+  }
+
+  T const * find_in(unsigned char *base, std::uint64_t offset, Key const &key) const noexcept
+  {
+    // nodes are written before they are published and never change, so plain reads are safe
+    while(offset != 0) {
+      auto const &entry = *detail::resolve(base, shared_offset<node>(offset));
+      if(get(entry.key) == get(key)) {
+        return &entry.value;
+      }
+      offset = get(entry.next);
+    }
+    return nullptr;
+  }
+
+  std::uint64_t const self;
+  std::uint64_t buckets;
+  size_type mask;
+  std::atomic<std::uint64_t> count;
+  interprocess_mutex lock;
+};
+
+}
+
+#endif
+
+#endif //STRONG_SHARED_MEMORY_HPP
@@ -0,0 +1,578 @@
+#ifndef STRONG_SKETCH_HPP
+#define STRONG_SKETCH_HPP
+
+#include <strong.hpp>
+#include <strong/bytes.hpp>
+#include <strong/hash.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace strong {
+
+namespace detail {
+
+constexpr std::size_t hash_batch = 256;
+
+inline unsigned leading_zeros(std::uint64_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return value == 0 ? 64 : static_cast<unsigned>(__builtin_clzll(value));
+#else
+  unsigned count = 0;
+  for(std::uint64_t bit = std::uint64_t(1) << 63; bit != 0 && (value & bit) == 0; bit >>= 1) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+// Hash a range in fixed-size batches so that the hashing loop has no other work in it and can be
+// vectorized when the range is contiguous, then hand each batch to the sketch.
+template<class Id, class InputIt, class Update>
+void hash_range(InputIt first, InputIt last, Update update)
+{
+  std::uint64_t hashes[hash_batch];
+  while(first != last) {
+    std::size_t count = 0;
+    for(; count < hash_batch && first != last; ++count, ++first) {
+      hashes[count] = hash64<Id>(*first);
+    }
+    update(hashes, count);
+  }
+}
+
+}
+
+/**
+ * Estimate the number of distinct strong IDs in a stream with HyperLogLog.
+ *
+ * Uses 2^Precision registers, for a relative standard error of about 1.04 / sqrt(2^Precision)
+ * (0.8% with the default precision). Small sketches are kept in a sparse form that stores only
+ * the registers that have been set, and switch to an array of registers once that would be
+ * smaller. Sketches built on different threads or machines can be merged. IDs are hashed with
+ * strong::hash.
+ *
+ * @tparam Id The strong typedef of the IDs to count.
+ * @tparam Precision The base-2 logarithm of the number of registers, between 4 and 18.
+ */
+template<class Id, unsigned Precision = 14>
+class hyperloglog {
+public:
+  static_assert(Precision >= 4 && Precision <= 18, "hyperloglog precision must be between 4 and 18");
+
+  /**
+   * The number of registers.
+   */
+  static constexpr std::size_t registers = std::size_t(1) << Precision;
+
+  /**
+   * Add an ID to the sketch.
+   *
+   * @param id The ID to add.
+   */
+  void insert(Id const &id)
+  {
+    auto const hash = detail::hash64(id);
+    update(&hash, 1);
+  }
+
+  /**
+   * Add a range of IDs to the sketch.
+   *
+   * @param first The beginning of the range.
+   * @param last The end of the range.
+   */
+  template<class InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    detail::hash_range<Id>(first, last, [this](std::uint64_t const *hashes, std::size_t count) {
+      update(hashes, count);
+    });
+  }
+
+  /**
+   * Add every ID counted by another sketch to this one.
+   *
+   * @param other The sketch to merge; merging a sketch with itself changes nothing.
+   */
+  void merge(hyperloglog const &other)
+  {
+    if(&other == this) {
+      // the sparse path would append to pending while reading it
+      return;
+    }
+    if(other.is_sparse()) {
+      if(is_sparse()) {
+        pending.insert(pending.end(), other.sparse.begin(), other.sparse.end());
+        pending.insert(pending.end(), other.pending.begin(), other.pending.end());
+        compact();
+      } else {
+        other.for_each_register([this](std::size_t index, std::uint8_t rank) { set(index, rank); });
+      }
+      return;
+    }
+
+    densify();
+    for(std::size_t i = 0; i < registers; ++i) {
+      dense[i] = std::max(dense[i], other.dense[i]);
+    }
+  }
+
+  /**
+   * @return The estimated number of distinct IDs added so far.
+   */
+  double estimate() const
+  {
+    double sum = 0;
+    std::size_t set_registers = 0;
+    for_each_register([&](std::size_t, std::uint8_t rank) {
+      sum += std::ldexp(1.0, -static_cast<int>(rank));
+      ++set_registers;
+    });
+
+    auto const m = static_cast<double>(registers);
+    auto const zeros = registers - set_registers;
+    sum += static_cast<double>(zeros);
+
+    // the bias correction of Flajolet et al.; the closed form only holds from 128 registers
+    auto const alpha = registers == 16   ? 0.673
+                       : registers == 32 ? 0.697
+                       : registers == 64 ? 0.709
+                                         : 0.7213 / (1 + 1.079 / m);
+    auto const raw = alpha * m * m / sum;
+    if(raw <= 2.5 * m && zeros > 0) {
+      // linear counting is more accurate while many registers are still empty
+      return m * std::log(m / static_cast<double>(zeros));
+    }
+    return raw;
+  }
+
+  /**
+   * @return True if the sketch is in its sparse form.
+   */
+  bool is_sparse() const noexcept
+  {
+    return dense.empty();
+  }
+
+  /**
+   * Write the sketch to a compact byte buffer.
+   *
+   * Sparse sketches store four bytes per set register; dense sketches pack each 6-bit register.
+   *
+   * @return The serialized sketch.
+   */
+  std::vector<unsigned char> serialize() const
+  {
+    std::vector<unsigned char> buffer;
+    detail::append_bytes(buffer, magic);
+    detail::append_bytes(buffer, static_cast<std::uint8_t>(Precision));
+    detail::append_bytes(buffer, static_cast<std::uint8_t>(is_sparse() ? 1 : 0));
+
+    if(is_sparse()) {
+      auto copy = *this;
+      copy.compact();
+      detail::append_bytes(buffer, static_cast<std::uint32_t>(copy.sparse.size()));
+      for(auto const entry : copy.sparse) {
+        detail::append_bytes(buffer, entry);
+      }
+      return buffer;
+    }
+
+    // four 6-bit registers per three bytes
+    for(std::size_t i = 0; i < registers; i += 4) {
+      std::uint32_t const packed = dense[i] | (dense[i + 1] << 6) | (dense[i + 2] << 12) | (dense[i + 3] << 18);
+      buffer.push_back(static_cast<unsigned char>(packed));
+      buffer.push_back(static_cast<unsigned char>(packed >> 8));
+      buffer.push_back(static_cast<unsigned char>(packed >> 16));
+    }
+    return buffer;
+  }
+
+  /**
+   * Read a sketch written by serialize.
+   *
+   * @param data The serialized sketch.
+   * @param size The size of the serialized sketch in bytes.
+   * @return The sketch.
+   * @throws std::invalid_argument If the buffer does not hold a sketch of this precision.
+   */
+  static hyperloglog deserialize(unsigned char const *data, std::size_t size)
+  {
+    char const *what = "strong::hyperloglog: invalid serialized sketch";
+    auto const end = data + size;
+    if(detail::read_bytes<std::uint32_t>(data, end, what) != magic
+       || detail::read_bytes<std::uint8_t>(data, end, what) != Precision) {
+      throw std::invalid_argument(what);
+    }
+
+    hyperloglog sketch;
+    if(detail::read_bytes<std::uint8_t>(data, end, what) != 0) {
+      auto const count = detail::read_bytes<std::uint32_t>(data, end, what);
+      for(std::uint32_t i = 0; i < count; ++i) {
+        auto const entry = detail::read_bytes<std::uint32_t>(data, end, what);
+        auto const rank = entry & ((1u << rank_bits) - 1);
+        if((entry >> rank_bits) >= registers || rank > max_rank) {
+          throw std::invalid_argument(what);
+        }
+        sketch.pending.push_back(entry);
+      }
+      sketch.compact();
+      return sketch;
+    }
+
+    if(static_cast<std::size_t>(end - data) < registers / 4 * 3) {
+      throw std::invalid_argument(what);
+    }
+    sketch.dense.resize(registers);
+    for(std::size_t i = 0; i < registers; i += 4, data += 3) {
+      std::uint32_t const packed = data[0] | (data[1] << 8) | (data[2] << 16);
+      for(std::size_t j = 0; j < 4; ++j) {
+        sketch.dense[i + j] = static_cast<std::uint8_t>((packed >> (6 * j)) & 0x3f);
+        if(sketch.dense[i + j] > max_rank) {
+          throw std::invalid_argument(what);
+        }
+      }
+    }
+    return sketch;
+  }
+
+private:
+  static constexpr std::uint32_t magic = 0x534c4c48; // "HLLS"
+  static constexpr unsigned rank_bits = 6;
+
+  // the rank of a hash is at most the number of bits below the register index, plus one
+  static constexpr unsigned max_rank = 64 - Precision + 1;
+
+  static std::uint32_t encode(std::size_t index, std::uint8_t rank) noexcept
+  {
+    return static_cast<std::uint32_t>(index << rank_bits) | rank;
+  }
+
+  void update(std::uint64_t const *hashes, std::size_t count)
+  {
+    for(std::size_t i = 0; i < count; ++i) {
+      auto const index = static_cast<std::size_t>(hashes[i] >> (64 - Precision));
+      // the remaining bits are shifted up with a sentinel bit so the rank is at most 65 - Precision
+      auto const rest = (hashes[i] << Precision) | (std::uint64_t(1) << (Precision - 1));
+      set(index, static_cast<std::uint8_t>(detail::leading_zeros(rest) + 1));
+    }
+  }
+
+  void set(std::size_t index, std::uint8_t rank)
+  {
+    if(!is_sparse()) {
+      dense[index] = std::max(dense[index], rank);
+      return;
+    }
+
+    pending.push_back(encode(index, rank));
+    if(pending.size() >= pending_limit()) {
+      compact();
+    }
+  }
+
+  static std::size_t pending_limit() noexcept
+  {
+    return std::max<std::size_t>(64, registers / 64);
+  }
+
+  // fold the pending entries into the sorted sparse entries, keeping the highest rank per register
+  void compact()
+  {
+    if(pending.empty()) {
+      return;
+    }
+
+    sparse.insert(sparse.end(), pending.begin(), pending.end());
+    pending.clear();
+    std::sort(sparse.begin(), sparse.end());
+
+    // entries sort by register and then by rank, so the last entry of each register wins
+    std::size_t kept = 0;
+    for(std::size_t i = 0; i < sparse.size(); ++i) {
+      if(i + 1 < sparse.size() && (sparse[i] >> rank_bits) == (sparse[i + 1] >> rank_bits)) {
+        continue;
+      }
+      sparse[kept++] = sparse[i];
+    }
+    sparse.resize(kept);
+
+    // a sparse entry costs four bytes and a dense register one
+    if(sparse.size() * sizeof(std::uint32_t) >= registers) {
+      densify();
+    }
+  }
+
+  void densify()
+  {
+    if(!is_sparse()) {
+      return;
+    }
+
+    std::vector<std::uint8_t> ranks(registers, 0);
+    for(auto const entries : {&sparse, &pending}) {
+      for(auto const entry : *entries) {
+        auto &rank = ranks[entry >> rank_bits];
+        rank = std::max(rank, static_cast<std::uint8_t>(entry & ((1u << rank_bits) - 1)));
+      }
+    }
+    dense.swap(ranks);
+    std::vector<std::uint32_t>().swap(sparse);
+    std::vector<std::uint32_t>().swap(pending);
+  }
+
+  template<class Function>
+  void for_each_register(Function function) const
+  {
+    if(!is_sparse()) {
+      for(std::size_t i = 0; i < registers; ++i) {
+        if(dense[i] != 0) {
+          function(i, dense[i]);
+        }
+      }
+      return;
+    }
+
+    auto copy = *this;
+    copy.compact();
+    if(!copy.is_sparse()) {
+      copy.for_each_register(function);
+      return;
+    }
+    for(auto const entry : copy.sparse) {
+      function(entry >> rank_bits, static_cast<std::uint8_t>(entry & ((1u << rank_bits) - 1)));
+    }
+  }
+
+  std::vector<std::uint32_t> sparse;
+  std::vector<std::uint32_t> pending;
+  std::vector<std::uint8_t> dense;
+};
+
+template<class Id, unsigned Precision>
+constexpr std::size_t hyperloglog<Id, Precision>::registers;
+
+template<class Id, unsigned Precision>
+constexpr std::uint32_t hyperloglog<Id, Precision>::magic;
+
+template<class Id, unsigned Precision>
+constexpr unsigned hyperloglog<Id, Precision>::rank_bits;
+
+template<class Id, unsigned Precision>
+constexpr unsigned hyperloglog<Id, Precision>::max_rank;
+
+/**
+ * Estimate how often each strong ID occurs in a stream with a count-min sketch.
+ *
+ * Estimates never undercount. With probability 1 - delta, an estimate overcounts by at most
+ * epsilon times the total of all counts, using a width of e / epsilon and a depth of
+ * ln(1 / delta) rows. Sketches with the same dimensions can be merged by adding their counters.
+ * IDs are hashed with strong::hash.
+ *
+ * @tparam Id The strong typedef of the IDs to count.
+ * @tparam Counter The unsigned integer type of the counters.
+ */
+template<class Id, typename Counter = std::uint32_t>
+class count_min_sketch {
+public:
+  using size_type = std::size_t;
+
+  /**
+   * Construct a sketch with explicit dimensions.
+   *
+   * @param width The number of counters per row, which is rounded up to a power of two.
+   * @param depth The number of rows.
+   * @throws std::invalid_argument If the width or depth is zero.
+   */
+  count_min_sketch(size_type width, size_type depth) : columns(1), rows(depth)
+  {
+    if(width == 0 || depth == 0) {
+      throw std::invalid_argument("strong::count_min_sketch: width and depth must be positive");
+    }
+    while(columns < width) {
+      columns *= 2;
+    }
+    counters.assign(columns * rows, 0);
+  }
+
+  /**
+   * Construct a sketch sized for an error bound.
+   *
+   * @param epsilon The overcount bound, as a fraction of the total count.
+   * @param delta The probability of exceeding the bound.
+   * @return The sketch.
+   * @throws std::invalid_argument If epsilon is not positive, delta is not between 0 and 1, or
+   *                               the sketch would be too large to allocate.
+   */
+  static count_min_sketch with_error(double epsilon, double delta)
+  {
+    if(!(epsilon > 0) || !(delta > 0 && delta < 1)) {
+      throw std::invalid_argument("strong::count_min_sketch: epsilon must be positive and delta between 0 and 1");
+    }
+    // checked before the conversions to size_type, which are undefined for values out of range
+    if(2.718281828459045 / epsilon > 1e15 || std::log(1 / delta) > 1e3) {
+      throw std::invalid_argument("strong::count_min_sketch: error bound is too small");
+    }
+    return count_min_sketch(static_cast<size_type>(std::ceil(2.718281828459045 / epsilon)),
+                            static_cast<size_type>(std::ceil(std::log(1 / delta))));
+  }
+
+  /**
+   * Count an occurrence of an ID.
+   *
+   * @param id The ID to count.
+   * @param count The number of occurrences.
+   */
+  void insert(Id const &id, Counter count = 1) noexcept
+  {
+    add(detail::hash64(id), count);
+  }
+
+  /**
+   * Count one occurrence of each ID in a range.
+   *
+   * @param first The beginning of the range.
+   * @param last The end of the range.
+   */
+  template<class InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    detail::hash_range<Id>(first, last, [this](std::uint64_t const *hashes, std::size_t count) {
+      for(std::size_t i = 0; i < count; ++i) {
+        add(hashes[i], 1);
+      }
+    });
+  }
+
+  /**
+   * Estimate how often an ID occurred.
+   *
+   * @param id The ID to look up.
+   * @return The estimated count, which is never less than the true count.
+   */
+  Counter estimate(Id const &id) const noexcept
+  {
+    auto const hash = detail::hash64(id);
+    auto result = std::numeric_limits<Counter>::max();
+    for(size_type row = 0; row < rows; ++row) {
+      result = std::min(result, counters[slot(hash, row)]);
+    }
+    return result;
+  }
+
+  /**
+   * Add the counts of another sketch with the same dimensions to this one.
+   *
+   * @param other The sketch to merge.
+   * @throws std::invalid_argument If the dimensions differ.
+   */
+  void merge(count_min_sketch const &other)
+  {
+    if(columns != other.columns || rows != other.rows) {
+      throw std::invalid_argument("strong::count_min_sketch: cannot merge sketches of different dimensions");
+    }
+    for(size_type i = 0; i < counters.size(); ++i) {
+      counters[i] += other.counters[i];
+    }
+  }
+
+  /**
+   * @return The number of counters per row.
+   */
+  size_type width() const noexcept
+  {
+    return columns;
+  }
+
+  /**
+   * @return The number of rows.
+   */
+  size_type depth() const noexcept
+  {
+    return rows;
+  }
+
+  /**
+   * Write the sketch to a byte buffer.
+   *
+   * @return The serialized sketch.
+   */
+  std::vector<unsigned char> serialize() const
+  {
+    std::vector<unsigned char> buffer;
+    detail::append_bytes(buffer, magic);
+    detail::append_bytes(buffer, static_cast<std::uint8_t>(sizeof(Counter)));
+    detail::append_bytes(buffer, static_cast<std::uint64_t>(columns));
+    detail::append_bytes(buffer, static_cast<std::uint64_t>(rows));
+    auto const bytes = reinterpret_cast<unsigned char const *>(counters.data());
+    buffer.insert(buffer.end(), bytes, bytes + counters.size() * sizeof(Counter));
+    return buffer;
+  }
+
+  /**
+   * Read a sketch written by serialize.
+   *
+   * @param data The serialized sketch.
+   * @param size The size of the serialized sketch in bytes.
+   * @return The sketch.
+   * @throws std::invalid_argument If the buffer does not hold a sketch with this counter type.
+   */
+  static count_min_sketch deserialize(unsigned char const *data, std::size_t size)
+  {
+    char const *what = "strong::count_min_sketch: invalid serialized sketch";
+    auto const end = data + size;
+    if(detail::read_bytes<std::uint32_t>(data, end, what) != magic
+       || detail::read_bytes<std::uint8_t>(data, end, what) != sizeof(Counter)) {
+      throw std::invalid_argument(what);
+    }
+
+    auto const columns = detail::read_bytes<std::uint64_t>(data, end, what);
+    auto const rows = detail::read_bytes<std::uint64_t>(data, end, what);
+    if(columns == 0 || (columns & (columns - 1)) != 0 || rows == 0
+       || static_cast<std::uint64_t>(end - data) / sizeof(Counter) / columns < rows) {
+      throw std::invalid_argument(what);
+    }
+
+    count_min_sketch sketch(static_cast<size_type>(columns), static_cast<size_type>(rows));
+    std::memcpy(sketch.counters.data(), data, sketch.counters.size() * sizeof(Counter));
+    return sketch;
+  }
+
+private:
+  static constexpr std::uint32_t magic = 0x534d4d43; // "CMMS"
+
+  size_type slot(std::uint64_t hash, size_type row) const noexcept
+  {
+    // derive one index per row from two halves of the hash (Kirsch-Mitzenmacher)
+    auto const low = static_cast<std::uint32_t>(hash);
+    auto const high = static_cast<std::uint32_t>(hash >> 32) | 1u;
+    return row * columns + ((low + row * high) & (columns - 1));
+  }
+
+  void add(std::uint64_t hash, Counter count) noexcept
+  {
+    for(size_type row = 0; row < rows; ++row) {
+      counters[slot(hash, row)] += count;
+    }
+  }
+
+  size_type columns;
+  size_type rows;
+  std::vector<Counter> counters;
+};
+
+template<class Id, typename Counter>
+constexpr std::uint32_t count_min_sketch<Id, Counter>::magic;
+
+}
+
+#endif //STRONG_SKETCH_HPP
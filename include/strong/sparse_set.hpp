@@ -0,0 +1,563 @@
+#ifndef STRONG_SPARSE_SET_HPP
+#define STRONG_SPARSE_SET_HPP
+
+#include <strong.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+/**
+ * A set of strong IDs with O(1) insertion, removal, and membership tests.
+ *
+ * IDs are stored contiguously in a dense array so that iteration touches only the IDs that are
+ * present. A sparse index maps each ID to its position in the dense array. The sparse index is
+ * split into pages of PageSize entries that are only allocated once an ID inside the page is
+ * inserted, so large but clustered ID ranges do not need a fully allocated index.
+ *
+ * Because the set is keyed by the strong type, a set of intersection IDs cannot be queried with a
+ * street ID.
+ *
+ * @tparam EntityId A strong typedef whose underlying type is a non-negative integer.
+ * @tparam PageSize The number of sparse index entries per page.
+ * @tparam Allocator The allocator of the dense array, rebound for the pages of the sparse index.
+ */
+template<class EntityId, std::size_t PageSize = 4096, class Allocator = std::allocator<EntityId>>
+class sparse_set {
+public:
+  using value_type = EntityId;
+  using size_type = std::size_t;
+  using allocator_type = Allocator;
+  using const_iterator = typename std::vector<EntityId, Allocator>::const_iterator;
+
+  static_assert(std::is_integral<typename underlying_type<EntityId>::type>::value,
+                "sparse_set requires a strong typedef with an integral underlying type");
+  static_assert(PageSize > 0, "sparse_set requires a non-zero page size");
+
+  /**
+   * Construct an empty set.
+   */
+  sparse_set() = default;
+
+  /**
+   * Construct an empty set that uses the given allocator.
+   *
+   * @param allocator The allocator to use.
+   */
+  explicit sparse_set(Allocator const &allocator) : sparse(page_allocator(allocator)), dense(allocator)
+  {
+  }
+
+  /**
+   * Insert an ID into the set.
+   *
+   * @param id The ID to insert.
+   * @return True if the ID was inserted, false if it was already present.
+   * @throws std::length_error If the set already holds as many IDs as its positions can count.
+   */
+  bool insert(EntityId const &id)
+  {
+    if(contains(id)) {
+      return false;
+    }
+    if(dense.size() == static_cast<size_type>(npos)) {
+      throw std::length_error("strong::sparse_set: too many IDs");
+    }
+
+    // the page is allocated before the ID is added, so that the set is unchanged if either throws
+    auto &position = slot(to_index(id));
+    dense.push_back(id);
+    position = static_cast<position_type>(dense.size() - 1);
+    return true;
+  }
+
+  /**
+   * Remove an ID from the set by swapping the last ID into its position.
+   *
+   * @param id The ID to remove.
+   * @return True if the ID was removed, false if it was not present.
+   */
+  bool erase(EntityId const &id)
+  {
+    if(!contains(id)) {
+      return false;
+    }
+
+    auto const position = index_of(id);
+    auto const last = dense.back();
+
+    dense[position] = last;
+    slot(to_index(last)) = static_cast<position_type>(position);
+    slot(to_index(id)) = npos;
+    dense.pop_back();
+    return true;
+  }
+
+  /**
+   * Test whether an ID is in the set.
+   *
+   * @param id The ID to look for.
+   * @return True if the ID is present.
+   */
+  bool contains(EntityId const &id) const noexcept
+  {
+    auto const index = to_index(id);
+    auto const page = page_of(index);
+    return page < sparse.size() && !sparse[page].empty() && sparse[page][offset_of(index)] != npos;
+  }
+
+  /**
+   * Find the position of an ID in the dense array.
+   *
+   * The ID must be present in the set.
+   *
+   * @param id The ID to look for.
+   * @return The position of the ID.
+   */
+  size_type index_of(EntityId const &id) const noexcept
+  {
+    auto const index = to_index(id);
+    return sparse[page_of(index)][offset_of(index)];
+  }
+
+  /**
+   * Remove all IDs from the set, keeping the allocated pages.
+   */
+  void clear() noexcept
+  {
+    for(auto const &id : dense) {
+      auto const index = to_index(id);
+      sparse[page_of(index)][offset_of(index)] = npos;
+    }
+    dense.clear();
+  }
+
+  /**
+   * Reserve space in the dense array.
+   *
+   * @param capacity The number of IDs to reserve space for.
+   */
+  void reserve(size_type capacity)
+  {
+    dense.reserve(capacity);
+  }
+
+  /**
+   * @return The number of IDs in the set.
+   */
+  size_type size() const noexcept
+  {
+    return dense.size();
+  }
+
+  /**
+   * @return True if the set has no IDs.
+   */
+  bool empty() const noexcept
+  {
+    return dense.empty();
+  }
+
+  /**
+   * @return A pointer to the densely packed IDs.
+   */
+  EntityId const * data() const noexcept
+  {
+    return dense.data();
+  }
+
+  /**
+   * @return An iterator to the first ID in the dense array.
+   */
+  const_iterator begin() const noexcept
+  {
+    return dense.begin();
+  }
+
+  /**
+   * @return An iterator past the last ID in the dense array.
+   */
+  const_iterator end() const noexcept
+  {
+    return dense.end();
+  }
+
+  /**
+   * @return The allocator of the set.
+   */
+  allocator_type get_allocator() const
+  {
+    return dense.get_allocator();
+  }
+
+private:
+  using id_type = typename std::make_unsigned<typename underlying_type<EntityId>::type>::type;
+
+  // npos marks an absent ID, so narrow IDs get wider positions to let a set hold every one of them
+  using position_type =
+    typename std::conditional<(sizeof(id_type) < sizeof(std::uint32_t)), std::uint32_t, id_type>::type;
+  using traits = std::allocator_traits<Allocator>;
+  using page_type = std::vector<position_type, typename traits::template rebind_alloc<position_type>>;
+  using page_allocator = typename traits::template rebind_alloc<page_type>;
+
+  static constexpr position_type npos = std::numeric_limits<position_type>::max();
+
+  static size_type to_index(EntityId const &id) noexcept
+  {
+    return static_cast<size_type>(static_cast<id_type>(get(id)));
+  }
+
+  static size_type page_of(size_type index) noexcept
+  {
+    return index / PageSize;
+  }
+
+  static size_type offset_of(size_type index) noexcept
+  {
+    return index % PageSize;
+  }
+
+  position_type & slot(size_type index)
+  {
+    auto const page = page_of(index);
+    if(page >= sparse.size()) {
+      // new pages are copied from one that holds the allocator, so stateful allocators carry over
+      sparse.resize(page + 1, page_type(typename page_type::allocator_type(dense.get_allocator())));
+    }
+    if(sparse[page].empty()) {
+      sparse[page].assign(PageSize, npos);
+    }
+    return sparse[page][offset_of(index)];
+  }
+
+  std::vector<page_type, page_allocator> sparse;
+  std::vector<EntityId, Allocator> dense;
+};
+
+template<class EntityId, std::size_t PageSize, class Allocator>
+constexpr typename sparse_set<EntityId, PageSize, Allocator>::position_type
+  sparse_set<EntityId, PageSize, Allocator>::npos;
+
+/**
+ * Densely packed components associated with strong IDs.
+ *
+ * Components are stored in an array parallel to the dense array of the underlying sparse_set, so
+ * iterating over all components is a linear walk through memory. Removing a component moves the
+ * last component into its place.
+ *
+ * @tparam EntityId A strong typedef whose underlying type is a non-negative integer.
+ * @tparam Component The type of data to associate with each ID.
+ * @tparam PageSize The number of sparse index entries per page.
+ * @tparam Allocator The allocator of the components, rebound for the IDs.
+ */
+template<class EntityId, typename Component, std::size_t PageSize = 4096, class Allocator = std::allocator<Component>>
+class component_pool {
+  using id_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<EntityId>;
+
+public:
+  using entity_type = EntityId;
+  using component_type = Component;
+  using size_type = std::size_t;
+  using allocator_type = Allocator;
+  using iterator = typename std::vector<Component, Allocator>::iterator;
+  using const_iterator = typename std::vector<Component, Allocator>::const_iterator;
+
+  /**
+   * Construct an empty pool.
+   */
+  component_pool() = default;
+
+  /**
+   * Construct an empty pool that uses the given allocator.
+   *
+   * @param allocator The allocator to use.
+   */
+  explicit component_pool(Allocator const &allocator) : ids(id_allocator(allocator)), components(allocator)
+  {
+  }
+
+  /**
+   * Construct a component in place for an ID.
+   *
+   * If the ID already has a component, it is replaced.
+   *
+   * @param id The ID to associate the component with.
+   * @param args The arguments forwarded to the constructor of the component.
+   * @return A reference to the component.
+   * @throws std::length_error If the pool already holds as many components as its positions can count.
+   */
+  template<typename... Args>
+  Component & emplace(EntityId const &id, Args &&... args)
+  {
+    if(ids.contains(id)) {
+      auto &component = components[ids.index_of(id)];
+      component = Component(std::forward<Args>(args)...);
+      return component;
+    }
+
+    // the ID is inserted first and removed again if the component cannot be constructed
+    ids.insert(id);
+    try {
+      components.emplace_back(std::forward<Args>(args)...);
+    } catch(...) {
+      ids.erase(id);
+      throw;
+    }
+    return components.back();
+  }
+
+  /**
+   * Remove the component of an ID.
+   *
+   * @param id The ID whose component should be removed.
+   * @return True if a component was removed, false if the ID had none.
+   */
+  bool erase(EntityId const &id)
+  {
+    if(!ids.contains(id)) {
+      return false;
+    }
+
+    auto const position = ids.index_of(id);
+    if(position + 1 != components.size()) {
+      components[position] = std::move(components.back());
+    }
+    components.pop_back();
+    ids.erase(id);
+    return true;
+  }
+
+  /**
+   * Test whether an ID has a component.
+   *
+   * @param id The ID to look for.
+   * @return True if the ID has a component.
+   */
+  bool contains(EntityId const &id) const noexcept
+  {
+    return ids.contains(id);
+  }
+
+  /**
+   * Access the component of an ID without bounds checking.
+   *
+   * @param id An ID that has a component.
+   * @return A reference to the component.
+   */
+  Component & operator[](EntityId const &id) noexcept
+  {
+    return components[ids.index_of(id)];
+  }
+
+  /**
+   * Access the component of an ID without bounds checking.
+   *
+   * @param id An ID that has a component.
+   * @return A reference to the component.
+   */
+  Component const & operator[](EntityId const &id) const noexcept
+  {
+    return components[ids.index_of(id)];
+  }
+
+  /**
+   * Access the component of an ID.
+   *
+   * @param id The ID whose component to access.
+   * @return A reference to the component.
+   * @throws std::out_of_range If the ID has no component.
+   */
+  Component & at(EntityId const &id)
+  {
+    if(!ids.contains(id)) {
+      throw std::out_of_range("strong::component_pool::at");
+    }
+    return (*this)[id];
+  }
+
+  /**
+   * Access the component of an ID.
+   *
+   * @param id The ID whose component to access.
+   * @return A reference to the component.
+   * @throws std::out_of_range If the ID has no component.
+   */
+  Component const & at(EntityId const &id) const
+  {
+    if(!ids.contains(id)) {
+      throw std::out_of_range("strong::component_pool::at");
+    }
+    return (*this)[id];
+  }
+
+  /**
+   * Access the component of an ID if it has one.
+   *
+   * @param id The ID whose component to access.
+   * @return A pointer to the component, or nullptr if the ID has no component.
+   */
+  Component * find(EntityId const &id) noexcept
+  {
+    return ids.contains(id) ? &components[ids.index_of(id)] : nullptr;
+  }
+
+  /**
+   * Access the component of an ID if it has one.
+   *
+   * @param id The ID whose component to access.
+   * @return A pointer to the component, or nullptr if the ID has no component.
+   */
+  Component const * find(EntityId const &id) const noexcept
+  {
+    return ids.contains(id) ? &components[ids.index_of(id)] : nullptr;
+  }
+
+  /**
+   * Remove all components.
+   */
+  void clear() noexcept
+  {
+    ids.clear();
+    components.clear();
+  }
+
+  /**
+   * Reserve space for components.
+   *
+   * @param capacity The number of components to reserve space for.
+   */
+  void reserve(size_type capacity)
+  {
+    ids.reserve(capacity);
+    components.reserve(capacity);
+  }
+
+  /**
+   * @return The number of components in the pool.
+   */
+  size_type size() const noexcept
+  {
+    return components.size();
+  }
+
+  /**
+   * @return True if the pool has no components.
+   */
+  bool empty() const noexcept
+  {
+    return components.empty();
+  }
+
+  /**
+   * @return The IDs that have a component, in the same order as the components.
+   */
+  sparse_set<EntityId, PageSize, id_allocator> const & entities() const noexcept
+  {
+    return ids;
+  }
+
+  /**
+   * @return An iterator to the first component.
+   */
+  iterator begin() noexcept
+  {
+    return components.begin();
+  }
+
+  /**
+   * @return An iterator past the last component.
+   */
+  iterator end() noexcept
+  {
+    return components.end();
+  }
+
+  /**
+   * @return An iterator to the first component.
+   */
+  const_iterator begin() const noexcept
+  {
+    return components.begin();
+  }
+
+  /**
+   * @return An iterator past the last component.
+   */
+  const_iterator end() const noexcept
+  {
+    return components.end();
+  }
+
+  /**
+   * @return The allocator of the components.
+   */
+  allocator_type get_allocator() const
+  {
+    return components.get_allocator();
+  }
+
+private:
+  sparse_set<EntityId, PageSize, id_allocator> ids;
+  std::vector<Component, Allocator> components;
+};
+
+namespace detail {
+
+inline bool all_of() noexcept
+{
+  return true;
+}
+
+template<typename... Rest>
+bool all_of(bool first, Rest... rest) noexcept
+{
+  return first && all_of(rest...);
+}
+
+}
+
+/**
+ * Visit every ID that has a component in all of the given pools.
+ *
+ * The smallest pool drives the iteration and every other pool is probed in O(1), so the cost is
+ * proportional to the size of the smallest pool. All pools must be keyed by the same strong ID
+ * type. The function must not add or remove components from the pools.
+ *
+ * @tparam EntityId The strong ID type shared by all pools.
+ * @param function Called as function(id, components...) for each ID present in all pools.
+ * @param pools The pools to join.
+ */
+template<class EntityId, std::size_t PageSize, class Function, typename... Components, class... Allocators>
+void join(Function function, component_pool<EntityId, Components, PageSize, Allocators> &... pools)
+{
+  static_assert(sizeof...(Components) > 0, "join requires at least one component pool");
+
+  // the sets differ in type when the pools differ in allocator, so only their dense arrays are kept
+  std::pair<EntityId const *, std::size_t> const sets[] = {
+    std::make_pair(pools.entities().data(), pools.entities().size())...};
+
+  auto smallest = sets[0];
+  for(auto const &set : sets) {
+    if(set.second < smallest.second) {
+      smallest = set;
+    }
+  }
+
+  for(std::size_t i = 0; i < smallest.second; ++i) {
+    auto const &id = smallest.first[i];
+    if(detail::all_of(pools.contains(id)...)) {
+      function(id, pools[id]...);
+    }
+  }
+}
+
+}
+
+#endif //STRONG_SPARSE_SET_HPP
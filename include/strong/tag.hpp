@@ -0,0 +1,111 @@
+#ifndef STRONG_TAG_HPP
+#define STRONG_TAG_HPP
+
+#include <strong.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <typeinfo>
+
+namespace strong {
+
+namespace detail {
+
+template<class TypeName>
+char const * signature() noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __PRETTY_FUNCTION__;
+#elif defined(_MSC_VER)
+  return __FUNCSIG__;
+#else
+  return typeid(TypeName).name();
+#endif
+}
+
+// Extract the type from the signature of signature<TypeName>, e.g.
+// "const char* strong::detail::signature() [with TypeName = cycle_count]" (GCC),
+// "const char *strong::detail::signature() [TypeName = cycle_count]" (Clang) or
+// "const char *__cdecl strong::detail::signature<struct cycle_count>(void) noexcept" (MSVC).
+inline std::string signature_type(std::string const &signature)
+{
+  auto first = signature.find("TypeName = ");
+  auto last = signature.rfind(']');
+  if(first != std::string::npos && last != std::string::npos && last > first) {
+    first += 11;
+  } else {
+    first = signature.find("signature<");
+    last = signature.rfind(">(");
+    if(first == std::string::npos || last == std::string::npos || last <= first) {
+      return signature;
+    }
+    first += 10;
+  }
+
+  auto name = signature.substr(first, last - first);
+  for(char const *prefix : {"struct ", "class ", "enum "}) {
+    std::string const keyword(prefix);
+    if(name.compare(0, keyword.size(), keyword) == 0) {
+      name.erase(0, keyword.size());
+    }
+  }
+  return name;
+}
+
+constexpr std::uint64_t fnv_offset = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t fnv_prime = 0x100000001b3ULL;
+
+inline std::uint64_t fnv1a(char const *data, std::size_t size, std::uint64_t hash = fnv_offset) noexcept
+{
+  for(std::size_t i = 0; i < size; ++i) {
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * fnv_prime;
+  }
+  return hash;
+}
+
+}
+
+/**
+ * The name of a strong typedef, as written in the source including any enclosing namespaces
+ * (e.g. "cycle_count" or "arch::cycle_count").
+ *
+ * The name is taken from the compiler's description of the current function, so it needs no
+ * registration. It is computed on first use and cached. Compilers other than GCC, Clang and MSVC
+ * fall back to typeid, whose names are implementation-defined.
+ *
+ * @tparam TypeName The strong typedef to name.
+ * @return The name of the type.
+ */
+template<class TypeName>
+std::string const & tag_name()
+{
+  static std::string const name = detail::signature_type(detail::signature<TypeName>());
+  return name;
+}
+
+/**
+ * A 64-bit fingerprint of a strong typedef, for recognizing the type of stored or transmitted data.
+ *
+ * The fingerprint is the 64-bit FNV-1a hash of the tag name followed by the size of the underlying
+ * type, so it is stable across builds and programs that spell the type the same way. Two types
+ * that share a fingerprint are almost certainly the same type.
+ *
+ * @tparam TypeName The strong typedef to fingerprint.
+ * @return The fingerprint of the type.
+ */
+template<class TypeName>
+std::uint64_t tag_fingerprint()
+{
+  static std::uint64_t const fingerprint = [] {
+    auto const &name = tag_name<TypeName>();
+    auto const size = static_cast<unsigned char>(sizeof(typename underlying_type<TypeName>::type));
+    return detail::fnv1a(reinterpret_cast<char const *>(&size), 1, detail::fnv1a(name.data(), name.size()));
+  }();
+  return fingerprint;
+}
+
+}
+
+#endif //STRONG_TAG_HPP
@@ -0,0 +1,322 @@
+#ifndef STRONG_TASK_GRAPH_HPP
+#define STRONG_TASK_GRAPH_HPP
+
+#include <strong.hpp>
+#include <strong/parallel.hpp>
+#include <strong/vector.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+namespace detail {
+
+inline std::uint64_t read_cycles() noexcept
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  return __builtin_ia32_rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+template<class TaskId>
+class graph_task : public task {
+public:
+  graph_task(task_group &group, task_graph<TaskId> &graph, TaskId id) noexcept : task(group), graph(graph), id(id)
+  {
+  }
+
+  void run() override
+  {
+    graph.execute(id);
+  }
+
+private:
+  task_graph<TaskId> &graph;
+  TaskId id;
+};
+
+}
+
+/**
+ * A graph of tasks with dependencies between them, run in parallel on a task_scheduler.
+ *
+ * Tasks are identified by a strong typedef, assigned densely from 0 in the order the tasks are
+ * added, and the dependencies are declared before the graph runs. Each task has an atomic count of
+ * the dependencies it still waits for; the task that finishes last among them decrements it to
+ * zero and queues the task on its own thread, where idle threads steal it. No lock is taken apart
+ * from those of the scheduler's queues, and no thread blocks on a future.
+ *
+ * Every run records the cycles each task took, from which critical_path finds the chain of
+ * dependent tasks that bounds how fast the graph can run however many threads there are.
+ *
+ * A graph can be run any number of times, but not by two threads at once.
+ *
+ * @tparam TaskId The strong typedef with an integral underlying type that identifies tasks.
+ */
+template<class TaskId>
+class task_graph {
+public:
+  /**
+   * A number of processor cycles, as counted by the time stamp counter.
+   *
+   * On targets without a time stamp counter that the compiler exposes, cycles are counted as
+   * nanoseconds of a steady clock instead.
+   */
+  struct cycles
+    : type<cycles, std::uint64_t>
+    , op::equals<cycles>
+    , op::orders<cycles>
+    , op::adds<cycles>
+    , op::subtracts<cycles> {
+    using type<cycles, std::uint64_t>::type;
+  };
+
+  /**
+   * A chain of tasks, each depending on the one before.
+   */
+  struct path {
+    /**
+     * The tasks, from the first to run to the last.
+     */
+    std::vector<TaskId> tasks;
+
+    /**
+     * The sum of the cycles the tasks took.
+     */
+    cycles length;
+  };
+
+  task_graph() = default;
+  task_graph(task_graph const &) = delete;
+  task_graph & operator=(task_graph const &) = delete;
+
+  /**
+   * Add a task.
+   *
+   * @param function Called as function() when the tasks it depends on have finished.
+   * @return The identifier of the task, which is the number of tasks added before it.
+   */
+  template<class Function>
+  TaskId add(Function function)
+  {
+    sorted = false;
+    return nodes.push_back(node(std::function<void()>(std::move(function))));
+  }
+
+  /**
+   * Declare that a task depends on another.
+   *
+   * @param before The task that must finish first.
+   * @param after The task that starts only when before has finished.
+   * @throws std::out_of_range If either task has not been added.
+   */
+  void precede(TaskId const &before, TaskId const &after)
+  {
+    if(!nodes.contains(before) || !nodes.contains(after)) {
+      throw std::out_of_range("strong::task_graph: unknown task");
+    }
+    sorted = false;
+    nodes[before].successors.push_back(after);
+    ++nodes[after].predecessors;
+  }
+
+  /**
+   * @return The number of tasks.
+   */
+  std::size_t size() const noexcept
+  {
+    return nodes.size();
+  }
+
+  /**
+   * Run every task once, each after the tasks it depends on, and wait for them all.
+   *
+   * The calling thread runs tasks too while it waits.
+   *
+   * @param scheduler The threads to run on.
+   * @throws std::invalid_argument If the dependencies form a cycle; no task is run.
+   * @throws Any exception thrown by a task, after the tasks already running have finished; tasks
+   *         that depend on the failed one, and tasks not yet started, are skipped.
+   */
+  void run(task_scheduler &scheduler = task_scheduler::global())
+  {
+    sort();
+    auto const start = cycles(detail::read_cycles());
+    remaining.reset(new std::atomic<std::uint32_t>[nodes.size()]);
+    for(std::size_t i = 0; i < nodes.size(); ++i) {
+      auto &current = nodes[id_of(i)];
+      current.start = current.stop = cycles(0);
+      remaining[i].store(current.predecessors, std::memory_order_relaxed);
+    }
+
+    detail::task_group group;
+    active_group = &group;
+    active_scheduler = &scheduler;
+    for(auto const &id : order) {
+      if(nodes[id].predecessors != 0) {
+        break;
+      }
+      spawn(id);
+    }
+    group.done();
+    scheduler.wait(group);
+    elapsed_cycles = cycles(detail::read_cycles()) - start;
+  }
+
+  /**
+   * @param id A task.
+   * @return The cycles the task took in the last run, or 0 if it did not finish.
+   * @throws std::out_of_range If the task has not been added.
+   */
+  cycles duration(TaskId const &id) const
+  {
+    auto const &current = nodes.at(id);
+    return current.stop - current.start;
+  }
+
+  /**
+   * @return The cycles the last run took from start to finish.
+   */
+  cycles elapsed() const noexcept
+  {
+    return elapsed_cycles;
+  }
+
+  /**
+   * Find the chain of dependent tasks that took the most cycles in the last run.
+   *
+   * Its length is the least time the graph can take on any number of threads, so elapsed cycles
+   * well above it point to too few threads or to contention, and a critical path close to elapsed
+   * points to the tasks on the path as the ones to speed up.
+   *
+   * @return The longest path, or an empty path if the graph has no tasks.
+   */
+  path critical_path() const
+  {
+    sort();
+    auto const none = nodes.size();
+    std::vector<cycles> before(nodes.size(), cycles(0));
+    std::vector<std::size_t> previous(nodes.size(), none);
+    auto last = none;
+    cycles longest(0);
+    for(auto const &id : order) {
+      auto const position = static_cast<std::size_t>(get(id));
+      auto const through = before[position] + duration(id);
+      if(last == none || through > longest) {
+        last = position;
+        longest = through;
+      }
+      for(auto const &next : nodes[id].successors) {
+        auto const successor = static_cast<std::size_t>(get(next));
+        if(previous[successor] == none || through > before[successor]) {
+          before[successor] = through;
+          previous[successor] = position;
+        }
+      }
+    }
+
+    path result{std::vector<TaskId>(), longest};
+    for(auto position = last; position != none; position = previous[position]) {
+      result.tasks.push_back(id_of(position));
+    }
+    std::reverse(result.tasks.begin(), result.tasks.end());
+    return result;
+  }
+
+private:
+  friend class detail::graph_task<TaskId>;
+
+  struct node {
+    explicit node(std::function<void()> function) : function(std::move(function)), predecessors(0)
+    {
+    }
+
+    std::function<void()> function;
+    std::vector<TaskId> successors;
+    std::uint32_t predecessors;
+    cycles start;
+    cycles stop;
+  };
+
+  static TaskId id_of(std::size_t position)
+  {
+    return TaskId(static_cast<typename underlying_type<TaskId>::type>(position));
+  }
+
+  void spawn(TaskId const &id)
+  {
+    active_group->add();
+    active_scheduler->spawn(std::unique_ptr<detail::task>(new detail::graph_task<TaskId>(*active_group, *this, id)));
+  }
+
+  void execute(TaskId const &id)
+  {
+    auto &current = nodes[id];
+    auto const start = cycles(detail::read_cycles());
+    current.function();
+    current.start = start;
+    current.stop = cycles(detail::read_cycles());
+    for(auto const &next : current.successors) {
+      // the last dependency to finish queues the task, and acquires the writes of the others
+      if(remaining[static_cast<std::size_t>(get(next))].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        spawn(next);
+      }
+    }
+  }
+
+  // Order the tasks so that each comes after those it depends on, with the ones that depend on
+  // nothing first.
+  void sort() const
+  {
+    if(sorted) {
+      return;
+    }
+    std::vector<std::uint32_t> waiting(nodes.size());
+    order.clear();
+    for(std::size_t i = 0; i < nodes.size(); ++i) {
+      waiting[i] = nodes[id_of(i)].predecessors;
+      if(waiting[i] == 0) {
+        order.push_back(id_of(i));
+      }
+    }
+    for(std::size_t i = 0; i < order.size(); ++i) {
+      for(auto const &next : nodes[order[i]].successors) {
+        if(--waiting[static_cast<std::size_t>(get(next))] == 0) {
+          order.push_back(next);
+        }
+      }
+    }
+    if(order.size() != nodes.size()) {
+      throw std::invalid_argument("strong::task_graph: dependencies form a cycle");
+    }
+    sorted = true;
+  }
+
+  static_assert(std::is_integral<typename underlying_type<TaskId>::type>::value,
+                "task_graph requires a strong typedef with an integral underlying type");
+
+  vector<TaskId, node> nodes;
+  mutable std::vector<TaskId> order;
+  mutable bool sorted = false;
+  std::unique_ptr<std::atomic<std::uint32_t>[]> remaining;
+  detail::task_group *active_group = nullptr;
+  task_scheduler *active_scheduler = nullptr;
+  cycles elapsed_cycles;
+};
+
+}
+
+#endif //STRONG_TASK_GRAPH_HPP
@@ -0,0 +1,214 @@
+#ifndef STRONG_TOP_K_HPP
+#define STRONG_TOP_K_HPP
+
+#include <strong.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+namespace detail {
+
+template<class Key, typename = void>
+struct is_ordered : std::false_type {
+};
+
+template<class Key>
+struct is_ordered<Key, decltype(static_cast<void>(std::declval<Key const &>() < std::declval<Key const &>()))>
+  : std::true_type {
+};
+
+}
+
+/**
+ * Select the records with the k largest keys from a stream.
+ *
+ * Memory is bounded by 2k records: records are buffered until the buffer holds 2k, and then the
+ * buffer is cut back to the k largest in linear time. The smallest key that survived the last cut
+ * is a threshold that every later record must beat, so once the stream has warmed up almost every
+ * record is rejected with a single comparison. Bulk insertion applies that comparison to a batch
+ * of keys in a branch-free pre-pass before touching the buffer.
+ *
+ * Streams split across threads can each be reduced with their own top_k and then merged.
+ *
+ * @tparam Key A strong typedef that enables op::orders (e.g. a cycle count).
+ * @tparam Value The data associated with each key.
+ */
+template<class Key, typename Value>
+class top_k {
+public:
+  using size_type = std::size_t;
+  using value_type = std::pair<Key, Value>;
+
+  static_assert(detail::is_ordered<Key>::value, "top_k requires a key type that enables strong::op::orders");
+
+  /**
+   * Construct an empty selection.
+   *
+   * @param k The number of records to keep.
+   * @throws std::invalid_argument If k is zero.
+   */
+  explicit top_k(size_type k) : limit(k)
+  {
+    if(k == 0) {
+      throw std::invalid_argument("strong::top_k: k must be positive");
+    }
+    records.reserve(2 * k);
+  }
+
+  /**
+   * Offer a record.
+   *
+   * @param key The key of the record.
+   * @param value The data of the record.
+   */
+  void push(Key const &key, Value const &value)
+  {
+    if(has_threshold && !(threshold < key)) {
+      return;
+    }
+
+    records.emplace_back(key, value);
+    if(records.size() == 2 * limit) {
+      cut();
+    }
+  }
+
+  /**
+   * Offer a batch of records stored as parallel arrays.
+   *
+   * @param keys The keys of the records.
+   * @param values The data of the records.
+   * @param count The number of records.
+   */
+  void push(Key const *keys, Value const *values, size_type count)
+  {
+    std::size_t survivors[batch];
+    for(size_type offset = 0; offset < count; offset += batch) {
+      auto const size = std::min(batch, count - offset);
+
+      // always store the index, but only keep it if the key beats the threshold
+      size_type kept = 0;
+      if(has_threshold) {
+        for(size_type i = 0; i < size; ++i) {
+          survivors[kept] = offset + i;
+          kept += static_cast<size_type>(threshold < keys[offset + i]);
+        }
+      } else {
+        for(size_type i = 0; i < size; ++i) {
+          survivors[kept++] = offset + i;
+        }
+      }
+
+      for(size_type i = 0; i < kept; ++i) {
+        push(keys[survivors[i]], values[survivors[i]]);
+      }
+    }
+  }
+
+  /**
+   * Offer every record kept by another selection.
+   *
+   * @param other The selection to merge.
+   */
+  void merge(top_k const &other)
+  {
+    for(auto const &record : other.records) {
+      push(record.first, record.second);
+    }
+  }
+
+  /**
+   * @return The kept records, ordered from the largest key to the smallest.
+   */
+  std::vector<value_type> sorted() const
+  {
+    auto result = records;
+    auto const by_key = [](value_type const &lhs, value_type const &rhs) { return rhs.first < lhs.first; };
+    if(result.size() > limit) {
+      std::nth_element(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(limit - 1), result.end(), by_key);
+      result.resize(limit);
+    }
+    std::sort(result.begin(), result.end(), by_key);
+    return result;
+  }
+
+  /**
+   * @return The number of records to keep.
+   */
+  size_type k() const noexcept
+  {
+    return limit;
+  }
+
+private:
+  static constexpr size_type batch = 256;
+
+  void cut()
+  {
+    auto const by_key = [](value_type const &lhs, value_type const &rhs) { return rhs.first < lhs.first; };
+    auto const kth = records.begin() + static_cast<std::ptrdiff_t>(limit - 1);
+    std::nth_element(records.begin(), kth, records.end(), by_key);
+    threshold = kth->first;
+    has_threshold = true;
+    records.erase(kth + 1, records.end());
+  }
+
+  size_type limit;
+  std::vector<value_type> records;
+  Key threshold{};
+  bool has_threshold = false;
+};
+
+template<class Key, typename Value>
+constexpr typename top_k<Key, Value>::size_type top_k<Key, Value>::batch;
+
+/**
+ * Select the records with the k largest keys from parallel arrays using several threads.
+ *
+ * Each thread reduces a contiguous slice of the records to its own top_k, and the partial
+ * selections are then merged.
+ *
+ * @param keys The keys of the records.
+ * @param values The data of the records.
+ * @param count The number of records.
+ * @param k The number of records to keep.
+ * @param threads The number of threads to use, or 0 to use every hardware thread.
+ * @return The selection.
+ */
+template<class Key, typename Value>
+top_k<Key, Value> parallel_top_k(Key const *keys, Value const *values, std::size_t count, std::size_t k,
+                                 unsigned threads = 0)
+{
+  if(threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  std::vector<top_k<Key, Value>> partial(threads, top_k<Key, Value>(k));
+  std::vector<std::thread> workers;
+  for(unsigned i = 0; i < threads; ++i) {
+    workers.emplace_back([&, i] {
+      auto const first = count * i / threads;
+      auto const last = count * (i + 1) / threads;
+      partial[i].push(keys + first, values + first, last - first);
+    });
+  }
+  for(auto &worker : workers) {
+    worker.join();
+  }
+
+  for(unsigned i = 1; i < threads; ++i) {
+    partial[0].merge(partial[i]);
+  }
+  return partial[0];
+}
+
+}
+
+#endif //STRONG_TOP_K_HPP
@@ -0,0 +1,400 @@
+#ifndef STRONG_VALUE_PROFILE_HPP
+#define STRONG_VALUE_PROFILE_HPP
+
+#include <strong.hpp>
+#include <strong/tag.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+/**
+ * The number of buckets in the histogram of a value distribution.
+ */
+constexpr std::size_t value_histogram_size = 65;
+
+/**
+ * The values that strong typedefs of one tag were constructed with or changed to.
+ *
+ * Values are recorded only when STRONG_PROFILE_VALUES is defined, which the CMake option of the
+ * same name does, and only for arithmetic underlying types. Values are recorded when a strong
+ * typedef is constructed from its underlying type, which includes the results of the arithmetic
+ * operators, and when a compound assignment, increment, decrement or stream extraction changes
+ * it in place. Copies are not recorded again.
+ */
+struct value_distribution {
+  /**
+   * The name of the tag, as given by tag_name.
+   */
+  std::string tag;
+
+  /**
+   * The number of values recorded.
+   */
+  std::uint64_t count;
+
+  /**
+   * The number of values equal to zero.
+   */
+  std::uint64_t zeros;
+
+  /**
+   * The number of values below zero.
+   */
+  std::uint64_t negatives;
+
+  /**
+   * The smallest value, rounded to a double; +infinity if no value was recorded.
+   */
+  double min;
+
+  /**
+   * The largest value, rounded to a double; -infinity if no value was recorded.
+   */
+  double max;
+
+  /**
+   * The number of values by magnitude: bucket 0 counts magnitudes below 1, and bucket k counts
+   * magnitudes from 2^(k-1) up to 2^k, i.e. integers that need exactly k bits besides the sign.
+   * The last bucket also counts magnitudes of 2^64 and above.
+   */
+  std::array<std::uint64_t, value_histogram_size> histogram;
+
+  /**
+   * @return The number of bits that the magnitude of every recorded value fits into: the highest
+   *         non-empty bucket of the histogram.
+   */
+  unsigned bits() const noexcept
+  {
+    unsigned bits = 0;
+    for(std::size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+      if(histogram[bucket] != 0) {
+        bits = static_cast<unsigned>(bucket);
+      }
+    }
+    return bits;
+  }
+};
+
+// strong.hpp includes this header when profiling, which may happen through tag.hpp before it has
+// declared tag_name
+template<class TypeName>
+std::string const & tag_name();
+
+namespace detail {
+
+// The values recorded by one thread for one tag. Only that thread writes it, so it updates the
+// counters with plain loads and stores instead of read-modify-write operations, and a report reads
+// them concurrently.
+struct value_cell {
+  value_cell() : count(0), zeros(0), negatives(0), min(std::numeric_limits<double>::infinity()),
+                 max(-std::numeric_limits<double>::infinity())
+  {
+    for(auto &bucket : histogram) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<std::uint64_t> count;
+  std::atomic<std::uint64_t> zeros;
+  std::atomic<std::uint64_t> negatives;
+  std::atomic<double> min;
+  std::atomic<double> max;
+  std::atomic<std::uint64_t> histogram[value_histogram_size];
+};
+
+inline void bump(std::atomic<std::uint64_t> &counter) noexcept
+{
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline unsigned magnitude_bits(std::uint64_t magnitude) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return magnitude == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(magnitude));
+#else
+  unsigned bits = 0;
+  for(; magnitude != 0; magnitude >>= 1) {
+    ++bits;
+  }
+  return bits;
+#endif
+}
+
+inline unsigned magnitude_bits(double magnitude) noexcept
+{
+  if(magnitude < 1) {
+    return 0;
+  }
+  if(magnitude >= 18446744073709551616.0) {
+    return value_histogram_size - 1;
+  }
+  return static_cast<unsigned>(std::ilogb(magnitude)) + 1;
+}
+
+inline void record(value_cell &cell, double value, unsigned bits) noexcept
+{
+  bump(cell.count);
+  if(value == 0) {
+    bump(cell.zeros);
+  } else if(value < 0) {
+    bump(cell.negatives);
+  }
+  if(value < cell.min.load(std::memory_order_relaxed)) {
+    cell.min.store(value, std::memory_order_relaxed);
+  }
+  if(value > cell.max.load(std::memory_order_relaxed)) {
+    cell.max.store(value, std::memory_order_relaxed);
+  }
+  bump(cell.histogram[bits]);
+}
+
+template<typename Type>
+void record(value_cell &cell, Type value, std::true_type /* integral */) noexcept
+{
+  // the magnitude is computed in unsigned arithmetic, so that the most negative value has one too
+  auto const wide = static_cast<std::uint64_t>(value);
+  auto const magnitude = value < Type() ? std::uint64_t(0) - wide : wide;
+  record(cell, static_cast<double>(value), magnitude_bits(magnitude));
+}
+
+template<typename Type>
+void record(value_cell &cell, Type value, std::false_type /* floating point */) noexcept
+{
+  if(value != value) {
+    // NaN has no place in the distribution
+    bump(cell.count);
+    return;
+  }
+  record(cell, static_cast<double>(value), magnitude_bits(std::fabs(static_cast<double>(value))));
+}
+
+// The cells of one tag, one for each thread that has recorded a value of it. Cells are never freed,
+// so that the values of threads that have exited are still reported.
+class value_profile {
+public:
+  explicit value_profile(std::string name) : name(std::move(name))
+  {
+  }
+
+  value_cell & add_cell()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    cells.emplace_back(new value_cell());
+    return *cells.back();
+  }
+
+  value_distribution distribution() const
+  {
+    value_distribution merged{name, 0, 0, 0, std::numeric_limits<double>::infinity(),
+                              -std::numeric_limits<double>::infinity(), {{}}};
+    std::lock_guard<std::mutex> lock(mutex);
+    for(auto const &cell : cells) {
+      merged.count += cell->count.load(std::memory_order_relaxed);
+      merged.zeros += cell->zeros.load(std::memory_order_relaxed);
+      merged.negatives += cell->negatives.load(std::memory_order_relaxed);
+      merged.min = std::fmin(merged.min, cell->min.load(std::memory_order_relaxed));
+      merged.max = std::fmax(merged.max, cell->max.load(std::memory_order_relaxed));
+      for(std::size_t bucket = 0; bucket < value_histogram_size; ++bucket) {
+        merged.histogram[bucket] += cell->histogram[bucket].load(std::memory_order_relaxed);
+      }
+    }
+    return merged;
+  }
+
+private:
+  std::string const name;
+  mutable std::mutex mutex;
+  std::vector<std::unique_ptr<value_cell>> cells;
+};
+
+inline void write_value_profile_at_exit();
+
+struct value_profiles {
+  std::mutex mutex;
+  std::vector<value_profile const *> profiles;
+
+  // never destroyed, so that values recorded during static destruction still have somewhere to go
+  static value_profiles & instance()
+  {
+    static auto const profiles = [] {
+      auto const created = new value_profiles();
+#ifdef STRONG_PROFILE_VALUES
+      std::atexit(write_value_profile_at_exit);
+#endif
+      return created;
+    }();
+    return *profiles;
+  }
+};
+
+template<class Tag>
+value_profile & profile_of()
+{
+  static auto const profile = [] {
+    auto const created = new value_profile(tag_name<Tag>());
+    auto &registry = value_profiles::instance();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.profiles.push_back(created);
+    return created;
+  }();
+  return *profile;
+}
+
+template<class TypeName, typename Type>
+void profile_value(Type const &value, std::true_type /* arithmetic */) noexcept
+{
+  static thread_local value_cell *cell = nullptr;
+  if(cell == nullptr) {
+    // profiling must not change what the program does, so a value that cannot get a cell because
+    // memory ran out is skipped rather than thrown from a constructor
+    try {
+      cell = &profile_of<TypeName>().add_cell();
+    } catch(...) {
+      return;
+    }
+  }
+  record(*cell, value, std::is_integral<Type>());
+}
+
+template<class TypeName, typename Type>
+void profile_value(Type const &, std::false_type /* arithmetic */) noexcept
+{
+}
+
+template<class TypeName, typename Type>
+void profile_value(Type const &value) noexcept
+{
+  profile_value<TypeName>(value, std::is_arithmetic<Type>());
+}
+
+}
+
+/**
+ * The values recorded for one tag.
+ *
+ * @tparam Tag The strong typedef.
+ * @return The distribution of its values; empty unless STRONG_PROFILE_VALUES is defined.
+ */
+template<class Tag>
+value_distribution value_distribution_of()
+{
+  return detail::profile_of<Tag>().distribution();
+}
+
+/**
+ * The values recorded for every tag that has recorded one.
+ *
+ * @return The distribution of the values of each tag, in the order the tags first recorded one.
+ */
+inline std::vector<value_distribution> value_profile_report()
+{
+  auto &registry = detail::value_profiles::instance();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<value_distribution> report;
+  for(auto const profile : registry.profiles) {
+    report.push_back(profile->distribution());
+  }
+  return report;
+}
+
+/**
+ * Render a value profile report as a table, one tag per line, followed by the non-empty buckets of
+ * the histogram of each tag.
+ *
+ * @param report The report to render.
+ * @return The table.
+ */
+inline std::string render_value_profile(std::vector<value_distribution> const &report)
+{
+  // format every cell first, so that each column can be as wide as its widest cell
+  std::vector<std::vector<std::string>> rows = {{"tag", "count", "zeros", "negatives", "min", "max", "bits"}};
+  for(auto const &distribution : report) {
+    std::ostringstream min, max;
+    min.precision(std::numeric_limits<double>::digits10);
+    max.precision(std::numeric_limits<double>::digits10);
+    min << distribution.min;
+    max << distribution.max;
+    rows.push_back({distribution.tag, std::to_string(distribution.count), std::to_string(distribution.zeros),
+                    std::to_string(distribution.negatives), min.str(), max.str(), std::to_string(distribution.bits())});
+  }
+  std::vector<std::size_t> widths(rows.front().size(), 0);
+  for(auto const &row : rows) {
+    for(std::size_t column = 0; column < row.size(); ++column) {
+      widths[column] = std::max(widths[column], row[column].size());
+    }
+  }
+
+  // the tag is aligned left and the numbers right
+  std::string output;
+  for(auto const &row : rows) {
+    output += row[0] + std::string(widths[0] - row[0].size(), ' ');
+    for(std::size_t column = 1; column < row.size(); ++column) {
+      output += "  " + std::string(widths[column] - row[column].size(), ' ') + row[column];
+    }
+    output += '\n';
+  }
+
+  for(auto const &distribution : report) {
+    std::vector<std::pair<std::string, std::string>> buckets;
+    std::size_t label_width = 0, count_width = 0;
+    for(std::size_t bucket = 0; bucket < value_histogram_size; ++bucket) {
+      if(distribution.histogram[bucket] == 0) {
+        continue;
+      }
+      auto const label = bucket == 0                           ? std::string("[0, 1)")
+                         : bucket == value_histogram_size - 1 ? std::string("[2^63, inf)")
+                                                               : "[2^" + std::to_string(bucket - 1) + ", 2^"
+                                                                   + std::to_string(bucket) + ")";
+      buckets.emplace_back(label, std::to_string(distribution.histogram[bucket]));
+      label_width = std::max(label_width, buckets.back().first.size());
+      count_width = std::max(count_width, buckets.back().second.size());
+    }
+
+    output += '\n' + distribution.tag + ":\n";
+    for(auto const &bucket : buckets) {
+      output += "  " + bucket.first + std::string(label_width - bucket.first.size(), ' ') + "  "
+                + std::string(count_width - bucket.second.size(), ' ') + bucket.second + '\n';
+    }
+  }
+  return output;
+}
+
+namespace detail {
+
+// Write the report to the file named by the STRONG_VALUE_PROFILE environment variable, or to the
+// standard error stream if it is not set.
+inline void write_value_profile_at_exit()
+{
+  auto const text = render_value_profile(value_profile_report());
+  auto const path = std::getenv("STRONG_VALUE_PROFILE");
+  auto const file = path != nullptr ? std::fopen(path, "w") : stderr;
+  if(file == nullptr) {
+    return;
+  }
+  std::fwrite(text.data(), 1, text.size(), file);
+  if(file != stderr) {
+    std::fclose(file);
+  }
+}
+
+}
+
+}
+
+#endif //STRONG_VALUE_PROFILE_HPP
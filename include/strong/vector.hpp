@@ -0,0 +1,317 @@
+#ifndef STRONG_VECTOR_HPP
+#define STRONG_VECTOR_HPP
+
+#include <strong.hpp>
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+/**
+ * A contiguous array that can only be indexed by a strong typedef.
+ *
+ * Wraps std::vector so that, for example, an array of intersection data can be indexed by an
+ * intersection ID but not by a street ID or a raw integer. Position i of the array corresponds to
+ * the strong index whose underlying value is i.
+ *
+ * @tparam Index A strong typedef whose underlying type is a non-negative integer.
+ * @tparam T The type of the elements.
+ * @tparam Allocator The allocator used to acquire memory for the elements.
+ */
+template<class Index, typename T, class Allocator = std::allocator<T>>
+class vector {
+public:
+  using index_type = Index;
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using reference = T &;
+  using const_reference = T const &;
+  using iterator = typename std::vector<T, Allocator>::iterator;
+  using const_iterator = typename std::vector<T, Allocator>::const_iterator;
+
+  /**
+   * Construct an empty array.
+   */
+  vector() = default;
+
+  /**
+   * Construct an empty array that uses the given allocator.
+   *
+   * @param allocator The allocator to use.
+   */
+  explicit vector(Allocator const &allocator) : elements(allocator)
+  {
+  }
+
+  /**
+   * Construct an array of value-initialized elements.
+   *
+   * @param count The number of elements.
+   * @param allocator The allocator to use.
+   */
+  explicit vector(size_type count, Allocator const &allocator = Allocator())
+    : elements(count, T(), allocator)
+  {
+  }
+
+  /**
+   * Construct an array of copies of a value.
+   *
+   * @param count The number of elements.
+   * @param value The value to copy into each element.
+   * @param allocator The allocator to use.
+   */
+  vector(size_type count, T const &value, Allocator const &allocator = Allocator())
+    : elements(count, value, allocator)
+  {
+  }
+
+  /**
+   * Construct an array from a list of values.
+   *
+   * @param values The values of the elements.
+   * @param allocator The allocator to use.
+   */
+  vector(std::initializer_list<T> values, Allocator const &allocator = Allocator())
+    : elements(values, allocator)
+  {
+  }
+
+  /**
+   * Access an element without bounds checking.
+   *
+   * @param index The index of the element.
+   * @return A reference to the element.
+   */
+  reference operator[](Index const &index) noexcept
+  {
+    return elements[to_position(index)];
+  }
+
+  /**
+   * Access an element without bounds checking.
+   *
+   * @param index The index of the element.
+   * @return A reference to the element.
+   */
+  const_reference operator[](Index const &index) const noexcept
+  {
+    return elements[to_position(index)];
+  }
+
+  /**
+   * Access an element.
+   *
+   * @param index The index of the element.
+   * @return A reference to the element.
+   * @throws std::out_of_range If the index is not less than the size.
+   */
+  reference at(Index const &index)
+  {
+    return elements.at(to_position(index));
+  }
+
+  /**
+   * Access an element.
+   *
+   * @param index The index of the element.
+   * @return A reference to the element.
+   * @throws std::out_of_range If the index is not less than the size.
+   */
+  const_reference at(Index const &index) const
+  {
+    return elements.at(to_position(index));
+  }
+
+  /**
+   * Append an element constructed in place.
+   *
+   * @param args The arguments forwarded to the constructor of the element.
+   * @return The index of the new element.
+   */
+  template<typename... Args>
+  Index emplace_back(Args &&... args)
+  {
+    auto const index = next_index();
+    elements.emplace_back(std::forward<Args>(args)...);
+    return index;
+  }
+
+  /**
+   * Append a copy of an element.
+   *
+   * @param value The element to copy.
+   * @return The index of the new element.
+   */
+  Index push_back(T const &value)
+  {
+    return emplace_back(value);
+  }
+
+  /**
+   * Append an element by moving it.
+   *
+   * @param value The element to move.
+   * @return The index of the new element.
+   */
+  Index push_back(T &&value)
+  {
+    return emplace_back(std::move(value));
+  }
+
+  /**
+   * Remove the last element.
+   */
+  void pop_back()
+  {
+    elements.pop_back();
+  }
+
+  /**
+   * @return The index that the next appended element will have.
+   */
+  Index next_index() const
+  {
+    return Index(static_cast<typename underlying_type<Index>::type>(elements.size()));
+  }
+
+  /**
+   * Test whether an index refers to an element of the array.
+   *
+   * @param index The index to test.
+   * @return True if the index is less than the size.
+   */
+  bool contains(Index const &index) const noexcept
+  {
+    return to_position(index) < elements.size();
+  }
+
+  /**
+   * Change the number of elements.
+   *
+   * @param count The new number of elements.
+   */
+  void resize(size_type count)
+  {
+    elements.resize(count);
+  }
+
+  /**
+   * Change the number of elements.
+   *
+   * @param count The new number of elements.
+   * @param value The value to copy into new elements.
+   */
+  void resize(size_type count, T const &value)
+  {
+    elements.resize(count, value);
+  }
+
+  /**
+   * Reserve space for elements.
+   *
+   * @param capacity The number of elements to reserve space for.
+   */
+  void reserve(size_type capacity)
+  {
+    elements.reserve(capacity);
+  }
+
+  /**
+   * Remove all elements.
+   */
+  void clear() noexcept
+  {
+    elements.clear();
+  }
+
+  /**
+   * @return The number of elements.
+   */
+  size_type size() const noexcept
+  {
+    return elements.size();
+  }
+
+  /**
+   * @return True if there are no elements.
+   */
+  bool empty() const noexcept
+  {
+    return elements.empty();
+  }
+
+  /**
+   * @return A pointer to the first element.
+   */
+  T * data() noexcept
+  {
+    return elements.data();
+  }
+
+  /**
+   * @return A pointer to the first element.
+   */
+  T const * data() const noexcept
+  {
+    return elements.data();
+  }
+
+  /**
+   * @return The allocator of the array.
+   */
+  allocator_type get_allocator() const
+  {
+    return elements.get_allocator();
+  }
+
+  /**
+   * @return An iterator to the first element.
+   */
+  iterator begin() noexcept
+  {
+    return elements.begin();
+  }
+
+  /**
+   * @return An iterator past the last element.
+   */
+  iterator end() noexcept
+  {
+    return elements.end();
+  }
+
+  /**
+   * @return An iterator to the first element.
+   */
+  const_iterator begin() const noexcept
+  {
+    return elements.begin();
+  }
+
+  /**
+   * @return An iterator past the last element.
+   */
+  const_iterator end() const noexcept
+  {
+    return elements.end();
+  }
+
+private:
+  static size_type to_position(Index const &index) noexcept
+  {
+    return static_cast<size_type>(get(index));
+  }
+
+  std::vector<T, Allocator> elements;
+};
+
+}
+
+#endif //STRONG_VECTOR_HPP
@@ -0,0 +1,470 @@
+#ifndef STRONG_WINDOW_HPP
+#define STRONG_WINDOW_HPP
+
+#include <strong.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace strong {
+
+/**
+ * Aggregators combine the values of a window.
+ *
+ * An aggregator is a class with a result_type and three static functions: identity() returns the
+ * result of an empty window, lift(value) returns the result of a window holding one value, and
+ * combine(lhs, rhs) merges the results of two adjacent windows. combine must be associative; it
+ * does not need to be commutative or invertible.
+ */
+namespace aggregate {
+
+/**
+ * Adds the values of a window. The value type must enable op::adds.
+ *
+ * @tparam Value The strong typedef of the values.
+ */
+template<class Value>
+struct sum {
+  using result_type = Value;
+
+  static result_type identity()
+  {
+    return Value();
+  }
+
+  static result_type lift(Value const &value)
+  {
+    return value;
+  }
+
+  static result_type combine(result_type const &lhs, result_type const &rhs)
+  {
+    return lhs + rhs;
+  }
+};
+
+/**
+ * Finds the smallest value of a window. The value type must enable op::orders.
+ *
+ * @tparam Value The strong typedef of the values, with an arithmetic underlying type.
+ */
+template<class Value>
+struct min {
+  using result_type = Value;
+
+  static result_type identity()
+  {
+    return Value(std::numeric_limits<typename underlying_type<Value>::type>::max());
+  }
+
+  static result_type lift(Value const &value)
+  {
+    return value;
+  }
+
+  static result_type combine(result_type const &lhs, result_type const &rhs)
+  {
+    return rhs < lhs ? rhs : lhs;
+  }
+};
+
+/**
+ * Finds the largest value of a window. The value type must enable op::orders.
+ *
+ * @tparam Value The strong typedef of the values, with an arithmetic underlying type.
+ */
+template<class Value>
+struct max {
+  using result_type = Value;
+
+  static result_type identity()
+  {
+    return Value(std::numeric_limits<typename underlying_type<Value>::type>::lowest());
+  }
+
+  static result_type lift(Value const &value)
+  {
+    return value;
+  }
+
+  static result_type combine(result_type const &lhs, result_type const &rhs)
+  {
+    return lhs < rhs ? rhs : lhs;
+  }
+};
+
+/**
+ * Counts the values of a window.
+ *
+ * @tparam Value The strong typedef of the values.
+ */
+template<class Value>
+struct count {
+  using result_type = std::size_t;
+
+  static result_type identity()
+  {
+    return 0;
+  }
+
+  static result_type lift(Value const &)
+  {
+    return 1;
+  }
+
+  static result_type combine(result_type const &lhs, result_type const &rhs)
+  {
+    return lhs + rhs;
+  }
+};
+
+}
+
+/**
+ * The aggregate of one completed window.
+ *
+ * @tparam Time The strong typedef of time.
+ * @tparam Result The result type of the aggregator.
+ */
+template<class Time, typename Result>
+struct window {
+  /**
+   * The time of the start of the window (inclusive).
+   */
+  Time start;
+
+  /**
+   * The time of the end of the window. Tumbling windows exclude their end; session windows end
+   * at their last event, which is included.
+   */
+  Time end;
+
+  /**
+   * The number of events in the window.
+   */
+  std::size_t events;
+
+  /**
+   * The aggregate of the values in the window.
+   */
+  Result result;
+};
+
+namespace detail {
+
+template<class Time>
+struct check_time {
+  static_assert(std::is_integral<typename underlying_type<Time>::type>::value,
+                "windows require a time type with an integral underlying type");
+
+  static void check_order(Time const &last, Time const &time, bool started)
+  {
+    if(started && get(time) < get(last)) {
+      throw std::invalid_argument("strong::window: events must arrive in non-decreasing time order");
+    }
+  }
+};
+
+}
+
+/**
+ * Aggregates a stream into fixed-size, non-overlapping windows (e.g. every 10,000 cycles).
+ *
+ * Window n covers the times [n * size, (n + 1) * size). A window is emitted once the first event
+ * after it arrives, or on flush. Windows with no events are not emitted.
+ *
+ * @tparam Time The strong typedef of time, with an integral underlying type.
+ * @tparam Value The strong typedef of the values.
+ * @tparam Aggregator How the values of a window are combined.
+ */
+template<class Time, class Value, class Aggregator = aggregate::sum<Value>>
+class tumbling_window : detail::check_time<Time> {
+public:
+  using result_type = typename Aggregator::result_type;
+  using window_type = window<Time, result_type>;
+
+  /**
+   * Construct an empty aggregation.
+   *
+   * @param size The length of each window.
+   * @param emit Called with each completed window.
+   * @throws std::invalid_argument If the size is not positive.
+   */
+  tumbling_window(Time const &size, std::function<void(window_type const &)> emit)
+    : size(size), emit(std::move(emit))
+  {
+    if(!(get(size) > 0)) {
+      throw std::invalid_argument("strong::tumbling_window: size must be positive");
+    }
+  }
+
+  /**
+   * Add an event.
+   *
+   * @param time The time of the event, no earlier than the previous event nor inside a window that
+   *             has been emitted.
+   * @param value The value of the event.
+   * @throws std::invalid_argument If the event is earlier than the previous event, or falls in a
+   *                               window that has been emitted.
+   */
+  void push(Time const &time, Value const &value)
+  {
+    this->check_order(last, time, started);
+
+    auto const start = get(time) - modulo(get(time));
+    if(current.events > 0 && start != get(current.start)) {
+      flush();
+    }
+    last = time;
+    started = true;
+    if(current.events == 0) {
+      current.start = Time(start);
+      current.end = Time(start + get(size));
+    }
+
+    current.result = Aggregator::combine(current.result, Aggregator::lift(value));
+    ++current.events;
+  }
+
+  /**
+   * Emit the current window if it has any events. Later events must not fall into it.
+   */
+  void flush()
+  {
+    if(current.events > 0) {
+      emit(current);
+      // an emitted window is final, so it becomes the watermark for the order check
+      last = current.end;
+    }
+    current.events = 0;
+    current.result = Aggregator::identity();
+  }
+
+private:
+  using rep = typename underlying_type<Time>::type;
+
+  rep modulo(rep time) const noexcept
+  {
+    // round towards negative infinity so that negative times fall in the right window
+    auto const remainder = time % get(size);
+    return remainder < 0 ? remainder + get(size) : remainder;
+  }
+
+  Time size;
+  Time last = Time();
+  bool started = false;
+  std::function<void(window_type const &)> emit;
+  window_type current = {Time(), Time(), 0, Aggregator::identity()};
+};
+
+/**
+ * Aggregates the events of a stream that fall within a fixed length of the latest time.
+ *
+ * The window covers the times (now - length, now], where now is the time of the latest event or
+ * the time passed to advance. The aggregate can be read after every event.
+ *
+ * Events are kept in a queue built from two stacks. New events go on the back stack, which keeps
+ * the aggregate of all its values. Old events are evicted from the front stack, where each entry
+ * keeps the aggregate of itself and every newer entry in the stack. When the front stack runs out,
+ * the back stack is moved onto it once. Each event is therefore lifted, moved, and evicted once,
+ * so push, advance and result take O(1) amortized time with any associative aggregator, without
+ * needing to subtract evicted values.
+ *
+ * @tparam Time The strong typedef of time, with an integral underlying type.
+ * @tparam Value The strong typedef of the values.
+ * @tparam Aggregator How the values of the window are combined.
+ */
+template<class Time, class Value, class Aggregator = aggregate::sum<Value>>
+class sliding_window : detail::check_time<Time> {
+public:
+  using result_type = typename Aggregator::result_type;
+
+  /**
+   * Construct an empty window.
+   *
+   * @param length The length of the window.
+   * @throws std::invalid_argument If the length is not positive.
+   */
+  explicit sliding_window(Time const &length) : length(length)
+  {
+    if(!(get(length) > 0)) {
+      throw std::invalid_argument("strong::sliding_window: length must be positive");
+    }
+  }
+
+  /**
+   * Add an event and evict the events that are now too old.
+   *
+   * @param time The time of the event, no earlier than the previous event.
+   * @param value The value of the event.
+   */
+  void push(Time const &time, Value const &value)
+  {
+    advance(time);
+    auto const lifted = Aggregator::lift(value);
+    back_total = back.empty() ? lifted : Aggregator::combine(back_total, lifted);
+    back.push_back(entry{time, lifted});
+  }
+
+  /**
+   * Move the window forward without adding an event.
+   *
+   * @param time The new latest time, no earlier than the previous one.
+   */
+  void advance(Time const &time)
+  {
+    this->check_order(now, time, started);
+    now = time;
+    started = true;
+
+    // time is no earlier than oldest, so the difference does not wrap for unsigned times
+    while(size() > 0 && !(get(time) - get(oldest()) < get(length))) {
+      pop();
+    }
+  }
+
+  /**
+   * @return The aggregate of the events in the window.
+   */
+  result_type result() const
+  {
+    if(front.empty()) {
+      return back.empty() ? Aggregator::identity() : back_total;
+    }
+    return back.empty() ? front.back().value : Aggregator::combine(front.back().value, back_total);
+  }
+
+  /**
+   * @return The number of events in the window.
+   */
+  std::size_t size() const noexcept
+  {
+    return front.size() + back.size();
+  }
+
+private:
+  struct entry {
+    Time time;
+    result_type value;
+  };
+
+  Time const & oldest()
+  {
+    if(front.empty()) {
+      transfer();
+    }
+    return front.back().time;
+  }
+
+  void pop()
+  {
+    if(front.empty()) {
+      transfer();
+    }
+    front.pop_back();
+  }
+
+  // move the back stack onto the front stack, turning each value into a suffix aggregate
+  void transfer()
+  {
+    while(!back.empty()) {
+      auto item = back.back();
+      back.pop_back();
+      if(!front.empty()) {
+        item.value = Aggregator::combine(item.value, front.back().value);
+      }
+      front.push_back(item);
+    }
+    back_total = Aggregator::identity();
+  }
+
+  Time length;
+  Time now = Time();
+  bool started = false;
+  std::vector<entry> front;
+  std::vector<entry> back;
+  result_type back_total = Aggregator::identity();
+};
+
+/**
+ * Aggregates a stream into sessions separated by gaps of inactivity.
+ *
+ * A session closes when the next event arrives more than gap after the last event of the session,
+ * or on flush. Each session is emitted with the time of its first and last event.
+ *
+ * @tparam Time The strong typedef of time, with an integral underlying type.
+ * @tparam Value The strong typedef of the values.
+ * @tparam Aggregator How the values of a session are combined.
+ */
+template<class Time, class Value, class Aggregator = aggregate::sum<Value>>
+class session_window : detail::check_time<Time> {
+public:
+  using result_type = typename Aggregator::result_type;
+  using window_type = window<Time, result_type>;
+
+  /**
+   * Construct an empty aggregation.
+   *
+   * @param gap The longest time between two events of the same session.
+   * @param emit Called with each completed session.
+   */
+  session_window(Time const &gap, std::function<void(window_type const &)> emit)
+    : gap(gap), emit(std::move(emit))
+  {
+  }
+
+  /**
+   * Add an event.
+   *
+   * @param time The time of the event, no earlier than the previous event.
+   * @param value The value of the event.
+   * @throws std::invalid_argument If the event is earlier than the previous event, even one of a
+   *                               session that has been emitted.
+   */
+  void push(Time const &time, Value const &value)
+  {
+    // the last event is kept across flushes, so that a flushed session is not reopened by a late one
+    this->check_order(last, time, started);
+    last = time;
+    started = true;
+
+    if(current.events > 0 && get(time) - get(current.end) > get(gap)) {
+      flush();
+    }
+    if(current.events == 0) {
+      current.start = time;
+    }
+
+    current.end = time;
+    current.result = Aggregator::combine(current.result, Aggregator::lift(value));
+    ++current.events;
+  }
+
+  /**
+   * Emit the current session if it has any events.
+   */
+  void flush()
+  {
+    if(current.events > 0) {
+      emit(current);
+    }
+    current.events = 0;
+    current.result = Aggregator::identity();
+  }
+
+private:
+  Time gap;
+  Time last = Time();
+  bool started = false;
+  std::function<void(window_type const &)> emit;
+  window_type current = {Time(), Time(), 0, Aggregator::identity()};
+};
+
+}
+
+#endif //STRONG_WINDOW_HPP
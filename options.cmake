@@ -16,6 +16,12 @@ option(
   ON
 )
 
+option(
+  STRONG_PROFILE_VALUES
+  "Record the distribution of the values of every strong type and report it at exit"
+  OFF
+)
+
 if(STRONG_BUILD_DOCS)
   message(STATUS "strong: doc target builds documentation.")
 endif()
@@ -27,3 +33,7 @@ endif()
 if(STRONG_USE_STL_STREAMS)
   message(STATUS "strong: Using STL streams.")
 endif()
+
+if(STRONG_PROFILE_VALUES)
+  message(STATUS "strong: Profiling the values of strong types.")
+endif()